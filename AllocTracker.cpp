@@ -0,0 +1,129 @@
+#include "AllocTracker.h"
+#include <new>
+#include <cstdlib>
+#include <atomic>
+#include <sstream>
+#include <iostream>
+
+// Failed checks on all threads
+static std::atomic<Uint64> sFailures{ 0 };
+
+// Counts an allocation on the calling thread. Called by operator new so must not allocate.
+void AllocTracker::onAlloc(std::size_t bytes) {
+	ThreadStats& ts{ getThreadStats() };
+	++ts.total.allocs;
+	ts.total.bytes += bytes;
+	++ts.window.allocs;
+	ts.window.bytes += bytes;
+
+	// find the current tag, adding it if new. Compared by pointer as tags are literals.
+	int i{ 0 };
+	while (i < ts.tagCount && ts.tags[i].tag != ts.tag) ++i;
+	if (i == ts.tagCount) {
+		if (ts.tagCount < MAX_TAGS) ts.tags[ts.tagCount++].tag = ts.tag;
+		else i = MAX_TAGS - 1;
+	}
+
+	TagCounts& tc{ ts.tags[i] };
+	++tc.total.allocs;
+	tc.total.bytes += bytes;
+	++tc.window.allocs;
+	tc.window.bytes += bytes;
+}
+
+// Sets the calling thread's current tag and returns the previous one. Use AllocScope rather than calling directly.
+const char* AllocTracker::setTag(const char* tag) {
+	ThreadStats& ts{ getThreadStats() };
+	const char* previous{ ts.tag };
+	ts.tag = tag;
+	return previous;
+}
+
+// Returns the calling thread's allocations since the last check without resetting them.
+AllocTracker::Counts AllocTracker::getWindow() {
+	return getThreadStats().window;
+}
+
+// Ends the calling thread's window of allocations since the last check. If enforce is set and anything allocated, reports where with
+// the per tag counts (e.g. "GameLoop::runTick 1234") and returns false.
+bool AllocTracker::check(const char* where, Uint64 index, bool enforce) {
+	if constexpr (!FuGlobals::ALLOC_TRACK) return true;
+
+	ThreadStats& ts{ getThreadStats() };
+	bool clean{ !enforce || ts.window.allocs == 0 };
+
+	// build the report before resetting as building it allocates too
+	if (!clean && ++sFailures <= REPORT_LIMIT) {
+		std::ostringstream str{};
+		str << "Failed in " << where << " " << index << ". " << ts.window.allocs << " heap allocations (" << ts.window.bytes << " bytes) in steady state:";
+		for (int i{ 0 }; i < ts.tagCount; ++i) {
+			if (ts.tags[i].window.allocs > 0) str << " " << ts.tags[i].tag << " " << ts.tags[i].window.allocs << "/" << ts.tags[i].window.bytes << "B";
+		}
+		if (sFailures == REPORT_LIMIT) str << " (further reports suppressed)";
+		std::cerr << str.str() << std::endl;
+	}
+
+	ts.window = Counts{};
+	for (int i{ 0 }; i < ts.tagCount; ++i) ts.tags[i].window = Counts{};
+
+	return clean;
+}
+
+// Returns the number of failed checks on all threads
+Uint64 AllocTracker::getFailures() {
+	return sFailures;
+}
+
+// Outputs the calling thread's total allocations per tag represented as a string
+std::string AllocTracker::toString() {
+	ThreadStats& ts{ getThreadStats() };
+	std::ostringstream str{};
+	str << "AllocTracker::Allocations: " << ts.total.allocs << " (" << ts.total.bytes << " bytes), Failed checks: " << sFailures << "\n";
+	for (int i{ 0 }; i < ts.tagCount; ++i) {
+		str << "AllocTracker::" << ts.tags[i].tag << ": " << ts.tags[i].total.allocs << " (" << ts.tags[i].total.bytes << " bytes)\n";
+	}
+	return str.str();
+}
+
+// Returns the calling thread's counts.
+AllocTracker::ThreadStats& AllocTracker::getThreadStats() {
+	thread_local ThreadStats tStats{};
+	return tStats;
+}
+
+// Replacement global allocation functions. Every new in the program comes through here. Aligned and sized forms
+// not replaced fall back on these or on the library's own matching pair.
+void* operator new(std::size_t size) {
+	if constexpr (FuGlobals::ALLOC_TRACK) AllocTracker::onAlloc(size);
+	if (size == 0) size = 1;
+
+	// same as the library's: retry through the new handler until there is none
+	while (true) {
+		void* p{ std::malloc(size) };
+		if (p) return p;
+
+		std::new_handler handler{ std::get_new_handler() };
+		if (!handler) throw std::bad_alloc{};
+		handler();
+	}
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <cstddef>
+
+/* AllocTracker - Counts heap allocations per thread and per subsystem tag
+ *
+ * AllocTracker.cpp replaces the global operator new so every allocation made through new (including
+ * std::string, std::vector and std::make_shared) is counted on the thread that made it against the
+ * innermost AllocScope tag, or "untagged":
+ *     AllocScope scope{ "Physics" };
+ * Tags must be string literals or otherwise outlive the program as only the pointer is kept.
+ *
+ * check() is called at the end of every tick and frame with the allocations made on the calling
+ * thread since the last check. Once the game is past warm up a tick or frame that allocated at all is
+ * reported with its tags and check() returns false, which fails headless and replay runs. The per tick
+ * path should reuse storage rather than allocate, this catches it when it doesn't.
+ *
+ * Counting only happens with FuGlobals::ALLOC_TRACK on. Off, operator new is a plain malloc and
+ * AllocScope compiles to nothing.
+ */
+class AllocTracker {
+
+public:
+	// Most tags counted per thread. Anything past this is counted under the last tag.
+	static constexpr int MAX_TAGS{ 16 };
+
+	// Most failed checks reported so a steady leak doesn't flood the console.
+	static constexpr int REPORT_LIMIT{ 20 };
+
+	// Allocations and bytes allocated
+	struct Counts {
+		Uint64 allocs{ 0 };
+		Uint64 bytes{ 0 };
+	};
+
+	// Counts an allocation on the calling thread. Called by operator new so must not allocate.
+	static void onAlloc(std::size_t bytes);
+
+	// Sets the calling thread's current tag and returns the previous one. Use AllocScope rather than calling directly.
+	static const char* setTag(const char* tag);
+
+	// Returns the calling thread's allocations since the last check without resetting them.
+	static Counts getWindow();
+
+	// Ends the calling thread's window of allocations since the last check. If enforce is set and anything allocated, reports where with
+	// the per tag counts (e.g. "GameLoop::runTick 1234") and returns false.
+	static bool check(const char* where, Uint64 index, bool enforce);
+
+	// Returns the number of failed checks on all threads
+	static Uint64 getFailures();
+
+	// Outputs the calling thread's total allocations per tag represented as a string
+	static std::string toString();
+
+private:
+	// Counts for one tag. total is since start up, window since the last check.
+	struct TagCounts {
+		const char* tag{ nullptr };
+		Counts total{};
+		Counts window{};
+	};
+
+	// One thread's counts. Plain data so it is ready before any constructor runs and never allocates.
+	struct ThreadStats {
+		const char* tag{ "untagged" };
+		Counts total{};
+		Counts window{};
+		TagCounts tags[MAX_TAGS]{};
+		int tagCount{ 0 };
+	};
+
+	// Returns the calling thread's counts.
+	static ThreadStats& getThreadStats();
+};
+
+// Tags allocations made in the enclosing scope. Compiles to nothing when FuGlobals::ALLOC_TRACK is off.
+class AllocScope {
+
+public:
+	AllocScope(const char* tag) {
+		if constexpr (FuGlobals::ALLOC_TRACK) mPrevious = AllocTracker::setTag(tag);
+	}
+
+	~AllocScope() {
+		if constexpr (FuGlobals::ALLOC_TRACK) AllocTracker::setTag(mPrevious);
+	}
+
+	AllocScope(const AllocScope&) = delete;
+	AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+	const char* mPrevious{ nullptr };
+};
@@ -0,0 +1,81 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+// Constructor takes a filter, only benchmarks whose name contains it are run. An empty filter runs everything.
+Benchmark::Benchmark(std::string filter) {
+	mFilter = filter;
+	mCountsPerNS = SDL_GetPerformanceFrequency() / 1000000000.0;
+}
+
+// Returns true if the named benchmark passes the filter. Lets callers skip setting up benchmarks that won't run.
+bool Benchmark::isSelected(const std::string& name) {
+	return mFilter.empty() || name.find(mFilter) != std::string::npos;
+}
+
+// Works out the statistics of a finished benchmark's batch samples and stores them.
+void Benchmark::addResult(const std::string& name, Uint64 items, Uint64 iterations, std::vector<decimal>& samples) {
+	Result r{};
+	r.name = name;
+	r.items = items;
+	r.iterations = iterations;
+
+	decimal sum{ 0 };
+	for (decimal s : samples) sum += s;
+	r.nsPerOp = sum / samples.size();
+
+	std::sort(samples.begin(), samples.end());
+	r.nsP50 = samples[samples.size() / 2];
+	r.nsP99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+	r.nsPerItem = items > 0 ? r.nsPerOp / items : r.nsPerOp;
+
+	mResults.push_back(r);
+	std::cerr << "Benchmark::" << name << ": " << r.nsPerOp << " ns/op" << std::endl;
+}
+
+// Writes all results as a JSON array to the given file, or the standard output stream if it is empty. Returns success.
+bool Benchmark::writeJSON(std::string file) {
+	std::ostringstream str{};
+	str << std::fixed << std::setprecision(2) << "[\n";
+	for (std::size_t i{ 0 }; i < mResults.size(); ++i) {
+		const Result& r = mResults[i];
+		str << "  { \"name\": \"" << r.name << "\", \"items\": " << r.items << ", \"iterations\": " << r.iterations;
+		str << ", \"ns_per_op\": " << r.nsPerOp << ", \"ns_p50\": " << r.nsP50 << ", \"ns_p99\": " << r.nsP99;
+		str << ", \"ns_per_item\": " << r.nsPerItem << " }" << (i + 1 < mResults.size() ? ",\n" : "\n");
+	}
+	str << "]\n";
+
+	if (file.empty()) {
+		std::cout << str.str();
+		return true;
+	}
+
+	std::ofstream out{ file };
+	if (!out) {
+		std::cerr << "Failed in Benchmark::writeJSON. Could not open file: " << file << std::endl;
+		return false;
+	}
+	out << str.str();
+	return true;
+}
+
+// Returns the results collected so far.
+const std::vector<Benchmark::Result>& Benchmark::getResults() {
+	return mResults;
+}
+
+// Outputs the results as a table represented as a string
+std::string Benchmark::toString() {
+	std::ostringstream str{};
+	str << std::fixed << std::setprecision(1);
+	str << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(8) << "items" << std::setw(14) << "ns/op";
+	str << std::setw(14) << "p50" << std::setw(14) << "p99" << std::setw(12) << "ns/item" << "\n";
+	for (const Result& r : mResults) {
+		str << std::left << std::setw(36) << r.name << std::right << std::setw(8) << r.items << std::setw(14) << r.nsPerOp;
+		str << std::setw(14) << r.nsP50 << std::setw(14) << r.nsP99 << std::setw(12) << r.nsPerItem << "\n";
+	}
+	return str.str();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/* Benchmark - Timing harness for the engine microbenchmarks
+ *
+ * run() times a callable by first doubling the number of calls per batch until one batch takes at least
+ * SAMPLE_MS, then timing SAMPLES batches of that many calls. Each batch gives one nanoseconds per call
+ * sample, so the mean, p50 and p99 are of the batch averages and a single slow call is spread over its
+ * batch. items is how many things one call works through (rectangles scanned, sprites moved, lines
+ * parsed) so results can also be compared per item as N grows.
+ *
+ * Callables should pass anything they compute to keep() so the optimizer can't throw the work away.
+ * Benchmarks whose name doesn't contain the filter given at construction are skipped.
+ */
+class Benchmark {
+
+public:
+	static constexpr int		SAMPLES		{ 50 };		// Timed batches per benchmark
+	static constexpr decimal	SAMPLE_MS	{ 5 };		// Least time one batch should take
+
+	// One benchmark's results. Times are in nanoseconds per call.
+	struct Result {
+		std::string name{};
+		Uint64 items{ 0 };			// Things one call works through
+		Uint64 iterations{ 0 };		// Calls made across all timed batches
+		decimal nsPerOp{ 0 };
+		decimal nsP50{ 0 };
+		decimal nsP99{ 0 };
+		decimal nsPerItem{ 0 };
+	};
+
+	// Constructor takes a filter, only benchmarks whose name contains it are run. An empty filter runs everything.
+	Benchmark(std::string filter);
+	Benchmark() = delete;
+
+	// Returns true if the named benchmark passes the filter. Lets callers skip setting up benchmarks that won't run.
+	bool isSelected(const std::string& name);
+
+	// Times fn as described above and stores the result under name. items is how many things one call of fn works through.
+	template <typename F>
+	void run(const std::string& name, Uint64 items, F&& fn) {
+		if (!isSelected(name)) return;
+
+		// Warm up and find how many calls make a batch at least SAMPLE_MS long
+		Uint64 calls{ 1 };
+		while (timeCalls(fn, calls) < SAMPLE_MS * 1000000.0 && calls < (Uint64{ 1 } << 40)) calls *= 2;
+
+		// Time the batches
+		std::vector<decimal> samples(SAMPLES);
+		for (decimal& s : samples) s = timeCalls(fn, calls) / calls;
+
+		addResult(name, items, calls * SAMPLES, samples);
+	}
+
+	// Stores a value where the optimizer can't see it's never read.
+	template <typename T>
+	static void keep(const T& value) { mSink = mSink + static_cast<int>(value); }
+
+	// Writes all results as a JSON array to the given file, or the standard output stream if it is empty. Returns success.
+	bool writeJSON(std::string file);
+
+	// Returns the results collected so far.
+	const std::vector<Result>& getResults();
+
+	// Outputs the results as a table represented as a string
+	std::string toString();
+
+private:
+	// Only benchmarks whose name contains this are run
+	std::string mFilter{};
+
+	// Results in the order they were run
+	std::vector<Result> mResults{};
+
+	// Performance counter ticks per nanosecond
+	decimal mCountsPerNS{};
+
+	// Written by keep() so benchmarked work has a visible side effect
+	static inline volatile int mSink{ 0 };
+
+	// Calls fn the given number of times and returns the nanoseconds taken.
+	template <typename F>
+	decimal timeCalls(F& fn, Uint64 calls) {
+		Uint64 start{ SDL_GetPerformanceCounter() };
+		for (Uint64 i{ 0 }; i < calls; ++i) fn();
+		return (SDL_GetPerformanceCounter() - start) / mCountsPerNS;
+	}
+
+	// Works out the statistics of a finished benchmark's batch samples and stores them.
+	void addResult(const std::string& name, Uint64 items, Uint64 iterations, std::vector<decimal>& samples);
+};
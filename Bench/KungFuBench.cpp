@@ -0,0 +1,200 @@
+#include "Benchmark.h"
+#include "../Level.h"
+#include "../MisterX.h"
+#include "../SDLMan.h"
+#include "../TimerWheel.h"
+#include "../FrameStats.h"
+#include "../FensoxUtils.h"
+#include "../Log.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/*
+ * Entrypoint of the engine microbenchmarks.
+ *
+ * Times the engine's hot paths in isolation: level collision queries against N rectangles and N sprites,
+ * sprite collision rectangles, sprite movement, the comma delimited value parsers, level metadata
+ * parsing and frame statistics. Every benchmark with an N runs at several sizes so scaling shows up as
+ * well as the cost. SDL runs headless like "--headless" game runs, so no display or sound device is needed.
+ *
+ * Built by Bench/CMakeLists.txt alongside the game's sources, leaving out the game's own entrypoint:
+ *     cmake -S Bench -B build_bench -DCMAKE_BUILD_TYPE=Release && cmake --build build_bench --config Release
+ *
+ * Run from the repository root so Data/ is found:
+ *     build_bench/KungFuBench [--filter <text>] [--out <file>]
+ * --filter runs only benchmarks whose name contains the text. Results are written as JSON to the --out
+ * file (bench_results.json by default, "-" for the standard output stream) and a table is printed.
+ * Generated level files go in the system temporary directory.
+ */
+
+// Gives the benchmarks access to Level's metadata parser. Declared a friend in Level.h.
+class LevelBench {
+public:
+	// Clears the level's sprites and collision rectangles and parses its metadata file again. Returns success.
+	static bool loadDataFile(Level& level) {
+		level.resetLevel();
+		level.mColRects->clear();
+		return level.loadDataFile();
+	}
+};
+
+// Writes a level metadata file using Level1's background and music with the given number of collision rectangles and
+// STICKMAN sprites. Rectangles sit low in the level and sprites spawn on a floor straight away. Returns the file's path or an empty string on failure.
+std::string writeLevel(std::string name, int rects, int sprites) {
+	std::filesystem::path path{ std::filesystem::temp_directory_path() / ("kfmxr_bench_" + name + ".dat") };
+	std::ofstream out{ path };
+	if (!out) {
+		std::cerr << "Failed in writeLevel. Could not open file: " << path.string() << std::endl;
+		return "";
+	}
+
+	out << "# Generated by the engine microbenchmarks\n";
+	out << "NAME=" << name << "\nBACKGROUND=Data/level1.png\nTRANS_COLOR=92,148,252,0\nMUSIC=Data/kung_fu_music_edited.mp3\n";
+	out << "PLAYER_START=6000, 500\n";
+	out << "COLRECT=0, 620, 7000, 100\n";
+	for (int i{ 0 }; i < rects; ++i) out << "COLRECT=" << (i * 37) % 7000 << ", " << 400 + (i % 8) * 24 << ", 32, 16\n";
+	for (int i{ 0 }; i < sprites; ++i) out << "SPRITE=STICKMAN, " << 200 + (i * 53) % 5000 << ", 500, 0, G\n";
+
+	return path.string();
+}
+
+// Loads a level from the given metadata file and hooks the player and timers up to it as GameLoop::loadLevel does. Returns nullptr on failure.
+std::shared_ptr<Level> makeLevel(std::string file, std::shared_ptr<SDLMan> sdl, std::shared_ptr<Sprite> player, std::shared_ptr<TimerWheel> timers) {
+	if (file.empty()) return nullptr;
+
+	std::shared_ptr<Level> level{ std::make_shared<Level>(file, sdl) };
+	level->setLevel(level);
+	if (!level->load()) {
+		std::cerr << "Failed in makeLevel. Level::load returned false for: " << file << std::endl;
+		return nullptr;
+	}
+
+	player->setX(level->getPlayStart().x);
+	player->setY(level->getPlayStart().y);
+	player->storeTickStart();
+	player->setLevel(level);
+	level->setPlayer(player);
+	level->setTimers(timers);
+	return level;
+}
+
+int main(int argc, char* argv[]) {
+	Log::start();
+
+	std::string filter{};
+	std::string outFile{ "bench_results.json" };
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (arg == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		} else if (arg == "--out" && i + 1 < argc) {
+			outFile = argv[++i];
+			if (outFile == "-") outFile.clear();
+		}
+	}
+
+	// Bring SDL up headless and load the player the way a headless game run does
+	std::shared_ptr<SDLMan> sdl{ std::make_shared<SDLMan>("Kung Fu MXR Benchmarks") };
+	sdl->setHeadless(true);
+	if (!sdl->init()) {
+		std::cerr << "Failed in main. SDLMan::init returned false." << std::endl;
+		Log::stop();
+		return 1;
+	}
+	std::shared_ptr<TimerWheel> timers{ std::make_shared<TimerWheel>(FuGlobals::SIM_TICK_MS) };
+	std::shared_ptr<MisterX> player{ std::make_shared<MisterX>(sdl) };
+	if (!player->load()) {
+		std::cerr << "Failed in main. MisterX::load returned false." << std::endl;
+		Log::stop();
+		return 1;
+	}
+	player->setTimers(timers);
+
+	bool success{ true };
+	Benchmark bench{ filter };
+	std::weak_ptr<Sprite> colSprite{};
+
+	// Level geometry queries that miss everything. Horizontal lines are floor and ceiling checks and go through the heightfield, vertical ones are wall checks and go through the grid.
+	for (int n : { 16, 256, 4096 }) {
+		std::string name{ "level_collision_rects/" + std::to_string(n) };
+		std::string wallName{ "level_collision_walls/" + std::to_string(n) };
+		if (!bench.isSelected(name) && !bench.isSelected(wallName)) continue;
+		std::shared_ptr<Level> level{ makeLevel(writeLevel("rects_" + std::to_string(n), n, 0), sdl, player, timers) };
+		if (!level) { success = false; continue; }
+		Line line{ 100, 100, 300, 100 };
+		Line wall{ 200, 50, 200, 150 };
+		bench.run(name, n, [&]() { Benchmark::keep(level->isACollisionLine(FuGlobals::ColType::CT_LEVEL, line, *player, colSprite)); });
+		bench.run(wallName, n, [&]() { Benchmark::keep(level->isACollisionLine(FuGlobals::ColType::CT_LEVEL, wall, *player, colSprite)); });
+	}
+
+	// Sprite queries made by the player so it skips itself. Sprites spawn on the first tick and are spread along the level so
+	// the line misses them all and the region covers a few hundred pixels of them.
+	for (int n : { 8, 64, 256 }) {
+		std::string name{ "level_collision_sprites/" + std::to_string(n) };
+		std::string regionName{ "level_sprites_in_rect/" + std::to_string(n) };
+		if (!bench.isSelected(name) && !bench.isSelected(regionName)) continue;
+		std::shared_ptr<Level> level{ makeLevel(writeLevel("sprites_" + std::to_string(n), 0, n), sdl, player, timers) };
+		if (!level) { success = false; continue; }
+		level->moveSprites(FuGlobals::SIM_TICK_MS / 1000.0);
+		Line line{ 100, 100, 300, 100 };
+		SDL_Rect region{ 1000, 0, 400, 720 };
+		std::vector<std::weak_ptr<Sprite>> found{};
+		bench.run(name, n, [&]() { Benchmark::keep(level->isACollisionLine(FuGlobals::ColType::CT_SPRITE, line, *player, colSprite)); });
+		bench.run(regionName, n, [&]() { level->getSpritesInRect(region, found); Benchmark::keep(found.size()); });
+	}
+
+	// Sprite movement: gravity, friction and collision correction for N sprites standing on a floor
+	for (int n : { 8, 64, 256 }) {
+		std::string name{ "level_move_sprites/" + std::to_string(n) };
+		if (!bench.isSelected(name)) continue;
+		std::shared_ptr<Level> level{ makeLevel(writeLevel("move_" + std::to_string(n), 64, n), sdl, player, timers) };
+		if (!level) { success = false; continue; }
+		decimal dt{ FuGlobals::SIM_TICK_MS / 1000.0 };
+		bench.run(name, n, [&]() { level->moveSprites(dt); });
+	}
+
+	// Collision rectangle and edge helpers on the player
+	bench.run("sprite_collision_rect", 1, [&]() { Benchmark::keep(player->getCollisionRect().x); });
+	bench.run("sprite_coll_rect_lines", 4, [&]() {
+		Benchmark::keep(player->getCollRectBtm().x1);
+		Benchmark::keep(player->getCollRectLeft().y1);
+		Benchmark::keep(player->getCollRectRight().y2);
+		Benchmark::keep(player->getCollRectTop().x2);
+	});
+
+	// Comma delimited value parsers as used by the metadata loaders
+	std::string rectCDV{ "1248, 620, 7000, 100" };
+	std::string spriteCDV{ "STICKMAN, 1500, 500, 1200, G" };
+	bench.run("utils_rect_from_cdv", 1, [&]() { Benchmark::keep(std::get<1>(FensoxUtils::getRectFromCDV(rectCDV)).w); });
+	bench.run("utils_vector_from_cdv", 1, [&]() { Benchmark::keep(FensoxUtils::getVectorFromCDV(spriteCDV, true).size()); });
+
+	// Metadata parsing of large generated levels. Rectangles only so no sprite sheets are loaded.
+	for (int n : { 1000, 10000 }) {
+		std::string name{ "level_load_data/" + std::to_string(n) };
+		if (!bench.isSelected(name)) continue;
+		std::shared_ptr<Level> level{ std::make_shared<Level>(writeLevel("load_" + std::to_string(n), n, 0), sdl) };
+		level->setLevel(level);
+		bench.run(name, n, [&]() { Benchmark::keep(LevelBench::loadDataFile(*level)); });
+	}
+
+	// Frame statistics. SDLMan::calculateFPS was replaced by FrameStats, which SDLMan and GameLoop now call every frame and tick.
+	FrameStats stats{ "Bench" };
+	decimal sample{ 0 };
+	bench.run("frame_stats_add", 1, [&]() {
+		sample = sample < 20 ? sample + 0.37 : 0;
+		stats.add(sample);
+	});
+	bench.run("frame_stats_mark", 1, [&]() { stats.mark(); });
+
+	std::cout << bench.toString();
+	if (!bench.writeJSON(outFile)) success = false;
+
+	player.reset();
+	sdl.reset();
+	Log::stop();
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "CollisionGrid.h"
+#include <algorithm>
+#include <sstream>
+
+// Indexes the given rectangles over a level of the given pixel size. Replaces anything built before.
+void CollisionGrid::build(const std::vector<SDL_Rect>& rects, SDL_Point levelSize) {
+	using FuGlobals::COLLISION_CELL;
+
+	// cover the level and anything sticking out past it
+	int minX{ 0 }, minY{ 0 };
+	int maxX{ std::max(levelSize.x - 1, 0) }, maxY{ std::max(levelSize.y - 1, 0) };
+	mRectCount = 0;
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;	// empty rectangles can't collide with anything
+		minX = std::min(minX, r.x);
+		minY = std::min(minY, r.y);
+		maxX = std::max(maxX, r.x + r.w - 1);
+		maxY = std::max(maxY, r.y + r.h - 1);
+		++mRectCount;
+	}
+	mOrigin = { minX, minY };
+	mCols = (maxX - minX) / COLLISION_CELL + 1;
+	mRows = (maxY - minY) / COLLISION_CELL + 1;
+
+	// count the rectangles in each cell then turn the counts into where each cell's run starts
+	std::size_t cells{ static_cast<std::size_t>(mCols) * mRows };
+	mCellStart.assign(cells + 1, 0);
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;
+		for (int row{ getRow(r.y) }; row <= getRow(r.y + r.h - 1); ++row) {
+			for (int col{ getCol(r.x) }; col <= getCol(r.x + r.w - 1); ++col) ++mCellStart[static_cast<std::size_t>(row) * mCols + col + 1];
+		}
+	}
+	for (std::size_t i{ 1 }; i <= cells; ++i) mCellStart[i] += mCellStart[i - 1];
+
+	// copy each rectangle into its cells
+	mCellRects.assign(mCellStart[cells], SDL_Rect{});
+	std::vector<int> next{ mCellStart.begin(), mCellStart.end() - 1 };
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;
+		for (int row{ getRow(r.y) }; row <= getRow(r.y + r.h - 1); ++row) {
+			for (int col{ getCol(r.x) }; col <= getCol(r.x + r.w - 1); ++col) mCellRects[next[static_cast<std::size_t>(row) * mCols + col]++] = r;
+		}
+	}
+}
+
+// Returns the column holding a level x coordinate, clamped to the grid.
+int CollisionGrid::getCol(int x) {
+	return std::clamp((x - mOrigin.x) / FuGlobals::COLLISION_CELL, 0, mCols - 1);
+}
+
+// Returns the row holding a level y coordinate, clamped to the grid.
+int CollisionGrid::getRow(int y) {
+	return std::clamp((y - mOrigin.y) / FuGlobals::COLLISION_CELL, 0, mRows - 1);
+}
+
+// Calls test on each rectangle in the cells overlapping the inclusive pixel bounds given, once per rectangle, until it returns true.
+// Returns true if test did. tested is set to the number of rectangles tested.
+template <typename Test>
+bool CollisionGrid::query(int minX, int minY, int maxX, int maxY, int& tested, Test test) {
+	tested = 0;
+	if (mCols == 0 || mRows == 0) return false;
+
+	int col0{ getCol(minX) }, col1{ getCol(maxX) };
+	int row0{ getRow(minY) }, row1{ getRow(maxY) };
+	for (int row{ row0 }; row <= row1; ++row) {
+		for (int col{ col0 }; col <= col1; ++col) {
+			std::size_t cell{ static_cast<std::size_t>(row) * mCols + col };
+			for (int i{ mCellStart[cell] }; i < mCellStart[cell + 1]; ++i) {
+				const SDL_Rect& r{ mCellRects[i] };
+
+				// a rectangle in several cells is only tested in the first one both it and the query cover
+				if (col != std::max(col0, getCol(r.x)) || row != std::max(row0, getRow(r.y))) continue;
+
+				++tested;
+				if (test(r)) return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// Returns true if any rectangle intersects the line. tested is set to the number of rectangles tested.
+bool CollisionGrid::hasLine(const Line& line, int& tested) {
+	return query(std::min(line.x1, line.x2), std::min(line.y1, line.y2), std::max(line.x1, line.x2), std::max(line.y1, line.y2), tested, [&line](const SDL_Rect& r) {
+		// SDL clips the line it is given so test a copy
+		Line l{ line };
+		return SDL_IntersectRectAndLine(&r, &l.x1, &l.y1, &l.x2, &l.y2) == SDL_TRUE;
+	});
+}
+
+// Returns true if any rectangle contains the point.
+bool CollisionGrid::hasPoint(const SDL_Point& pnt) {
+	int tested{ 0 };
+	return query(pnt.x, pnt.y, pnt.x, pnt.y, tested, [&pnt](const SDL_Rect& r) { return SDL_PointInRect(&pnt, &r) == SDL_TRUE; });
+}
+
+// Returns true if any rectangle intersects the given one.
+bool CollisionGrid::hasRect(const SDL_Rect& rect) {
+	if (rect.w <= 0 || rect.h <= 0) return false;
+
+	int tested{ 0 };
+	return query(rect.x, rect.y, rect.x + rect.w - 1, rect.y + rect.h - 1, tested, [&rect](const SDL_Rect& r) { return SDL_HasIntersection(&rect, &r) == SDL_TRUE; });
+}
+
+// Outputs the object information represented as a string
+std::string CollisionGrid::toString() {
+	int fullest{ 0 };
+	for (std::size_t i{ 0 }; i + 1 < mCellStart.size(); ++i) fullest = std::max(fullest, mCellStart[i + 1] - mCellStart[i]);
+
+	std::ostringstream str{};
+	str << "CollisionGrid::Cells: " << mCols << " x " << mRows << " of " << FuGlobals::COLLISION_CELL << "px from " << mOrigin.x << ", " << mOrigin.y;
+	str << ", Rects: " << mRectCount << ", Stored: " << mCellRects.size() << ", Fullest cell: " << fullest << "\n";
+	return str.str();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include "Line.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/* CollisionGrid - Uniform grid index over a level's static collision rectangles
+ *
+ * Built once when a level loads. The area covered by the level and all its rectangles is split into
+ * cells COLLISION_CELL pixels square and every rectangle is copied into each cell it overlaps, cell by
+ * cell in one array so a cell's rectangles sit next to each other in memory. A query only tests the
+ * rectangles in the cells its own bounds overlap, so its cost depends on how crowded that part of the
+ * level is and not on how much geometry the level holds in total.
+ *
+ * A rectangle spanning several cells is only tested in the first of them the query visits, so no
+ * rectangle is tested twice and queries keep no state. Queries match SDL's own tests exactly
+ * (SDL_IntersectRectAndLine, SDL_PointInRect, SDL_HasIntersection). Anything outside the grid is
+ * clamped to its edge cells so geometry past the level bounds is still found.
+ */
+class CollisionGrid {
+
+public:
+	// Indexes the given rectangles over a level of the given pixel size. Replaces anything built before.
+	void build(const std::vector<SDL_Rect>& rects, SDL_Point levelSize);
+
+	// Returns true if any rectangle intersects the line. tested is set to the number of rectangles tested.
+	bool hasLine(const Line& line, int& tested);
+
+	// Returns true if any rectangle contains the point.
+	bool hasPoint(const SDL_Point& pnt);
+
+	// Returns true if any rectangle intersects the given one.
+	bool hasRect(const SDL_Rect& rect);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Top-left of the grid in level coordinates and its size in cells
+	SDL_Point mOrigin{ 0, 0 };
+	int mCols{ 0 };
+	int mRows{ 0 };
+
+	// Rectangles in each cell, cell by cell row by row. Cell i's run from mCellStart[i] to mCellStart[i + 1].
+	std::vector<SDL_Rect> mCellRects{};
+	std::vector<int> mCellStart{};
+
+	// Number of rectangles indexed
+	std::size_t mRectCount{ 0 };
+
+	// Returns the column or row holding a level x or y coordinate, clamped to the grid.
+	int getCol(int x);
+	int getRow(int y);
+
+	// Calls test on each rectangle in the cells overlapping the inclusive pixel bounds given, once per rectangle, until it returns true.
+	// Returns true if test did. tested is set to the number of rectangles tested.
+	template <typename Test>
+	bool query(int minX, int minY, int maxX, int maxY, int& tested, Test test);
+};
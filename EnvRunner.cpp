@@ -0,0 +1,206 @@
+#include "EnvRunner.h"
+#include "FensoxUtils.h"
+#include "Profiler.h"
+#include "Log.h"
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+
+// Constructor takes the options to run with. Call init() before use.
+EnvRunner::EnvRunner(Options options) {
+	mOptions = options;
+	mOptions.instances = std::max(mOptions.instances, 1);
+	mOptions.ticksPerStep = std::max(mOptions.ticksPerStep, 1);
+	if (mOptions.workers <= 0) mOptions.workers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+	mOptions.workers = std::min(mOptions.workers, mOptions.instances - 1);
+}
+
+// Stops the worker threads.
+EnvRunner::~EnvRunner() {
+	Log::debug("Destructor: EnvRunner");
+
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		mQuit = true;
+	}
+	mWake.notify_all();
+	for (std::thread& t : mWorkers) t.join();
+
+	// games go before the SDLMan they loaded from
+	mInstances.clear();
+	mSDL.reset();
+}
+
+// Brings up SDL headless, loads every instance, fills the first observations and starts the workers. Returns success.
+bool EnvRunner::init() {
+	mSDL = std::make_shared<SDLMan>("Kung Fu MXR Environments");
+	mSDL->setHeadless(true);
+	if (!mSDL->init()) {
+		std::cerr << "Failed in EnvRunner::init. SDLMan::init returned false." << std::endl;
+		return false;
+	}
+	mSDL->setMuted(true);
+
+	mInstances.resize(mOptions.instances);
+	mObs.assign(static_cast<std::size_t>(mOptions.instances) * OBS_SIZE, 0);
+	mDone.assign(mOptions.instances, 0);
+	mTicks.assign(mOptions.instances, 0);
+	for (int i{ 0 }; i < mOptions.instances; ++i) {
+		if (!makeInstance(i)) return false;
+	}
+
+	for (int i{ 0 }; i < mOptions.workers; ++i) mWorkers.emplace_back(&EnvRunner::runWorker, this);
+	return true;
+}
+
+// Makes and loads the given instance's game. Returns success.
+bool EnvRunner::makeInstance(int index) {
+	Instance& inst{ mInstances[index] };
+	inst.game = std::make_unique<GameLoop>();
+	inst.random.seed(mOptions.seed + index);
+	inst.held = 0;
+
+	if (!inst.game->initGameSystems(mSDL) || !inst.game->loadGameData(mOptions.levelFile)) {
+		std::cerr << "Failed in EnvRunner::makeInstance. Could not load instance " << index << " from \"" << mOptions.levelFile << "\"." << std::endl;
+		inst.game.reset();
+		return false;
+	}
+
+	mTicks[index] = 0;
+	storeObservation(index);
+	return true;
+}
+
+// Starts the given instance's game over with its original seed. Must be called from the thread that made the EnvRunner. Returns success.
+bool EnvRunner::reset(int index) {
+	if (index < 0 || index >= mOptions.instances) return false;
+	Uint64 ticks{ mTicks[index] };
+	bool success{ makeInstance(index) };
+	mTicks[index] = ticks;
+	return success;
+}
+
+// Runs every unfinished instance one step holding the given actions, one per instance, then updates the observations and done flags.
+void EnvRunner::step(const Uint8* actions) {
+	mActions = actions;
+	mNext = 0;
+
+	// wake the workers and help them out
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		mBusy = static_cast<int>(mWorkers.size());
+		++mGeneration;
+	}
+	mWake.notify_all();
+	runInstances();
+
+	std::unique_lock<std::mutex> lock{ mMutex };
+	mFinished.wait(lock, [this]() { return mBusy == 0; });
+}
+
+// Body of each worker thread.
+void EnvRunner::runWorker() {
+	Profiler::setThreadName("Env worker");
+
+	Uint64 seen{ 0 };
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock{ mMutex };
+			mWake.wait(lock, [this, seen]() { return mQuit || mGeneration != seen; });
+			if (mQuit) return;
+			seen = mGeneration;
+		}
+
+		runInstances();
+
+		std::lock_guard<std::mutex> lock{ mMutex };
+		if (--mBusy == 0) mFinished.notify_one();
+	}
+}
+
+// Claims and steps instances until there are none left this step.
+void EnvRunner::runInstances() {
+	for (int i{ mNext++ }; i < mOptions.instances; i = mNext++) stepInstance(i);
+}
+
+// Steps one instance with its action for this step.
+void EnvRunner::stepInstance(int index) {
+	Instance& inst{ mInstances[index] };
+	if (mDone[index] || !inst.game) return;
+
+	// press and release keys for the buttons that changed since the last step
+	SDL_Event events[ACT_BUTTONS]{};
+	int count{ 0 };
+	Uint8 action{ mActions[index] };
+	Uint8 changed{ static_cast<Uint8>(action ^ inst.held) };
+	for (int b{ 0 }; b < ACT_BUTTONS; ++b) {
+		if (!(changed & (1 << b))) continue;
+		bool down{ (action & (1 << b)) != 0 };
+		SDL_Event& e{ events[count++] };
+		e.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+		e.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+		e.key.keysym.sym = ACT_KEYS[b];
+	}
+	inst.held = action;
+
+	// this thread's random numbers are the instance's own while it steps
+	std::swap(FensoxUtils::rneGen, inst.random);
+	for (int t{ 0 }; t < mOptions.ticksPerStep; ++t) inst.game->stepTick(events, t == 0 ? count : 0);
+	std::swap(FensoxUtils::rneGen, inst.random);
+
+	mTicks[index] += mOptions.ticksPerStep;
+	storeObservation(index);
+}
+
+// Writes the given instance's observation and done flag.
+void EnvRunner::storeObservation(int index) {
+	float* obs{ &mObs[static_cast<std::size_t>(index) * OBS_SIZE] };
+	std::shared_ptr<MisterX> player{ mInstances[index].game->getPlayer().lock() };
+	std::shared_ptr<Level> level{ mInstances[index].game->getLevel().lock() };
+
+	obs[0] = static_cast<float>(player->getX());
+	obs[1] = static_cast<float>(player->getY());
+	obs[2] = static_cast<float>(player->getHealth());
+	obs[3] = static_cast<float>(level->storeObservation(obs + 4, OBS_SPRITES, player->getX(), player->getY()));
+
+	bool timeUp{ mOptions.maxTicks > 0 && mInstances[index].game->getTicks() >= mOptions.maxTicks };
+	mDone[index] = (player->getHealth() <= 0 || timeUp) ? 1 : 0;
+}
+
+// Returns the observation buffer, OBS_SIZE floats per instance in instance order.
+const float* EnvRunner::getObservations() {
+	return mObs.data();
+}
+
+// Returns the done flags, one per instance. Non-zero when that game's player has died or it has run maxTicks.
+const Uint8* EnvRunner::getDone() {
+	return mDone.data();
+}
+
+// Returns the number of instances.
+int EnvRunner::getCount() {
+	return mOptions.instances;
+}
+
+// Returns the number of worker threads, not counting the caller of step().
+int EnvRunner::getWorkerCount() {
+	return static_cast<int>(mWorkers.size());
+}
+
+// Returns the total simulation ticks run across all instances.
+Uint64 EnvRunner::getTotalTicks() {
+	Uint64 total{ 0 };
+	for (Uint64 t : mTicks) total += t;
+	return total;
+}
+
+// Outputs the object information represented as a string
+std::string EnvRunner::toString() {
+	int done{ 0 };
+	for (Uint8 d : mDone) done += d;
+
+	std::ostringstream str{};
+	str << "EnvRunner::Instances: " << mOptions.instances << ", Workers: " << mWorkers.size() << " + caller, Ticks per step: " << mOptions.ticksPerStep << "\n";
+	str << "EnvRunner::Level: " << mOptions.levelFile << ", Seed: " << mOptions.seed << ", Total ticks: " << getTotalTicks() << ", Done: " << done << "\n";
+	return str.str();
+}
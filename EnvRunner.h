@@ -0,0 +1,149 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include "GameLoop.h"
+#include "SDLMan.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/* EnvRunner - Many independent headless games stepped together across a pool of worker threads
+ *
+ * For balancing and bot testing. Each instance is a whole GameLoop (a Level, a MisterX, its own timers
+ * and scheduler) with its own random number stream seeded from the options, so instances don't share
+ * any simulation state. All instances share one headless, muted SDLMan which is only used while loading,
+ * so init() and reset() must be called from the thread that made the EnvRunner.
+ *
+ * step() takes one action per instance, a set of ACT_ button bits held for the step, turns changes in
+ * the held buttons into the same key events the keyboard sends and runs every instance TICKS_PER_STEP
+ * ticks. Instances are handed out to the worker threads, and the calling thread, one at a time as they
+ * free up. Afterwards observations for every instance are in one contiguous buffer of OBS_SIZE floats
+ * per instance:
+ *     player x, player y, player health, number of spawned level sprites,
+ *     then OBS_SPRITES times: x and y relative to the player and health of the nearest spawned sprites
+ * and the done flags say which games have ended. A finished game sits still until reset().
+ *
+ * Run the game with "--env <instances> <steps>" to measure throughput with random actions.
+ */
+class EnvRunner {
+
+public:
+	static constexpr int	OBS_SPRITES		{ 8 };						// Nearest level sprites in each observation
+	static constexpr int	OBS_SIZE		{ 4 + OBS_SPRITES * 3 };	// Floats per instance in the observation buffer
+
+	// Buttons an action holds down. Combine with |.
+	static constexpr Uint8	ACT_LEFT		{ 0x01 };
+	static constexpr Uint8	ACT_RIGHT		{ 0x02 };
+	static constexpr Uint8	ACT_DUCK		{ 0x04 };
+	static constexpr Uint8	ACT_JUMP		{ 0x08 };
+	static constexpr Uint8	ACT_PUNCH		{ 0x10 };
+	static constexpr Uint8	ACT_KICK		{ 0x20 };
+	static constexpr int	ACT_BUTTONS		{ 6 };						// Number of ACT_ bits in use
+
+	// How many games to run and how.
+	struct Options {
+		int instances{ 16 };
+		int workers{ 0 };								// Worker threads besides the caller, 0 for one per remaining hardware thread
+		int ticksPerStep{ 1 };							// Simulation ticks each step() runs
+		Uint64 maxTicks{ 0 };							// Ticks after which a game is done, 0 for no limit
+		Uint64 seed{ 1 };								// Instance i's random numbers are seeded with seed + i
+		std::string levelFile{ "Data/Level1.dat" };
+	};
+
+	// Constructor takes the options to run with. Call init() before use.
+	EnvRunner(Options options);
+	EnvRunner() = delete;
+
+	// Stops the worker threads.
+	~EnvRunner();
+
+	// Brings up SDL headless, loads every instance, fills the first observations and starts the workers. Returns success.
+	bool init();
+
+	// Runs every unfinished instance one step holding the given actions, one per instance, then updates the observations and done flags.
+	void step(const Uint8* actions);
+
+	// Starts the given instance's game over with its original seed. Must be called from the thread that made the EnvRunner. Returns success.
+	bool reset(int index);
+
+	// Returns the observation buffer, OBS_SIZE floats per instance in instance order.
+	const float* getObservations();
+
+	// Returns the done flags, one per instance. Non-zero when that game's player has died or it has run maxTicks.
+	const Uint8* getDone();
+
+	// Returns the number of instances.
+	int getCount();
+
+	// Returns the number of worker threads, not counting the caller of step().
+	int getWorkerCount();
+
+	// Returns the total simulation ticks run across all instances.
+	Uint64 getTotalTicks();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// One game and what it is holding down
+	struct Instance {
+		std::unique_ptr<GameLoop> game{ nullptr };
+		std::ranlux48 random{};
+		Uint8 held{ 0 };
+	};
+
+	// Options given at construction
+	Options mOptions{};
+
+	// SDL setup shared by every instance for loading
+	std::shared_ptr<SDLMan> mSDL{ nullptr };
+
+	// The games
+	std::vector<Instance> mInstances{};
+
+	// OBS_SIZE floats per instance
+	std::vector<float> mObs{};
+
+	// One per instance
+	std::vector<Uint8> mDone{};
+
+	// Ticks run per instance, summed when asked for
+	std::vector<Uint64> mTicks{};
+
+	// Actions for the step in progress
+	const Uint8* mActions{ nullptr };
+
+	// Worker pool. Each step bumps the generation to wake the workers, which claim instances from mNext until none are left.
+	std::vector<std::thread> mWorkers{};
+	std::mutex mMutex{};
+	std::condition_variable mWake{};
+	std::condition_variable mFinished{};
+	Uint64 mGeneration{ 0 };
+	int mBusy{ 0 };
+	bool mQuit{ false };
+	std::atomic<int> mNext{ 0 };
+
+	// Keys the ACT_ bits press, in bit order
+	static constexpr SDL_Keycode ACT_KEYS[ACT_BUTTONS]{ SDLK_LEFT, SDLK_RIGHT, SDLK_DOWN, SDLK_SPACE, SDLK_a, SDLK_d };
+
+	// Makes and loads the given instance's game. Returns success.
+	bool makeInstance(int index);
+
+	// Body of each worker thread.
+	void runWorker();
+
+	// Claims and steps instances until there are none left this step.
+	void runInstances();
+
+	// Steps one instance with its action for this step.
+	void stepInstance(int index);
+
+	// Writes the given instance's observation and done flag.
+	void storeObservation(int index);
+};
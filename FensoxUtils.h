@@ -6,6 +6,11 @@
 #include <SDL.h>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <charconv>
 
 
 /*
@@ -15,8 +20,9 @@
 */
 namespace FensoxUtils {
 
-    // Initializes a static random number generator used in some of the functions.
-	static std::ranlux48 rneGen;
+    // Random number generator used in some of the functions. One per thread, shared by every file, so games stepped on
+    // several threads at once (see EnvRunner) don't race on it and can each be given their own seeded stream.
+	inline thread_local std::ranlux48 rneGen;
 
 	// Static function to generate a random integer between the range specified in the parameters. Uses ranlux48 algorithm.
     static int getRandInt(int low, int high) {
@@ -142,10 +148,41 @@ namespace FensoxUtils {
         return vector;
     }
 
+    // Parses the whole of a string as a base 10 number into value. Returns false, leaving value alone, if the string is empty, has anything else in it or is out of range for T.
+    template <typename T>
+    static inline bool strToNum(const std::string& str, T& value) {
+        T parsed{};
+        const char* end{ str.data() + str.size() };
+        std::from_chars_result result{ std::from_chars(str.data(), end, parsed) };
+        if (str.empty() || result.ec != std::errc{} || result.ptr != end) return false;
+
+        value = parsed;
+        return true;
+    }
+
     // Takes a std::weak_ptr and returns whethar it is uninitialized or not. For testing if a weak_ptr is "null" or empty so to speak.
     template <typename T>
     static inline bool is_uninitialized(std::weak_ptr<T> const& weak) {
         using wt = std::weak_ptr<T>;
         return !weak.owner_before(wt{}) && !wt{}.owner_before(weak);
     }
+
+    // Starting value for hashBytes.
+    static constexpr Uint64 HASH_SEED{ 14695981039346656037ULL };
+
+    // Folds the given bytes into a running 64 bit FNV-1a hash and returns the new hash. Start from HASH_SEED. Not for security, just for checking two runs ended up the same.
+    static inline Uint64 hashBytes(const void* data, std::size_t len, Uint64 hash = HASH_SEED) {
+        const unsigned char* bytes{ static_cast<const unsigned char*>(data) };
+        for (std::size_t i{ 0 }; i < len; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Folds a trivially copyable value into a running hash. See hashBytes.
+    template <typename T>
+    static inline Uint64 hashValue(const T& value, Uint64 hash = HASH_SEED) {
+        return hashBytes(&value, sizeof(T), hash);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "FlightRecorder.h"
+#include "Metrics.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+// Constructor takes the frame budget in milliseconds. Frames longer than hitchFactor times this are hitches.
+FlightRecorder::FlightRecorder(decimal budgetMS, decimal hitchFactor) {
+	mBudgetMS = budgetMS;
+	mHitchMS = budgetMS * hitchFactor;
+
+	if constexpr (FuGlobals::FLIGHT_RECORDER) {
+		mTicks.resize(HISTORY);
+		mFrames.resize(HISTORY);
+	}
+}
+
+// Destructor waits for a dump still being written.
+FlightRecorder::~FlightRecorder() {
+	if (mWriter.joinable()) mWriter.join();
+}
+
+// Takes the names of the scheduler's tasks for the dump's column headings. Call once the tasks are registered.
+void FlightRecorder::setTaskNames(const Scheduler& scheduler) {
+	std::lock_guard<std::mutex> lock{ mMutex };
+	mTaskNames.clear();
+	for (std::size_t i{ 0 }; i < scheduler.getTaskCount() && i < MAX_TASKS; ++i) mTaskNames.push_back(scheduler.getTaskName(i));
+}
+
+// Records an input event applied before the next tick. Simulation side only.
+void FlightRecorder::recordInput(const SDL_Event& e) {
+	if constexpr (!FuGlobals::FLIGHT_RECORDER) return;
+
+	// count everything but only keep the first few
+	if (mCurrent.inputCount < MAX_INPUTS) {
+		InputRecord& in{ mCurrent.inputs[mCurrent.inputCount] };
+		in.type = e.type;
+		switch (e.type) {
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+				in.code = e.key.keysym.sym;
+				break;
+			case SDL_CONTROLLERBUTTONDOWN:
+			case SDL_CONTROLLERBUTTONUP:
+				in.code = e.cbutton.button;
+				break;
+			case SDL_CONTROLLERAXISMOTION:
+				in.code = e.caxis.axis;
+				in.value = e.caxis.value;
+				break;
+		}
+	}
+	++mCurrent.inputCount;
+}
+
+// Starts the record of a tick. Simulation side only.
+void FlightRecorder::beginTick(Uint64 tick, bool degraded) {
+	if constexpr (!FuGlobals::FLIGHT_RECORDER) return;
+
+	// input recorded since the last tick belongs to this one so is kept
+	mCurrent.tick = tick;
+	mCurrent.degraded = degraded;
+	mCurrent.startCounter = SDL_GetPerformanceCounter();
+	// the tick runs start to end on this thread so its own counters give this tick's counts, not other threads' or games'
+	mStartQueries = Metrics::getThreadTotal(Metric::MT_COLLISION_QUERIES);
+	mStartRects = Metrics::getThreadTotal(Metric::MT_COLLISION_RECTS);
+	mStartLoads = Metrics::getThreadTotal(Metric::MT_ASSETS_LOADED);
+}
+
+// Finishes the record of the tick with the scheduler's task times and the sprites simulated and adds it to the history. Simulation side only.
+void FlightRecorder::endTick(const Scheduler& scheduler, int spritesVisible) {
+	if constexpr (!FuGlobals::FLIGHT_RECORDER) return;
+
+	mCurrent.tickMS = static_cast<float>((SDL_GetPerformanceCounter() - mCurrent.startCounter) * 1000.0 / SDL_GetPerformanceFrequency());
+	for (std::size_t i{ 0 }; i < scheduler.getTaskCount() && i < MAX_TASKS; ++i) mCurrent.taskMS[i] = static_cast<float>(scheduler.getTaskMS(i));
+	mCurrent.spritesVisible = spritesVisible;
+	mCurrent.collisionQueries = static_cast<Uint32>(Metrics::getThreadTotal(Metric::MT_COLLISION_QUERIES) - mStartQueries);
+	mCurrent.rectsTested = static_cast<Uint32>(Metrics::getThreadTotal(Metric::MT_COLLISION_RECTS) - mStartRects);
+	mCurrent.assetLoads = static_cast<Uint32>(Metrics::getThreadTotal(Metric::MT_ASSETS_LOADED) - mStartLoads);
+
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		mTicks[mTickCount % HISTORY] = mCurrent;
+		++mTickCount;
+	}
+
+	// start the next tick with no input
+	mCurrent.inputCount = 0;
+}
+
+// Records a presented frame showing the given tick. Returns true if the frame was a hitch and dump() should be called. Render side only.
+bool FlightRecorder::endFrame(Uint64 tick) {
+	if constexpr (!FuGlobals::FLIGHT_RECORDER) return false;
+
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	Uint64 freq{ SDL_GetPerformanceFrequency() };
+
+	// first frame or the one after an idle has nothing to measure against
+	decimal frameMS{ 0 };
+	if (mLastFrameCounter != 0) frameMS = (now - mLastFrameCounter) * 1000.0 / freq;
+	mLastFrameCounter = now;
+
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		mFrames[mFrameCount % HISTORY] = FrameRecord{ mFrameCount, now, static_cast<float>(frameMS), tick };
+		++mFrameCount;
+	}
+
+	if (frameMS <= mHitchMS) return false;
+	++mHitches;
+
+	// one dump covers the whole window so hitches close together don't each write one
+	if (mLastDumpCounter != 0 && (now - mLastDumpCounter) * 1000.0 / freq < FuGlobals::FLIGHT_DUMP_MS) return false;
+
+	return true;
+}
+
+// Forgets the time of the last frame so the next one isn't measured. Call after the loop idles or stalls on purpose.
+void FlightRecorder::skipFrame() {
+	mLastFrameCounter = 0;
+}
+
+// Copies the last FLIGHT_DUMP_MS of history leading up to the last frame and appends it to the given file on a writer thread.
+// Returns false if the last dump is still being written and this one was skipped. Render side only.
+bool FlightRecorder::dump(std::string fileName) {
+	if constexpr (!FuGlobals::FLIGHT_RECORDER) return true;
+
+	// one write at a time so dumps can't interleave in the file
+	if (mWriting.load(std::memory_order_acquire)) return false;
+	if (mWriter.joinable()) mWriter.join();
+
+	// copy out what falls in the window so neither the simulation nor rendering waits on the file
+	Dump d{};
+	d.fileName = fileName;
+	d.freq = SDL_GetPerformanceFrequency();
+	d.budgetMS = mBudgetMS;
+	d.hitchMS = mHitchMS;
+	Uint64 window{ FuGlobals::FLIGHT_DUMP_MS * d.freq / 1000 };
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		if (mFrameCount == 0) return true;
+
+		d.end = mFrames[(mFrameCount - 1) % HISTORY].endCounter;
+		Uint64 start{ d.end > window ? d.end - window : 0 };
+
+		Uint64 oldest{ mFrameCount > HISTORY ? mFrameCount - HISTORY : 0 };
+		for (Uint64 i{ oldest }; i < mFrameCount; ++i) {
+			const FrameRecord& f{ mFrames[i % HISTORY] };
+			if (f.endCounter >= start) d.frames.push_back(f);
+		}
+
+		oldest = mTickCount > HISTORY ? mTickCount - HISTORY : 0;
+		for (Uint64 i{ oldest }; i < mTickCount; ++i) {
+			const TickRecord& t{ mTicks[i % HISTORY] };
+			if (t.startCounter >= start && t.startCounter <= d.end) d.ticks.push_back(t);
+		}
+
+		d.taskNames = mTaskNames;
+	}
+
+	mLastDumpCounter = SDL_GetPerformanceCounter();
+	mWriting.store(true, std::memory_order_release);
+	mWriter = std::thread{ &FlightRecorder::writeDump, this, std::move(d) };
+
+	return true;
+}
+
+// Formats a dump and appends it to its file. Body of the writer thread.
+void FlightRecorder::writeDump(Dump d) {
+	// times are written in milliseconds before the hitch frame ended
+	auto msBefore{ [&d](Uint64 counter) { return counter >= d.end ? 0.0 : (d.end - counter) * 1000.0 / d.freq; } };
+
+	std::ofstream out{ d.fileName, std::ios::app };
+	if (!out) {
+		std::cerr << "Failed in FlightRecorder::writeDump. Could not open \"" << d.fileName << "\"." << std::endl;
+		mWriting.store(false, std::memory_order_release);
+		return;
+	}
+
+	out << std::fixed << std::setprecision(3);
+	out << "== Hitch: frame " << d.frames.back().frame << " took " << d.frames.back().frameMS << " ms (budget " << d.budgetMS << " ms, hitch over " << d.hitchMS << " ms) ==\n";
+
+	out << "frames\n";
+	out << "frame,ms_before_hitch,frame_ms,tick\n";
+	for (const FrameRecord& f : d.frames) out << f.frame << "," << msBefore(f.endCounter) << "," << f.frameMS << "," << f.tick << "\n";
+
+	out << "ticks\n";
+	out << "tick,ms_before_hitch,tick_ms";
+	for (const std::string& name : d.taskNames) out << "," << name << "_ms";
+	out << ",degraded,sprites_visible,collision_queries,rects_tested,asset_loads,inputs\n";
+	for (const TickRecord& t : d.ticks) {
+		out << t.tick << "," << msBefore(t.startCounter) << "," << t.tickMS;
+		for (std::size_t i{ 0 }; i < d.taskNames.size(); ++i) out << "," << t.taskMS[i];
+		out << "," << t.degraded << "," << t.spritesVisible << "," << t.collisionQueries << "," << t.rectsTested << "," << t.assetLoads << ",";
+		for (int i{ 0 }; i < t.inputCount && i < MAX_INPUTS; ++i) out << (i > 0 ? " " : "") << inputToString(t.inputs[i]);
+		if (t.inputCount > MAX_INPUTS) out << " +" << (t.inputCount - MAX_INPUTS);
+		out << "\n";
+	}
+	out << "\n";
+	out.flush();
+
+	if (!out.good()) std::cerr << "Failed in FlightRecorder::writeDump. Error writing \"" << d.fileName << "\"." << std::endl;
+	mWriting.store(false, std::memory_order_release);
+}
+
+// Returns the number of hitches seen
+Uint64 FlightRecorder::getHitches() {
+	return mHitches;
+}
+
+// Outputs the object information represented as a string
+std::string FlightRecorder::toString() {
+	std::lock_guard<std::mutex> lock{ mMutex };
+	std::ostringstream str{};
+	str << "FlightRecorder::Ticks: " << mTickCount << ", Frames: " << mFrameCount << ", Hitches: " << mHitches << " over " << mHitchMS << " ms\n";
+	return str.str();
+}
+
+// Returns an input record as text, e.g. "down:Right".
+std::string FlightRecorder::inputToString(const InputRecord& in) {
+	std::ostringstream str{};
+	switch (in.type) {
+		case SDL_KEYDOWN:					str << "down:" << SDL_GetKeyName(in.code); break;
+		case SDL_KEYUP:						str << "up:" << SDL_GetKeyName(in.code); break;
+		case SDL_CONTROLLERBUTTONDOWN:		str << "pad_down:" << in.code; break;
+		case SDL_CONTROLLERBUTTONUP:		str << "pad_up:" << in.code; break;
+		case SDL_CONTROLLERAXISMOTION:		str << "axis" << in.code << ":" << in.value; break;
+		default:							str << "event:" << in.type; break;
+	}
+	return str.str();
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include "Scheduler.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+/* FlightRecorder - Always on history of the last few seconds, dumped when a frame hitches
+ *
+ * Owned by GameLoop. Every simulation tick adds a record of how long the tick and each scheduler
+ * task took, the input applied, how many sprites were simulated and how many collision queries,
+ * rectangles tested and asset loads happened. Every presented frame adds a record of its length.
+ * Both go into fixed size rings so recording never allocates and costs a few stores per tick.
+ *
+ * When a frame takes longer than HITCH_FACTOR times the frame budget, endFrame() returns true and
+ * the game loop calls dump() to append the last FLIGHT_DUMP_MS of frames and ticks to a file. Hitches
+ * we can't reproduce can then be looked at afterwards without having had the profiler running. dump()
+ * only copies the window out of the rings, formatting and writing the file happen on a writer thread so
+ * the dump doesn't cause a hitch of its own.
+ *
+ * Ticks are recorded by the simulation side and frames and dumps by the render side. The current
+ * tick's record belongs to the simulation alone, the rings are guarded by a mutex. Per tick counts come
+ * from the simulation thread's own Metrics counters, so recording takes no lock beyond the ring's.
+ */
+class FlightRecorder {
+
+public:
+	// Most ticks and frames kept. At 8ms ticks this is a little over 8 seconds.
+	static constexpr int HISTORY{ 1024 };
+
+	// Most scheduler tasks timed per tick
+	static constexpr int MAX_TASKS{ 8 };
+
+	// Most input events kept per tick
+	static constexpr int MAX_INPUTS{ 4 };
+
+	// An input event applied on a tick
+	struct InputRecord {
+		Uint32 type{ 0 };
+		Sint32 code{ 0 };		// key, button or axis
+		Sint16 value{ 0 };		// axis value
+	};
+
+	// Everything recorded about one simulation tick
+	struct TickRecord {
+		Uint64 tick{ 0 };
+		Uint64 startCounter{ 0 };
+		float tickMS{ 0 };
+		float taskMS[MAX_TASKS]{};
+		bool degraded{ false };
+		int spritesVisible{ 0 };
+		Uint32 collisionQueries{ 0 };
+		Uint32 rectsTested{ 0 };
+		Uint32 assetLoads{ 0 };
+		int inputCount{ 0 };
+		InputRecord inputs[MAX_INPUTS]{};
+	};
+
+	// One presented frame
+	struct FrameRecord {
+		Uint64 frame{ 0 };
+		Uint64 endCounter{ 0 };
+		float frameMS{ 0 };
+		Uint64 tick{ 0 };
+	};
+
+	// Constructor takes the frame budget in milliseconds. Frames longer than hitchFactor times this are hitches.
+	FlightRecorder(decimal budgetMS, decimal hitchFactor);
+	FlightRecorder() = delete;
+
+	// Destructor waits for a dump still being written.
+	~FlightRecorder();
+
+	// Takes the names of the scheduler's tasks for the dump's column headings. Call once the tasks are registered.
+	void setTaskNames(const Scheduler& scheduler);
+
+	// Records an input event applied before the next tick. Simulation side only.
+	void recordInput(const SDL_Event& e);
+
+	// Starts the record of a tick. Simulation side only.
+	void beginTick(Uint64 tick, bool degraded);
+
+	// Finishes the record of the tick with the scheduler's task times and the sprites simulated and adds it to the history. Simulation side only.
+	void endTick(const Scheduler& scheduler, int spritesVisible);
+
+	// Records a presented frame showing the given tick. Returns true if the frame was a hitch and dump() should be called. Render side only.
+	bool endFrame(Uint64 tick);
+
+	// Forgets the time of the last frame so the next one isn't measured. Call after the loop idles or stalls on purpose.
+	void skipFrame();
+
+	// Copies the last FLIGHT_DUMP_MS of history leading up to the last frame and appends it to the given file on a writer thread.
+	// Returns false if the last dump is still being written and this one was skipped. Render side only.
+	bool dump(std::string fileName);
+
+	// Returns the number of hitches seen
+	Uint64 getHitches();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Frame budget in milliseconds and the frame length counted as a hitch
+	decimal mBudgetMS{};
+	decimal mHitchMS{};
+
+	// Ticks and frames rings. Next write goes at count % HISTORY.
+	std::vector<TickRecord> mTicks{};
+	std::vector<FrameRecord> mFrames{};
+	Uint64 mTickCount{ 0 };
+	Uint64 mFrameCount{ 0 };
+
+	// Guards the rings and counts
+	std::mutex mMutex{};
+
+	// Tick being recorded and the simulation thread's counter totals it started at. Simulation side only.
+	TickRecord mCurrent{};
+	Uint64 mStartQueries{ 0 };
+	Uint64 mStartRects{ 0 };
+	Uint64 mStartLoads{ 0 };
+
+	// Performance counter at the end of the last frame, 0 to skip measuring the next. Render side only.
+	Uint64 mLastFrameCounter{ 0 };
+
+	// Performance counter at the last dump so dumps don't come faster than FLIGHT_DUMP_MS
+	Uint64 mLastDumpCounter{ 0 };
+
+	// Hitches seen, whethar dumped or not
+	Uint64 mHitches{ 0 };
+
+	// Task names for dump headings
+	std::vector<std::string> mTaskNames{};
+
+	// A window of history copied out of the rings for the writer thread
+	struct Dump {
+		std::string fileName{};
+		std::vector<FrameRecord> frames{};
+		std::vector<TickRecord> ticks{};
+		std::vector<std::string> taskNames{};
+		Uint64 end{ 0 };
+		Uint64 freq{ 0 };
+		decimal budgetMS{ 0 };
+		decimal hitchMS{ 0 };
+	};
+
+	// Thread writing the last dump and whethar it is still running. Render side only.
+	std::thread mWriter{};
+	std::atomic<bool> mWriting{ false };
+
+	// Formats a dump and appends it to its file. Body of the writer thread.
+	void writeDump(Dump d);
+
+	// Returns an input record as text, e.g. "down:Right".
+	static std::string inputToString(const InputRecord& in);
+};
@@ -0,0 +1,91 @@
+#include "FramePacer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// Constructor takes the pacing mode to use.
+FramePacer::FramePacer(FuGlobals::PaceMode mode) {
+	mMode = mode;
+
+	// Windows sleeps in ~15ms steps by default which is longer than a whole tick. Ask for 1ms timer resolution while we are alive.
+	// Needed in every mode as a threaded simulation always sleeps between ticks.
+#ifdef _WIN32
+	timeBeginPeriod(1);
+#endif
+}
+
+// Destructor
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+// Returns the pacing mode in use.
+FuGlobals::PaceMode FramePacer::getMode() {
+	return mMode;
+}
+
+// Waits, as our mode dictates, until the clock's next tick is due.
+void FramePacer::wait(SimClock& clock) {
+	// vsync blocks in present and uncapped never waits
+	if (mMode == FuGlobals::PaceMode::PM_HYBRID) waitForTick(clock);
+}
+
+// Sleeps then spins until the clock's next tick is due whatever our mode. Used by a simulation thread that must pace itself.
+void FramePacer::waitForTick(SimClock& clock) {
+	// an unpaced clock has no next tick to wait for
+	if (clock.getPaceMS() == 0) return;
+
+	// sleep most of the remaining time then spin the last PACE_SPIN_MS to land right on the tick
+	decimal remaining{ clock.getPaceMS() - clock.peekLag() };
+	if (remaining > FuGlobals::PACE_SPIN_MS) SDL_Delay(static_cast<Uint32>(remaining) - FuGlobals::PACE_SPIN_MS);
+	while (clock.peekLag() < clock.getPaceMS()) {}
+}
+
+// Sets the real time milliseconds between frames for waitForFrame(). 0 doesn't wait.
+void FramePacer::setFrameMS(decimal frameMS) {
+	mFrameCounts = frameMS > 0 ? static_cast<Uint64>(frameMS * SDL_GetPerformanceFrequency() / 1000) : 0;
+	mNextFrame = 0;
+}
+
+// Sleeps then spins until the next frame is due whatever our mode. Used by a render thread pacing itself apart from the simulation.
+void FramePacer::waitForFrame() {
+	if (mFrameCounts == 0) return;
+
+	// deadlines step a frame at a time so frames stay evenly spaced. A late frame, or the first, starts them again from now.
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	mNextFrame += mFrameCounts;
+	if (mNextFrame <= now) {
+		mNextFrame = now;
+		return;
+	}
+
+	// sleep most of the remaining time then spin the last PACE_SPIN_MS to land right on the deadline
+	decimal remaining{ (mNextFrame - now) * 1000.0 / SDL_GetPerformanceFrequency() };
+	if (remaining > FuGlobals::PACE_SPIN_MS) SDL_Delay(static_cast<Uint32>(remaining) - FuGlobals::PACE_SPIN_MS);
+	while (SDL_GetPerformanceCounter() < mNextFrame) {}
+}
+
+// Sleeps one low rate idle period. Called in place of a frame while isIdle() is true.
+void FramePacer::idle() {
+	SDL_Delay(FuGlobals::IDLE_DELAY_MS);
+}
+
+// Records whethar the window is minimized.
+void FramePacer::setMinimized(bool minimized) {
+	mMinimized = minimized;
+}
+
+// Records whethar the window has input focus.
+void FramePacer::setFocused(bool focused) {
+	mFocused = focused;
+}
+
+// Returns true if the window is in a state where the game loop should idle.
+bool FramePacer::isIdle() {
+	if constexpr (FuGlobals::IDLE_WHEN_UNFOCUSED) return mMinimized || !mFocused;
+	return mMinimized;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SimClock.h"
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <atomic>
+
+/* FramePacer - Keeps the game loop from burning a whole core
+ *
+ * Owned by GameLoop and called once per loop after the frame is presented. Three modes:
+ *
+ *    PM_HYBRID   - sleeps until PACE_SPIN_MS before the next simulation tick is due and spins
+ *                  the rest of the way. Accurate pacing with the CPU mostly idle. When the simulation
+ *                  has its own thread, rendering keeps a deadline of its own the same way with
+ *                  waitForFrame(), one frame length (see setFrameMS()) after the last.
+ *    PM_VSYNC    - does not wait at all. SDLMan creates its renderer with vsync so present blocks.
+ *    PM_UNCAPPED - does not wait at all. Renders as many frames as the machine can manage.
+ *
+ * The pacer also tracks window state fed to it from SDL window events. While the window is
+ * minimized (or unfocused if IDLE_WHEN_UNFOCUSED) isIdle() is true and the game loop should
+ * call idle() instead of simulating and rendering. Window state is atomic so a simulation thread
+ * may check isIdle() and call waitForTick() while the main thread handles window events.
+ */
+class FramePacer {
+
+public:
+	// Constructor takes the pacing mode to use.
+	FramePacer(FuGlobals::PaceMode mode);
+	FramePacer() = delete;
+
+	// Destructor
+	~FramePacer();
+
+	// Returns the pacing mode in use.
+	FuGlobals::PaceMode getMode();
+
+	// Waits, as our mode dictates, until the clock's next tick is due.
+	void wait(SimClock& clock);
+
+	// Sleeps then spins until the clock's next tick is due whatever our mode. Used by a simulation thread that must pace itself.
+	void waitForTick(SimClock& clock);
+
+	// Sets the real time milliseconds between frames for waitForFrame(). 0 doesn't wait.
+	void setFrameMS(decimal frameMS);
+
+	// Sleeps then spins until the next frame is due whatever our mode. Used by a render thread pacing itself apart from the simulation.
+	void waitForFrame();
+
+	// Sleeps one low rate idle period. Called in place of a frame while isIdle() is true.
+	void idle();
+
+	// Records whethar the window is minimized.
+	void setMinimized(bool minimized);
+
+	// Records whethar the window has input focus.
+	void setFocused(bool focused);
+
+	// Returns true if the window is in a state where the game loop should idle.
+	bool isIdle();
+
+private:
+	// Pacing mode in use
+	FuGlobals::PaceMode mMode{ FuGlobals::PaceMode::PM_HYBRID };
+
+	// Frame length for waitForFrame() in performance counter ticks, 0 to not wait
+	Uint64 mFrameCounts{ 0 };
+
+	// Performance counter value the next frame is due at. Render side only.
+	Uint64 mNextFrame{ 0 };
+
+	// Window is minimized. Set from the main thread, read by the simulation thread.
+	std::atomic<bool> mMinimized{ false };
+
+	// Window has input focus. Set from the main thread, read by the simulation thread.
+	std::atomic<bool> mFocused{ true };
+};
@@ -0,0 +1,141 @@
+#include "FrameStats.h"
+#include <sstream>
+#include <iomanip>
+
+// Constructor takes the name the series is reported under.
+FrameStats::FrameStats(std::string name) {
+	mName = name;
+	mCountsPerMS = static_cast<decimal>(SDL_GetPerformanceFrequency()) / 1000;
+}
+
+// Starts timing a section.
+void FrameStats::begin() {
+	mBegin = SDL_GetPerformanceCounter();
+}
+
+// Ends timing a section started with begin() and adds its length as a sample.
+void FrameStats::end() {
+	add((SDL_GetPerformanceCounter() - mBegin) / mCountsPerMS);
+}
+
+// Adds the time since the previous mark() as a sample. The first call only starts the clock.
+void FrameStats::mark() {
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	if (mLastMark != 0) add((now - mLastMark) / mCountsPerMS);
+	mLastMark = now;
+}
+
+// Adds a sample in milliseconds.
+void FrameStats::add(decimal ms) {
+	std::lock_guard<std::mutex> lock{ mMutex };
+
+	// drop the sample falling out of the window once it is full
+	if (mCount >= WINDOW) {
+		mSum -= mWindow[mNext];
+		--mHistogram[getBin(mWindow[mNext])];
+	}
+
+	mWindow[mNext] = ms;
+	mSum += ms;
+	++mHistogram[getBin(ms)];
+
+	// re-add the window each time round so floating point error in the running sum can't build up
+	mNext = (mNext + 1) % WINDOW;
+	if (mNext == 0) {
+		mSum = 0;
+		for (decimal s : mWindow) mSum += s;
+	}
+
+	if (mCount == 0) {
+		mEWMA = mMin = mMax = ms;
+	} else {
+		mEWMA += EWMA_ALPHA * (ms - mEWMA);
+		if (ms < mMin) mMin = ms;
+		if (ms > mMax) mMax = ms;
+	}
+	mLast = ms;
+	++mCount;
+}
+
+// Clears all samples.
+void FrameStats::reset() {
+	std::lock_guard<std::mutex> lock{ mMutex };
+
+	for (decimal& s : mWindow) s = 0;
+	for (Uint32& b : mHistogram) b = 0;
+	mNext = 0;
+	mSum = 0;
+	mCount = 0;
+	mLast = mEWMA = mMin = mMax = 0;
+	mLastMark = 0;
+}
+
+// Returns the latest sample. Cheaper than getSummary() for reading every frame.
+decimal FrameStats::getLast() {
+	std::lock_guard<std::mutex> lock{ mMutex };
+	return mLast;
+}
+
+// Returns a copy of the current statistics.
+FrameStats::Summary FrameStats::getSummary() {
+	std::lock_guard<std::mutex> lock{ mMutex };
+
+	Summary s{};
+	s.count = mCount;
+	if (mCount == 0) return s;
+
+	Uint32 samples{ static_cast<Uint32>(mCount < WINDOW ? mCount : WINDOW) };
+	s.last = mLast;
+	s.mean = mSum / samples;
+	s.ewma = mEWMA;
+	s.min = mMin;
+	s.max = mMax;
+	s.p50 = getPercentile(0.50, samples);
+	s.p95 = getPercentile(0.95, samples);
+	s.p99 = getPercentile(0.99, samples);
+
+	return s;
+}
+
+// Returns the series name.
+std::string FrameStats::getName() {
+	return mName;
+}
+
+// Outputs the series name and statistics represented as a string
+std::string FrameStats::toString() {
+	Summary s{ getSummary() };
+
+	std::ostringstream str{};
+	str << std::fixed << std::setprecision(2);
+	str << "FrameStats::" << mName << ": mean " << s.mean << "ms, ewma " << s.ewma << "ms, min " << s.min << "ms, max " << s.max << "ms";
+	str << ", p50 " << s.p50 << "ms, p95 " << s.p95 << "ms, p99 " << s.p99 << "ms, samples " << s.count << "\n";
+	return str.str();
+}
+
+// Returns the histogram bin for a sample.
+int FrameStats::getBin(decimal ms) {
+	int bin{ static_cast<int>(ms / BIN_MS) };
+	if (bin < 0) return 0;
+	if (bin >= BINS) return BINS - 1;
+	return bin;
+}
+
+// Returns the time below which the given fraction of windowed samples fall. Caller holds the lock.
+decimal FrameStats::getPercentile(decimal fraction, Uint32 samples) {
+	Uint32 target{ static_cast<Uint32>(fraction * samples + 0.5) };
+	if (target < 1) target = 1;
+
+	Uint32 seen{ 0 };
+	for (int bin{ 0 }; bin < BINS - 1; ++bin) {
+		seen += mHistogram[bin];
+		if (seen >= target) {
+			// top of the bin, but never past the slowest sample actually seen
+			decimal edge{ (bin + 1) * BIN_MS };
+			return edge < mMax ? edge : mMax;
+		}
+	}
+
+	// in the overflow bin
+	return mMax;
+}
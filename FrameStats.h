@@ -0,0 +1,111 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <mutex>
+
+/* FrameStats - Streaming statistics for one series of frame or tick times
+ *
+ * Times are measured with the high resolution performance counter in fractional milliseconds, either as
+ * the length of a begin()/end() section or as the interval between calls to mark(). Every sample updates
+ * everything in constant time:
+ *     mean over the last WINDOW samples from a running sum
+ *     exponentially weighted moving average
+ *     min and max since the last reset()
+ *     p50/p95/p99 over the last WINDOW samples from a fixed histogram of BINS bins BIN_MS wide
+ * Percentiles are read off the histogram so they are accurate to BIN_MS. Anything longer than the
+ * histogram range lands in the last bin and reports as the max.
+ *
+ * One thread adds samples to a series while any thread can read a Summary, so adding and reading take a
+ * short uncontended lock.
+ */
+class FrameStats {
+
+public:
+	static constexpr int		WINDOW		{ 256 };	// Samples the rolling mean and percentiles cover
+	static constexpr int		BINS		{ 2000 };	// Histogram bins
+	static constexpr decimal	BIN_MS		{ 0.05 };	// Histogram bin width in milliseconds. BINS * BIN_MS is the range covered.
+	static constexpr decimal	EWMA_ALPHA	{ 0.05 };	// Weight of each new sample in the moving average
+
+	// A copy of a series' statistics at one moment. All times in milliseconds.
+	struct Summary {
+		Uint64 count{ 0 };		// Samples since the last reset
+		decimal last{ 0 };
+		decimal mean{ 0 };
+		decimal ewma{ 0 };
+		decimal min{ 0 };
+		decimal max{ 0 };
+		decimal p50{ 0 };
+		decimal p95{ 0 };
+		decimal p99{ 0 };
+	};
+
+	// Constructor takes the name the series is reported under.
+	FrameStats(std::string name);
+	FrameStats() = delete;
+
+	// Starts timing a section.
+	void begin();
+
+	// Ends timing a section started with begin() and adds its length as a sample.
+	void end();
+
+	// Adds the time since the previous mark() as a sample. The first call only starts the clock.
+	void mark();
+
+	// Adds a sample in milliseconds.
+	void add(decimal ms);
+
+	// Clears all samples.
+	void reset();
+
+	// Returns the latest sample. Cheaper than getSummary() for reading every frame.
+	decimal getLast();
+
+	// Returns a copy of the current statistics.
+	Summary getSummary();
+
+	// Returns the series name.
+	std::string getName();
+
+	// Outputs the series name and statistics represented as a string
+	std::string toString();
+
+private:
+	// Name of the series
+	std::string mName{};
+
+	// Guards the statistics between the adding thread and readers
+	std::mutex mMutex{};
+
+	// Performance counter ticks per millisecond
+	decimal mCountsPerMS{};
+
+	// Performance counter at begin() and at the last mark()
+	Uint64 mBegin{ 0 };
+	Uint64 mLastMark{ 0 };
+
+	// The last WINDOW samples and the index the next one goes in
+	decimal mWindow[WINDOW]{};
+	int mNext{ 0 };
+
+	// Sum of the samples in mWindow
+	decimal mSum{ 0 };
+
+	// Counts of the samples in mWindow by bin
+	Uint32 mHistogram[BINS]{};
+
+	// Running statistics since the last reset
+	Uint64 mCount{ 0 };
+	decimal mLast{ 0 };
+	decimal mEWMA{ 0 };
+	decimal mMin{ 0 };
+	decimal mMax{ 0 };
+
+	// Returns the histogram bin for a sample.
+	static int getBin(decimal ms);
+
+	// Returns the time below which the given fraction of windowed samples fall. Caller holds the lock.
+	decimal getPercentile(decimal fraction, Uint32 samples);
+};
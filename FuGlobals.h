@@ -10,8 +10,34 @@ namespace FuGlobals {
 	
 	static constexpr bool		DEBUG_MODE				{ true };				// Turn on all debug output
 	static constexpr bool		MUSIC					{ false };				// Turn on music
-	static constexpr bool		SHOW_FPS				{ false };				// Turn on FPS readout
-	static constexpr Uint32		FPS_TARGET				{ 8 };					// FPS target for game loop as milliseconds per frame (0 for unlimited). i.e. for 60fps set to 16, 120fps set to 8, etc.
+	static constexpr bool		SHOW_FPS				{ false };				// Turn on FPS and frame time readout, once a second
+	static constexpr bool		PROFILE					{ false };				// Record ProfileZone timings. F12 in game writes them to PROFILE_TRACE_FILE, open with chrome://tracing or ui.perfetto.dev.
+	static constexpr const char* PROFILE_TRACE_FILE		{ "profile_trace.json" };// File the profiler trace is written to
+	static constexpr bool		METRICS					{ false };				// Export engine counters and gauges (see Metrics.h) as line protocol every METRICS_PERIOD_MS.
+	static constexpr const char* METRICS_SINK			{ "metrics.lp" };		// File metrics are appended to, or "unix:<path>" to write to a Unix domain socket.
+	static constexpr Uint32		METRICS_PERIOD_MS		{ 1000 };				// Milliseconds between metrics exports.
+	static constexpr bool		FLIGHT_RECORDER			{ true };				// Keep the last few seconds of per tick data and dump it to FLIGHT_DUMP_FILE when a frame hitches.
+	static constexpr decimal	HITCH_FACTOR			{ 3 };					// A frame longer than HITCH_FACTOR times FPS_TARGET (or SIM_TICK_MS if FPS_TARGET is 0) is a hitch.
+	static constexpr Uint32		FLIGHT_DUMP_MS			{ 3000 };				// Milliseconds of history written per hitch. Also the least time between dumps.
+	static constexpr const char* FLIGHT_DUMP_FILE		{ "hitch_dump.txt" };	// File hitch dumps are appended to
+	static constexpr bool		HEATMAP					{ false };				// Gather tick and frame cost by player position and write HEATMAP_FILE.csv and .png on exit.
+	static constexpr int		HEATMAP_CELL			{ 32 };					// Pixel size of a heatmap cell in level space.
+	static constexpr const char* HEATMAP_FILE			{ "heatmap" };			// Heatmap file name without extension
+	static constexpr bool		PERF_OVERLAY			{ false };				// Build the in game performance overlay. F3 shows and hides it.
+	static constexpr const char* OVERLAY_FONT			{ "Data/Fonts/SourceCodePro-Regular.ttf" };	// Monospace TTF font the overlay text is drawn with, relative to the executable or else the working directory
+	static constexpr int		OVERLAY_FONT_SIZE		{ 12 };					// Point size of the overlay text
+	static constexpr bool		ALLOC_TRACK				{ false };				// Count heap allocations per thread and AllocScope tag. Past ALLOC_WARMUP_TICKS a tick or frame that allocates is reported and fails headless runs.
+	static constexpr Uint64		ALLOC_WARMUP_TICKS		{ 250 };				// Ticks allowed to allocate while storage grows to its steady state size.
+	static constexpr Uint32		FPS_TARGET				{ 8 };					// Real time milliseconds per simulation tick (0 for unlimited). Matching SIM_TICK_MS runs the game at real time speed.
+	static constexpr Uint32		SIM_TICK_MS				{ 8 };					// Simulated milliseconds per tick. Fixed dt every physics step integrates with, independent of render FPS.
+	static constexpr int		MAX_TICKS_PER_FRAME		{ 5 };					// Most simulation ticks the game loop will run to catch up before it must render a frame.
+	static constexpr Uint32		MAX_LAG_MS				{ 100 };				// Most real time lag in milliseconds kept after a stall. Anything beyond is dropped rather than simulated.
+	static constexpr bool		DEGRADE_WHEN_BEHIND		{ true };				// Skip optional work (debug drawing) on frames where the game loop is catching up. Simulation work always runs.
+	static constexpr decimal	AI_HZ					{ 20 };					// Times per second each non-player sprite re-plans. Staggered across sprites so cost is spread over ticks.
+	static constexpr decimal	ANIM_HZ					{ 60 };					// Times per second sprite animations are stepped.
+	static constexpr decimal	AUDIO_HZ				{ 60 };					// Times per second queued sound effects are sent to the mixer.
+	static constexpr bool		THREADED_SIM			{ true };				// Run the simulation on its own thread. Main thread keeps SDL events and rendering, fed by world snapshots.
+	static constexpr bool		INTERPOLATE				{ true };				// Render sprites and viewport interpolated between the last two simulation ticks for smooth scrolling.
 	static constexpr int		VIEWPORT_WIDTH			{ 1280 };				// Internal rendering width - independant of window size. Scaled to fit whatever window needed.
 	static constexpr int		VIEWPORT_HEIGHT			{ 720 };				// Internal rendering height - independant of window size. Scaled to fit whatever window needed.
 	static constexpr int		VIEWPORT_BUFFER			{ 75 };					// Pixel sized area in center of viewport sprite can move without scrolling viewport.
@@ -20,12 +46,27 @@ namespace FuGlobals {
 	static constexpr int		PLAYER_HEALTH_ALPHA		{ 126 };				// Alpha transparency of player health HUD (0-255)
 
 	static constexpr int		JOYSTICK_DEAD_ZONE		{ 8000 };				// Analog joystick dead zone
-	static constexpr decimal	GRAVITY					{ 15 };					// Gravity defined as pixels/second of downward velocity to add to sprites
-	static constexpr decimal	TERMINAL_VELOCITY		{ 720 };				// Maximum pixels/second of downward velocity that gravity can make a player fall
-	static constexpr decimal	GROUND_FRICTION			{ 38.2 };				// Amount of horizontal pixels/second a solid surface slows a sprite.
-	static constexpr decimal	AIR_FRICTION			{ 38.2 };				// Amount of horizontal pixels/second the air slows a sprite when not standing on a solid surface.
+	static constexpr decimal	GRAVITY					{ 1875 };				// Gravity defined as pixels/second of downward velocity added to sprites each second
+	static constexpr decimal	TERMINAL_VELOCITY		{ 720 };				// Maximum pixels/second of downward velocity that gravity can make a sprite fall
+	static constexpr decimal	GROUND_FRICTION			{ 4775 };				// Amount of horizontal pixels/second a solid surface takes off a sprite's velocity each second.
+	static constexpr decimal	AIR_FRICTION			{ 4775 };				// Amount of horizontal pixels/second the air takes off a sprite's velocity each second when not standing on a solid surface.
 	static constexpr int		LEVEL_BOUNDS			{ 10 };					// Distance in pixels a player can get to the edge of the viewport when level boundry has been reached.
+	static constexpr int		COLLISION_CELL			{ 128 };				// Pixel size of a cell in the grid level collision rectangles are indexed by. See CollisionGrid.h.
+	static constexpr int		SPRITE_CELL				{ 128 };				// Pixel size of a cell in the spatial hash of active sprites. See SpriteHash.h.
 
 	enum class ColType		{ CT_LEVEL, CT_SPRITE };							// Indicate collision either with another sprite or with level geometry
 	enum class ColDirect	{ CD_UP, CD_DOWN, CD_LEFT, CD_RIGHT };				// Direction to check for a collision
+	enum class PaceMode		{ PM_HYBRID, PM_VSYNC, PM_UNCAPPED };				// How the game loop waits between frames: sleep then spin to the next tick, block on vsync, or not at all
+
+	static constexpr PaceMode	PACE_MODE				{ PaceMode::PM_HYBRID };// Frame pacing method. See PaceMode above.
+	static constexpr Uint32		PACE_SPIN_MS			{ 2 };					// In PM_HYBRID, milliseconds before the next tick to stop sleeping and spin. Covers OS sleep granularity.
+	static constexpr Uint32		RENDER_FRAME_MS			{ 0 };					// In PM_HYBRID with THREADED_SIM, real time milliseconds between rendered frames. 0 follows the display's refresh rate (FPS_TARGET if unknown).
+	static constexpr Uint32		IDLE_DELAY_MS			{ 100 };				// Milliseconds slept per loop while the window is minimized or unfocused. Simulation is paused while idle.
+	static constexpr bool		IDLE_WHEN_UNFOCUSED		{ true };				// Drop to the idle loop when the window loses focus, not just when minimized.
+
+	enum class LogLevel		{ LL_DEBUG, LL_INFO, LL_WARNING, LL_ERROR };		// Log message severity, least to most
+
+	static constexpr LogLevel	LOG_LEVEL				{ DEBUG_MODE ? LogLevel::LL_DEBUG : LogLevel::LL_WARNING };	// Log calls below this level compile to nothing. See Log.h.
+	static constexpr const char* LOG_FILE				{ "" };					// File log messages are appended to. Empty writes them to the standard error stream.
+	static constexpr Uint32		LOG_FLUSH_MS			{ 10 };					// Milliseconds the log writer thread sleeps between writing out what has been logged.
 }
\ No newline at end of file
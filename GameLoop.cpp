@@ -2,43 +2,130 @@
 #include "MisterX.h"
 #include "SDLMan.h"
 #include "FuGlobals.h"
+#include "InputScript.h"
+#include "FensoxUtils.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "AllocTracker.h"
+#include "Log.h"
 #include <iostream>
+#include <thread>
+#include <sstream>
 
 // Destructor
 GameLoop::~GameLoop() {
-	if constexpr (FuGlobals::DEBUG_MODE) std::cerr << "Destructor: GameLoop" << std::endl;
+	Log::debug("Destructor: GameLoop");
 
 	mPlayer.reset();
 	mLevel.reset();
+	mTimers.reset();
+	mOverlay.reset();
 	mSDL.reset();
 }
 
+// Set's whethar to run headless: no window, sound device or frame pacing. Must be called before initGameSystems().
+void GameLoop::setHeadless(bool headless) {
+	mHeadless = headless;
+}
+
 // Initializes the graphics and sound systems.
 bool GameLoop::initGameSystems() {
 	// Initialize our SDL wrapper class and a shared smart pointer to manage SDL things
 	mSDL = std::make_shared<SDLMan>("Kung Fu Mr. X's Revenge");
+	mSDL->setVSync(mPacer.getMode() == FuGlobals::PaceMode::PM_VSYNC);
+	mSDL->setHeadless(mHeadless);
 
 	// Try to have SDLMan initialize all systems
-	return mSDL->init();;
+	if (!mSDL->init()) return false;
+
+	// a threaded simulation leaves rendering to pace itself, at the display's rate unless told otherwise
+	decimal refreshMS{ mSDL->getRefreshMS() };
+	if constexpr (FuGlobals::RENDER_FRAME_MS > 0) mPacer.setFrameMS(FuGlobals::RENDER_FRAME_MS);
+	else mPacer.setFrameMS(refreshMS > 0 ? refreshMS : FuGlobals::FPS_TARGET);
+
+	return true;
+}
+
+// Uses an SDLMan that is already initialized instead of making one, running headless if it is. Lets many games share one SDL setup, see EnvRunner.
+bool GameLoop::initGameSystems(std::shared_ptr<SDLMan> sdl) {
+	if (!sdl) {
+		std::cerr << "Failed in GameLoop::initGameSystems. No SDLMan given." << std::endl;
+		return false;
+	}
+
+	mSDL = sdl;
+	mHeadless = mSDL->isHeadless();
+	return true;
 }
 
-// Loads in game data.
-bool GameLoop::loadGameData() {
+// Loads in game data starting on the given level metadata file.
+bool GameLoop::loadGameData(std::string levelFile) {
 	bool success{ true };
 
+	// Create the simulation's timer wheel before anything that schedules timers
+	mTimers = std::make_shared<TimerWheel>(FuGlobals::SIM_TICK_MS);
+
 	// Load the player
 	mPlayer = std::make_shared<MisterX>(mSDL);
 	if (!mPlayer->load()) success = false;
+	mPlayer->setTimers(mTimers);
 
 	//***DEBUG***
 	// This needs to be replaced with loading game level information from a game metafile not hardcoded like this
 	// Load the first level
-	if (!loadLevel("data/level1.dat")) success = false;
+	if (!loadLevel(levelFile)) success = false;
+
+	// Set up the subsystems that run each tick
+	registerSubsystems();
+
+	// Build the performance overlay. It is only a debugging aid so the game goes on without it.
+	if constexpr (FuGlobals::PERF_OVERLAY) {
+		if (!mHeadless) {
+			mOverlay = std::make_unique<PerfOverlay>(mSDL, FuGlobals::FPS_TARGET > 0 ? FuGlobals::FPS_TARGET : FuGlobals::SIM_TICK_MS);
+			if (!mOverlay->load()) {
+				std::cerr << "Warning in GameLoop::loadGameData. PerfOverlay::load returned false, running without the performance overlay." << std::endl;
+				mOverlay.reset();
+			}
+		}
+	}
 
 	// Return successful loading of game data.
 	return success;
 }
 
+// Registers the simulation subsystems (physics, AI, animation, audio) with the scheduler at their own rates.
+// Each runs on the tick's current mPlayer and mLevel so they keep working across level loads.
+void GameLoop::registerSubsystems() {
+	using namespace FuGlobals;
+
+	// AI first so movement this tick acts on fresh decisions. Staggered across sprites. Never skipped when behind, the
+	// simulation must not depend on wall clock load or replays and headless runs wouldn't reproduce.
+	mScheduler.addTask("AI", AI_HZ, 0, 0, true, false, [this](Uint32 slice, Uint32 period) {
+		mLevel->thinkSprites(slice, period);
+	});
+
+	// physics and movement every tick
+	mScheduler.addTask("Physics", 1000.0 / SIM_TICK_MS, 0, 1, false, false, [this](Uint32, Uint32) {
+		mPlayer->storeTickStart();
+		mPlayer->move(mClock.getDT());
+		mLevel->moveSprites(mClock.getDT());
+	});
+
+	// animation and audio offset from each other so they don't land on the same tick
+	mScheduler.addTask("Animation", ANIM_HZ, 0, 2, false, false, [this](Uint32, Uint32) {
+		mPlayer->animate();
+		mLevel->animateSprites();
+	});
+	mScheduler.addTask("Audio", AUDIO_HZ, 1, 3, false, false, [this](Uint32, Uint32) {
+		mSDL->playQueuedSounds();
+	});
+
+	// the flight recorder labels task timings with their names
+	mFlight.setTaskNames(mScheduler);
+
+	if constexpr (DEBUG_MODE) std::cout << mScheduler.toString();
+}
+
 // Load in the current level
 bool GameLoop::loadLevel(std::string lvlDataFile) {
 	bool success{ true };
@@ -54,8 +141,11 @@ bool GameLoop::loadLevel(std::string lvlDataFile) {
 		if (mPlayer) {
 			mPlayer->setX(mLevel->getPlayStart().x);
 			mPlayer->setY(mLevel->getPlayStart().y);
+			mPlayer->storeTickStart();
 			mPlayer->setLevel(mLevel);
 			mLevel->setPlayer(mPlayer);
+			mLevel->setTimers(mTimers);
+			if constexpr (FuGlobals::HEATMAP) mHeatmap.reset(mLevel->getSize());
 			//***DEBUG***
 			mLevel->setFollowSprite(mPlayer);
 			//mLevel->setFollowSprite(0);
@@ -72,69 +162,395 @@ void GameLoop::runGameLoop() {
 	// Show the window
 	mSDL->showWindow(true);
 
-	// Set some variables for use in our loop
-	bool quit{ false };					// whethar to quit the loop or not
-	double previous = SDL_GetTicks();	// holds current time in milliseconds since SDL init - game loop speed/FPS management
-	double lag = 0;						// will hold lag between game time elapsed and real time elapsed - game loop speed/FPS management
-	
 	// Start music if toggled on
 	if constexpr (FuGlobals::MUSIC) mSDL->toggleMusic();
-	
+
+	// give rendering something to draw before the first tick
+	publishSnapshot();
+	Profiler::setThreadName("Main");
+
 	// Start the main loop
 	// Game loop uses "Fixed update time step, variable rendering" method written about
 	// in the book Game Programming Patterns by Robert Nystrom. Adjust performance
-	// of this loop by setting the integer variable FPS_TARGET in the FuGlobals.h header.
-	while (!quit) {
-		// some time calculations to manage game loop speed
-		double current = SDL_GetTicks();
-		double elapsed = current - previous;
-		previous = current;
-		lag += elapsed;
-
-		// progress game logic without rendering to backbuffer until FPS target has been reached (for slow systems or network connections)
-		while (lag >= FuGlobals::FPS_TARGET) {
-			// handle input events
-			quit = handleEvents();
-
-			// process movements of the player
-			mPlayer->move();
-			
-			// process movements of non-player sprites
-			mLevel->moveSprites();
-
-			// update our time lag calculations
-			lag -= FuGlobals::FPS_TARGET;
+	// of this loop by setting FPS_TARGET and SIM_TICK_MS in the FuGlobals.h header.
+	if constexpr (FuGlobals::THREADED_SIM) runThreaded();
+	else runSingleThreaded();
 
-			//***DEBUG***
-			if constexpr (FuGlobals::SHOW_FPS) mSDL->outputFPS();
+	// close off the recording now the simulation has stopped
+	finishRecording();
+
+	// report input to photon latency if measuring
+	if (mLatency) std::cout << mLatency->toString();
+
+	// write out whatever the profiler still holds
+	if constexpr (FuGlobals::PROFILE) Profiler::dumpTrace(FuGlobals::PROFILE_TRACE_FILE);
+	if constexpr (FuGlobals::HEATMAP) mHeatmap.save(FuGlobals::HEATMAP_FILE);
+
+	//***DEBUG*** report how the simulation clock and input latching kept up
+	if constexpr (FuGlobals::DEBUG_MODE) std::cout << mClock.toString() << mInput.toString() << mSimStats.toString() << mSDL->getFrameStats().toString() << mFlight.toString();
+	if constexpr (FuGlobals::ALLOC_TRACK) std::cout << AllocTracker::toString();
+}
+
+// Runs simulation and rendering one after the other on the calling thread.
+void GameLoop::runSingleThreaded() {
+	mClock.reset();	// start measuring real time lag from here - game loop speed management
+
+	while (!mQuit) {
+		// window is minimized or unfocused. Pause the simulation, keep handling events, and sleep at a low rate.
+		if (mPacer.isIdle()) {
+			if (handleEvents()) mQuit = true;
+			mPacer.idle();
+			mClock.reset();
+			mFlight.skipFrame();
+			continue;
+		}
+
+		// progress game logic without rendering to backbuffer until FPS target has been reached
+		simulate();
+
+		// render to back buffer interpolating between the last two ticks by how much lag is left over
+		render(mSnapshots.read(), FuGlobals::INTERPOLATE ? mClock.getAlpha() : 1);
+
+		// sleep/spin until the next tick is due (or let vsync do the waiting) rather than busy looping
+		mPacer.wait(mClock);
+	}
+}
+
+// Runs the simulation on a second thread while the calling thread handles events and renders.
+void GameLoop::runThreaded() {
+	std::thread simThread{ &GameLoop::runSimulationThread, this };
+
+	while (!mQuit) {
+		// SDL events must be pumped on the thread that created the window. Input is queued for the simulation thread.
+		if (handleEvents()) mQuit = true;
+
+		// window is minimized or unfocused. The simulation thread pauses itself, we just sleep at a low rate.
+		if (mPacer.isIdle()) {
+			mPacer.idle();
+			mFlight.skipFrame();
+			continue;
+		}
+
+		// draw the newest snapshot interpolated by how long ago the simulation published it. Frames drawn between snapshots
+		// show the same two ticks further along, so motion stays smooth whatever the tick rate.
+		const RenderSnapshot& snap{ mSnapshots.read() };
+		render(snap, FuGlobals::INTERPOLATE ? mClock.getAlphaSince(snap.publishCounter) : 1);
+
+		// when pacing ourselves, frames keep to the display's rate (see RENDER_FRAME_MS) rather than the simulation's
+		if (mPacer.getMode() == FuGlobals::PaceMode::PM_HYBRID) mPacer.waitForFrame();
+	}
+
+	simThread.join();
+}
+
+// Body of the simulation thread.
+void GameLoop::runSimulationThread() {
+	Profiler::setThreadName("Simulation");
+	mClock.reset();	// start measuring real time lag from here - game loop speed management
+
+	while (!mQuit) {
+		// window is minimized or unfocused. Pause the simulation.
+		if (mPacer.isIdle()) {
+			mPacer.idle();
+			mClock.reset();
+			continue;
+		}
+
+		simulate();
+
+		// sleep/spin until the next tick is due. Rendering no longer sets our pace so always wait regardless of pacing mode.
+		mPacer.waitForTick(mClock);
+	}
+}
+
+// Runs as many fixed simulation ticks as the clock says are due, within the catch up limits, then publishes a snapshot. Returns ticks run.
+int GameLoop::simulate() {
+	ProfileZone zone{ "GameLoop::simulate" };
+
+	// add real time elapsed since last iteration to the clock's lag
+	mClock.update();
+
+	// after a stall throw away lag beyond MAX_LAG_MS instead of trying to simulate all of it
+	Uint32 dropped{ mClock.clampLag(FuGlobals::MAX_LAG_MS) };
+	if (dropped > 0) Log::debug("GameLoop::simulate - Dropped {} ticks after a stall.", dropped);
+
+	// if more than one tick is due we are behind. Optionally skip non-essential work until caught up.
+	if constexpr (FuGlobals::DEGRADE_WHEN_BEHIND) mLevel->setDegraded(mClock.getTicksDue() > 1);
+
+	// Catch up is limited to MAX_TICKS_PER_FRAME so a slow frame can't snowball into an even slower one.
+	int steps{ 0 };
+	while (mClock.tickDue()) {
+		// ran out of catch up ticks this frame. Render and carry the remaining lag into the next frame.
+		if (steps >= FuGlobals::MAX_TICKS_PER_FRAME) {
+			mClock.countCappedFrame();
+			break;
+		}
+		++steps;
+
+		// latch input as late as possible, right before the tick. Threaded, the main thread keeps polling and sampling for us.
+		if constexpr (!FuGlobals::THREADED_SIM) {
+			if (handleEvents()) mQuit = true;
+		}
+		drainInput();
+
+		runTick();
+
+		// if FPS target is set to 0 break out as we are going for as many frames as we can
+		if constexpr (FuGlobals::FPS_TARGET == 0) break;
+	}
+
+	// hand the new state of the world to rendering
+	if (steps > 0) publishSnapshot();
+
+	return steps;
+}
+
+// Runs the given number of simulation ticks back to back as fast as possible with no rendering, feeding the player input from
+// scriptFile if one is given (see InputScript). Reports ticks per second and the final world state. Returns false if the script fails to load or a steady state tick allocated (see AllocTracker).
+bool GameLoop::runHeadless(Uint64 ticks, std::string scriptFile) {
+	InputScript script{ scriptFile };
+	if (!scriptFile.empty() && !script.load()) {
+		std::cerr << "Failed in GameLoop::runHeadless. InputScript::load returned false." << std::endl;
+		return false;
+	}
+
+	// the wall clock plays no part here, ticks run one after another with no pacing
+	mClock.reset();
+	Uint64 start{ SDL_GetPerformanceCounter() };
+
+	SDL_Event e{};
+	for (Uint64 i{ 0 }; i < ticks; ++i) {
+		// apply scripted input due on this tick the same way queued input is applied when threaded
+		while (script.pollEvent(mClock.getTicks(), e)) dispatchInput(e);
+		runTick();
+	}
+
+	reportHeadlessRun(ticks, start);
+	finishRecording();
+	if constexpr (FuGlobals::PROFILE) Profiler::dumpTrace(FuGlobals::PROFILE_TRACE_FILE);
+	if constexpr (FuGlobals::HEATMAP) mHeatmap.save(FuGlobals::HEATMAP_FILE);
+
+	// a steady state tick that allocated fails the run
+	return AllocTracker::getFailures() == 0;
+}
+
+// Runs a recorded session headless at full speed by feeding the recorded input in on the ticks it was recorded on.
+// Reports ticks per second and whethar the final world state hash matches the recording. Returns false if it fails to load, doesn't match or a steady state tick allocated.
+bool GameLoop::runReplay(std::string replayFile) {
+	Replay replay{ replayFile };
+	if (!replay.load(FuGlobals::SIM_TICK_MS)) {
+		std::cerr << "Failed in GameLoop::runReplay. Replay::load returned false." << std::endl;
+		return false;
+	}
 
-			// have our SDL wrapper update it's FPS averaging calculations once per frame so our physics works correctly
-			mSDL->calculateFPS();
+	mClock.reset();
+	Uint64 start{ SDL_GetPerformanceCounter() };
 
-			// if FPS target is set to 0 break out as we are going for as many frames as we can
-			if constexpr (FuGlobals::FPS_TARGET == 0) break;
+	SDL_Event e{};
+	while (mClock.getTicks() < replay.getTicks()) {
+		// apply what was applied at the start of this tick when recording
+		while (replay.pollEvent(mClock.getTicks(), e)) {
+			// degraded flag changes in older recordings only ever affected drawing
+			if (e.type != Replay::DEGRADED_EVENT) dispatchInput(e);
 		}
+		runTick();
+	}
+
+	reportHeadlessRun(replay.getTicks(), start);
+	if constexpr (FuGlobals::PROFILE) Profiler::dumpTrace(FuGlobals::PROFILE_TRACE_FILE);
+	if constexpr (FuGlobals::HEATMAP) mHeatmap.save(FuGlobals::HEATMAP_FILE);
+
+	// compare against where the recorded run ended up
+	Uint64 hash{ hashWorld() };
+	if (hash != replay.getHash()) {
+		std::cerr << "GameLoop::Replay diverged. Final state hash " << std::hex << hash << " but recording ended on " << replay.getHash() << std::dec << std::endl;
+		return false;
+	}
+	std::cout << "GameLoop::Replay matched the recorded final state." << std::endl;
+
+	// a steady state tick that allocated fails the run
+	return AllocTracker::getFailures() == 0;
+}
+
+// Records all player input and the final world state hash to the given file. Must be called before the game loop runs. Returns false if the file can't be opened.
+bool GameLoop::setRecordFile(std::string recordFile) {
+	mRecorder = std::make_unique<Replay>(recordFile);
+	if (!mRecorder->startRecording(FuGlobals::SIM_TICK_MS)) {
+		mRecorder.reset();
+		return false;
+	}
+	return true;
+}
+
+// Turns on input to photon latency measurement. The game loop injects the given number of synthetic inputs, quits once they
+// have all been presented and prints the latency distributions. Must be called before the game loop runs.
+void GameLoop::setLatencyProbe(int samples) {
+	mLatency = std::make_unique<LatencyProbe>(samples);
+}
+
+// Writes the end of the recording, if recording.
+void GameLoop::finishRecording() {
+	if (!mRecorder) return;
+
+	if (mRecorder->finishRecording(mClock.getTicks(), hashWorld())) {
+		std::cout << "GameLoop::Recorded " << mClock.getTicks() << " ticks." << std::endl;
+	}
+	mRecorder.reset();
+}
+
+// Prints ticks per second for a headless run that started at the given performance counter, then the final world state.
+void GameLoop::reportHeadlessRun(Uint64 ticks, Uint64 startCounter) {
+	decimal seconds{ static_cast<decimal>(SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency() };
+	std::cout << "GameLoop::Headless run: " << ticks << " ticks in " << seconds << " seconds, ";
+	std::cout << (seconds > 0 ? ticks / seconds : 0) << " ticks/sec, ";
+	std::cout << (ticks * FuGlobals::SIM_TICK_MS / 1000.0) << " seconds of game time\n";
+	std::cout << mSimStats.toString();
+	std::cout << worldToString();
+	std::cout << "GameLoop::State hash: " << std::hex << hashWorld() << std::dec << std::endl;
+}
+
+// Applies the given player input events then runs one simulation tick. Steps a headless game from outside the game loop, see EnvRunner.
+void GameLoop::stepTick(const SDL_Event* events, int count) {
+	for (int i{ 0 }; i < count; ++i) dispatchInput(events[i]);
+	runTick();
+}
+
+// Returns the player sprite.
+std::weak_ptr<MisterX> GameLoop::getPlayer() {
+	return mPlayer;
+}
+
+// Returns the level being played.
+std::weak_ptr<Level> GameLoop::getLevel() {
+	return mLevel;
+}
+
+// Returns the number of simulation ticks run.
+Uint64 GameLoop::getTicks() {
+	return mClock.getTicks();
+}
+
+// Returns a hash of the simulation tick, player and level sprite state. Two runs with the same hash ended in the same state.
+Uint64 GameLoop::hashWorld() {
+	Uint64 hash{ FensoxUtils::hashValue(mClock.getTicks()) };
+	hash = mPlayer->hashState(hash);
+	return mLevel->hashSprites(hash);
+}
+
+// Outputs the simulation tick, player and level sprite state represented as a string
+std::string GameLoop::worldToString() {
+	std::ostringstream str{};
+	str << "GameLoop::Tick: " << mClock.getTicks() << "\n";
+	str << "GameLoop::Player: Position: " << mPlayer->getX() << ", " << mPlayer->getY();
+	str << ", Health: " << mPlayer->getHealth() << "/" << mPlayer->getHealthMax() << ", Action: " << mPlayer->getActionMode() << "\n";
+	str << mLevel->spritesToString();
+	return str.str();
+}
+
+// Runs one fixed simulation tick: every subsystem due on this tick.
+void GameLoop::runTick() {
+	ProfileZone zone{ "GameLoop::runTick" };
+	AllocScope scope{ "Tick" };
+	mSimStats.begin();
+	mFlight.beginTick(mClock.getTicks(), mLevel->isDegraded());
+	Metrics::add(Metric::MT_TICKS);
+
+	// fire timers due this tick first so subsystems see their flags
+	mTimers->advance();
+
+	mScheduler.runTick(mClock.getTicks(), mLevel->isDegraded());
+	mFlight.endTick(mScheduler, mLevel->getVisibleSprites());
+
+	// once warmed up nothing on the simulation side should allocate between one tick and the next
+	AllocTracker::check("GameLoop::runTick", mClock.getTicks(), mClock.getTicks() >= FuGlobals::ALLOC_WARMUP_TICKS);
+
+	// consume one tick of lag and advance the simulation tick count
+	mClock.tick();
+
+	mSimStats.end();
+	if constexpr (FuGlobals::HEATMAP) mHeatmap.addTick(mPlayer->getX(), mPlayer->getY(), mSimStats.getLast());
+}
+
+// Returns the statistics of the time taken by each simulation tick. Render frame times are kept by SDLMan::getFrameStats.
+FrameStats& GameLoop::getSimStats() {
+	return mSimStats;
+}
+
+// Copies the world into the snapshot write buffer and publishes it for rendering.
+void GameLoop::publishSnapshot() {
+	ProfileZone zone{ "GameLoop::publishSnapshot" };
+	AllocScope scope{ "Snapshot" };
 
-		// render to back buffer
-		mLevel->render();
-		mPlayer->render();
+	RenderSnapshot& snap{ mSnapshots.getWriteBuffer() };
+	mLevel->storeSnapshot(snap);
+	snap.tick = mClock.getTicks();
+	snap.publishCounter = SDL_GetPerformanceCounter();
 
-		// flip drawing buffer to display
-		mSDL->refresh();
+	// tag the snapshot with the newest probe input it shows
+	snap.inputTag = 0;
+	if (mLatency) {
+		snap.inputTag = mLatency->getAppliedTag();
+		mLatency->onPublished(snap.inputTag);
 	}
+
+	mSnapshots.publish();
 }
 
-// Handles input events. Returns true on a quit game event.
+// Draws a snapshot and presents it. alpha is how far between the start and end of the snapshot's tick to draw.
+void GameLoop::render(const RenderSnapshot& snap, decimal alpha) {
+	ProfileZone zone{ "GameLoop::render" };
+	AllocScope scope{ "Render" };
+
+	// render to back buffer
+	mLevel->render(snap, alpha);
+
+	// performance overlay on top of the HUD
+	if (mOverlay) mOverlay->render(mSimStats, snap.tick);
+
+	// flip drawing buffer to display
+	mSDL->refresh();
+	if constexpr (FuGlobals::HEATMAP) mHeatmap.addFrame(snap.player.x, snap.player.y, mSDL->getFrameStats().getLast());
+
+	// a frame well over budget dumps the last few seconds of what the engine was doing
+	if (mFlight.endFrame(snap.tick)) {
+		Log::debug("GameLoop::render - Frame hitch. Dumping flight recorder to {}", FuGlobals::FLIGHT_DUMP_FILE);
+		mFlight.dump(FuGlobals::FLIGHT_DUMP_FILE);
+	}
+
+	//***DEBUG***
+	if constexpr (FuGlobals::SHOW_FPS) mSDL->outputFPS();
+
+	// the frame showing the snapshot's probe inputs is now presented
+	if (mLatency) {
+		mLatency->onPresented(snap.inputTag);
+		if (mLatency->isFinished()) mQuit = true;
+	}
+
+	// same for the render side between one frame and the next
+	AllocTracker::check("GameLoop::render at tick", snap.tick, snap.tick >= FuGlobals::ALLOC_WARMUP_TICKS);
+}
+
+// Handles input events. Returns true on a quit game event. Input for the player is routed to the simulation.
 bool GameLoop::handleEvents() {
+	ProfileZone zone{ "GameLoop::handleEvents" };
+	AllocScope scope{ "Events" };
+
     SDL_Event e;
     bool quit{ false };
 
+    // inject the next synthetic input when measuring latency
+    if (mLatency) mLatency->injectIfDue();
+
     // Cycle through all events on the event queue
     while (SDL_PollEvent(&e)) {
 		switch (e.type) {
 			case SDL_QUIT:																				// Handle request to quit
 				quit = true;
 				break;
+			case SDL_WINDOWEVENT:																		// Handle window state changes for idle throttling
+				handleWindowEvent(e.window);
+				break;
+
 			case SDL_CONTROLLERDEVICEADDED:																// Handle a controller being connected
 				mSDL->openGamepad();
 				break;
@@ -143,27 +559,99 @@ bool GameLoop::handleEvents() {
 				mSDL->closeGamepad();
 				break;
 
-			case SDL_CONTROLLERAXISMOTION:																// Handle gamepad analog sticks
-				if (e.jaxis.which == mSDL->getGamepadID()) mPlayer->handleInputAnalogStick(e.caxis);
+			case SDL_CONTROLLERAXISMOTION:																// Handle gamepad analog sticks and buttons
+			case SDL_CONTROLLERBUTTONDOWN:
+			case SDL_CONTROLLERBUTTONUP:
+				if (e.jaxis.which == mSDL->getGamepadID()) routeInput(e);
 				break;
 
-			case SDL_CONTROLLERBUTTONDOWN:																// Handle gamepad buttons
-				if (e.jaxis.which == mSDL->getGamepadID()) mPlayer->handleInputGamepad(e.cbutton, true);
+			case SDL_KEYDOWN:																			// Handle keyboard keys
+			case SDL_KEYUP:
+				// F12 writes out the profiler trace
+				if constexpr (FuGlobals::PROFILE) {
+					if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F12 && !e.key.repeat) {
+						Profiler::dumpTrace(FuGlobals::PROFILE_TRACE_FILE);
+						break;
+					}
+				}
+				// F3 shows and hides the performance overlay
+				if (e.key.keysym.sym == SDLK_F3 && mOverlay) {
+					if (e.type == SDL_KEYDOWN && !e.key.repeat) mOverlay->toggle();
+					break;
+				}
+				routeInput(e);
 				break;
 
-			case SDL_CONTROLLERBUTTONUP:																// Handle gamepad buttons
-				if (e.jaxis.which == mSDL->getGamepadID()) mPlayer->handleInputGamepad(e.cbutton, false);
-				break;
-
-			case SDL_KEYDOWN:																			// Handle keyboard key down
-				mPlayer->handleInputKeyboard(e.key.keysym.sym, true);
-				break;
-
-			case SDL_KEYUP:																				// Handle keyboard key released
-				mPlayer->handleInputKeyboard(e.key.keysym.sym, false);
+			default:
+				// a latency probe press or release, sampled as its key event with the tag carried alongside
+				if (mLatency) {
+					SDL_Event key{};
+					Uint32 tag{ mLatency->onPolled(e, key) };
+					if (tag != 0) routeInput(key, tag);
+				}
 				break;
 		}
     }
 	
     return quit;
+}
+
+// Hands a player input event to the input sampler to be latched by the next tick. tag is the LatencyProbe tag, 0 for real input.
+void GameLoop::routeInput(const SDL_Event& e, Uint32 tag) {
+	mInput.sample(e, tag);
+}
+
+// Latches the input sampled so far and applies it. Called by the simulation immediately before each tick.
+void GameLoop::drainInput() {
+	AllocScope scope{ "Input" };
+	for (const InputSampler::TimedEvent& te : mInput.latch()) dispatchInput(te.event, te.tag);
+}
+
+// Calls the player's input handler matching the event. Also where input is recorded as every input path ends up here.
+// tag is the LatencyProbe tag, 0 for real input.
+void GameLoop::dispatchInput(const SDL_Event& e, Uint32 tag) {
+	if (mRecorder) mRecorder->recordEvent(mClock.getTicks(), e);
+	if (mLatency) mLatency->onApplied(tag);
+	mFlight.recordInput(e);
+
+	switch (e.type) {
+		case SDL_CONTROLLERAXISMOTION:																// Handle gamepad analog sticks
+			mPlayer->handleInputAnalogStick(e.caxis);
+			break;
+
+		case SDL_CONTROLLERBUTTONDOWN:																// Handle gamepad buttons
+			mPlayer->handleInputGamepad(e.cbutton, true);
+			break;
+
+		case SDL_CONTROLLERBUTTONUP:																// Handle gamepad buttons
+			mPlayer->handleInputGamepad(e.cbutton, false);
+			break;
+
+		case SDL_KEYDOWN:																			// Handle keyboard key down
+			mPlayer->handleInputKeyboard(e.key.keysym.sym, true);
+			break;
+
+		case SDL_KEYUP:																				// Handle keyboard key released
+			mPlayer->handleInputKeyboard(e.key.keysym.sym, false);
+			break;
+	}
+}
+
+// Handles window state changes. Tells the frame pacer when the window is minimized or loses focus so the game loop can idle.
+void GameLoop::handleWindowEvent(const SDL_WindowEvent& e) {
+	switch (e.event) {
+		case SDL_WINDOWEVENT_MINIMIZED:
+			mPacer.setMinimized(true);
+			break;
+		case SDL_WINDOWEVENT_RESTORED:
+		case SDL_WINDOWEVENT_MAXIMIZED:
+			mPacer.setMinimized(false);
+			break;
+		case SDL_WINDOWEVENT_FOCUS_LOST:
+			mPacer.setFocused(false);
+			break;
+		case SDL_WINDOWEVENT_FOCUS_GAINED:
+			mPacer.setFocused(true);
+			break;
+	}
 }
\ No newline at end of file
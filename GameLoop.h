@@ -2,29 +2,96 @@
 
 #include "MisterX.h"
 #include "Level.h"
+#include "SimClock.h"
+#include "FramePacer.h"
+#include "Scheduler.h"
+#include "TimerWheel.h"
+#include "Replay.h"
+#include "InputSampler.h"
+#include "LatencyProbe.h"
+#include "FlightRecorder.h"
+#include "PerfOverlay.h"
+#include "PerfHeatmap.h"
+#include "TripleBuffer.h"
+#include "RenderSnapshot.h"
 #include <memory>
+#include <vector>
+#include <atomic>
 
 /* Runs the main game loop. This is the owner of various shared_ptr's including the current level,
  * the player object, SDLMan object, etc. GameLoop doles out weak_ptr's of these objects for other
  * game objects to use so thus acts as a communications hub for game objects to get information on each other.
+ *
+ * The simulation publishes a RenderSnapshot of the world after it ticks and rendering only ever draws
+ * from the latest snapshot. With FuGlobals::THREADED_SIM on, the simulation runs on its own thread and
+ * the main thread keeps SDL to itself: it polls events, queues input for the simulation and renders
+ * snapshots. A slow present then no longer delays simulation ticks.
  */
 class GameLoop {
 
 public:
 	~GameLoop();
 
+	// Set's whethar to run headless: no window, sound device or frame pacing. Must be called before initGameSystems().
+	void setHeadless(bool headless);
+
 	// Initializes the graphics and sound systems.
 	bool initGameSystems();
 
-	// Loads in game data.
-	bool loadGameData();
+	// Uses an SDLMan that is already initialized instead of making one, running headless if it is. Lets many games share one SDL setup, see EnvRunner.
+	bool initGameSystems(std::shared_ptr<SDLMan> sdl);
+
+	// Loads in game data starting on the given level metadata file.
+	bool loadGameData(std::string levelFile = "Data/Level1.dat");
+
+	// Registers the simulation subsystems (physics, AI, animation, audio) with the scheduler at their own rates.
+	void registerSubsystems();
 
 	// Runs the main game loop.
 	void runGameLoop();
 
-	// Handles input events. Returns true on a quit game event.
+	// Runs the given number of simulation ticks back to back as fast as possible with no rendering, feeding the player input from
+	// scriptFile if one is given (see InputScript). Reports ticks per second and the final world state. Returns false if the script fails to load or a steady state tick allocated (see AllocTracker).
+	bool runHeadless(Uint64 ticks, std::string scriptFile);
+
+	// Runs a recorded session headless at full speed by feeding the recorded input in on the ticks it was recorded on.
+	// Reports ticks per second and whethar the final world state hash matches the recording. Returns false if it fails to load, doesn't match or a steady state tick allocated.
+	bool runReplay(std::string replayFile);
+
+	// Records all player input and the final world state hash to the given file. Must be called before the game loop runs. Returns false if the file can't be opened.
+	bool setRecordFile(std::string recordFile);
+
+	// Turns on input to photon latency measurement. The game loop injects the given number of synthetic inputs, quits once they
+	// have all been presented and prints the latency distributions. Must be called before the game loop runs.
+	void setLatencyProbe(int samples);
+
+	// Applies the given player input events then runs one simulation tick. Steps a headless game from outside the game loop, see EnvRunner.
+	void stepTick(const SDL_Event* events, int count);
+
+	// Returns the player sprite.
+	std::weak_ptr<MisterX> getPlayer();
+
+	// Returns the level being played.
+	std::weak_ptr<Level> getLevel();
+
+	// Returns the number of simulation ticks run.
+	Uint64 getTicks();
+
+	// Outputs the simulation tick, player and level sprite state represented as a string
+	std::string worldToString();
+
+	// Returns a hash of the simulation tick, player and level sprite state. Two runs with the same hash ended in the same state.
+	Uint64 hashWorld();
+
+	// Returns the statistics of the time taken by each simulation tick. Render frame times are kept by SDLMan::getFrameStats.
+	FrameStats& getSimStats();
+
+	// Handles input events. Returns true on a quit game event. Input for the player is routed to the simulation.
 	bool handleEvents();
 
+	// Handles window state changes. Tells the frame pacer when the window is minimized or loses focus so the game loop can idle.
+	void handleWindowEvent(const SDL_WindowEvent& e);
+
 	// Load in level data from file passed in by parameter. Filepath relative to executable. Return bool success.
 	bool loadLevel(std::string lvlDataFile);
 
@@ -37,4 +104,83 @@ private:
 
 	// The Sprite for the player. Held here as a shared_ptr and held by Level objects as a weak_ptr.
 	std::shared_ptr<MisterX> mPlayer{ nullptr };
+
+	// Fixed step simulation clock. Hands out the dt all movement and physics integrate with.
+	SimClock mClock{ FuGlobals::SIM_TICK_MS, FuGlobals::FPS_TARGET };
+
+	// Timers counted in simulation ticks for sprite animation and attack timing. Advanced at the start of every tick. Held by sprites as a weak_ptr.
+	std::shared_ptr<TimerWheel> mTimers{ nullptr };
+
+	// Time taken by each simulation tick
+	FrameStats mSimStats{ "Sim tick" };
+
+	// Runs the simulation subsystems each tick at their own rates.
+	Scheduler mScheduler{ FuGlobals::SIM_TICK_MS };
+
+	// Keeps the last few seconds of tick and frame data and dumps it when a frame hitches.
+	FlightRecorder mFlight{ FuGlobals::FPS_TARGET > 0 ? FuGlobals::FPS_TARGET : FuGlobals::SIM_TICK_MS, FuGlobals::HITCH_FACTOR };
+
+	// Waits out the rest of each frame so the loop doesn't busy spin a core, and idles while the window is minimized or unfocused.
+	FramePacer mPacer{ FuGlobals::PACE_MODE };
+
+	// Snapshots of the world handed from the simulation to rendering without locking.
+	TripleBuffer<RenderSnapshot> mSnapshots{};
+
+	// Timestamps player input as it is polled and hands it to the simulation immediately before each tick.
+	InputSampler mInput{};
+
+	// Set when the game should end. Read by both threads.
+	std::atomic<bool> mQuit{ false };
+
+	// Running without a window or sound device
+	bool mHeadless{ false };
+
+	// Records player input when set. Only touched from the simulation side.
+	std::unique_ptr<Replay> mRecorder{ nullptr };
+
+	// Measures input to photon latency when set.
+	std::unique_ptr<LatencyProbe> mLatency{ nullptr };
+
+	// Tick and frame cost by player position in the level.
+	PerfHeatmap mHeatmap{};
+
+	// Performance readout drawn over the HUD. Not made when headless or when its font fails to load.
+	std::unique_ptr<PerfOverlay> mOverlay{ nullptr };
+
+	// Runs simulation and rendering one after the other on the calling thread.
+	void runSingleThreaded();
+
+	// Runs the simulation on a second thread while the calling thread handles events and renders.
+	void runThreaded();
+
+	// Body of the simulation thread.
+	void runSimulationThread();
+
+	// Runs as many fixed simulation ticks as the clock says are due, within the catch up limits, then publishes a snapshot. Returns ticks run.
+	int simulate();
+
+	// Runs one fixed simulation tick: every subsystem due on this tick.
+	void runTick();
+
+	// Copies the world into the snapshot write buffer and publishes it for rendering.
+	void publishSnapshot();
+
+	// Draws the latest published snapshot and presents it. alpha is how far between the start and end of the snapshot's tick to draw.
+	void render(const RenderSnapshot& snap, decimal alpha);
+
+	// Hands a player input event to the input sampler to be latched by the next tick. tag is the LatencyProbe tag, 0 for real input.
+	void routeInput(const SDL_Event& e, Uint32 tag = 0);
+
+	// Latches the input sampled so far and applies it. Called by the simulation immediately before each tick.
+	void drainInput();
+
+	// Calls the player's input handler matching the event. Also where input is recorded as every input path ends up here.
+	// tag is the LatencyProbe tag, 0 for real input.
+	void dispatchInput(const SDL_Event& e, Uint32 tag = 0);
+
+	// Writes the end of the recording, if recording.
+	void finishRecording();
+
+	// Prints ticks per second for a headless run that started at the given performance counter, then the final world state.
+	void reportHeadlessRun(Uint64 ticks, Uint64 startCounter);
 };
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "GlyphAtlas.h"
+#include "FuGlobals.h"
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+
+// Constructor takes the SDLMan whose renderer the atlas texture is made for.
+GlyphAtlas::GlyphAtlas(std::weak_ptr<SDLMan> sdl) {
+	mSDL = sdl;
+}
+
+// Renders the font's glyphs at the given point size into the atlas texture. reserveChars sizes the vertex storage for that many
+// characters queued per flush. Returns false if the font can't be opened or the texture can't be made.
+bool GlyphAtlas::load(std::string fontFile, int ptSize, int reserveChars) {
+	TTF_Font* font{ TTF_OpenFont(fontFile.c_str(), ptSize) };
+	if (!font) {
+		std::cerr << "Failed in GlyphAtlas::load trying to open font \"" << fontFile << "\". SDL_ttf Error: " << TTF_GetError() << std::endl;
+		return false;
+	}
+
+	// every glyph gets a cell as wide as the widest advance and as tall as a line
+	constexpr int count{ LAST_CHAR - FIRST_CHAR + 1 };
+	mLineHeight = TTF_FontHeight(font);
+	int cellW{ 1 };
+	for (int i{ 0 }; i < count; ++i) {
+		int minX{}, maxX{}, minY{}, maxY{}, advance{};
+		if (TTF_GlyphMetrics(font, static_cast<Uint16>(FIRST_CHAR + i), &minX, &maxX, &minY, &maxY, &advance) == 0) mAdvance[i] = advance;
+		cellW = std::max(cellW, std::max(advance, maxX));
+	}
+
+	int rows{ (count + COLUMNS - 1) / COLUMNS };
+	SDL_Surface* atlas{ SDL_CreateRGBSurfaceWithFormat(0, cellW * COLUMNS, mLineHeight * rows, 32, SDL_PIXELFORMAT_RGBA32) };
+	if (!atlas) {
+		std::cerr << "Failed in GlyphAtlas::load trying to create the atlas surface. SDL Error: " << SDL_GetError() << std::endl;
+		TTF_CloseFont(font);
+		return false;
+	}
+
+	// render each glyph white and copy it into its cell as is rather than blending onto the empty atlas
+	SDL_Color white{ 255, 255, 255, 255 };
+	for (int i{ 0 }; i < count; ++i) {
+		SDL_Rect cell{ (i % COLUMNS) * cellW, (i / COLUMNS) * mLineHeight, cellW, mLineHeight };
+		mGlyphs[i] = SDL_Rect{ cell.x, cell.y, 0, mLineHeight };
+
+		SDL_Surface* glyph{ TTF_RenderGlyph_Blended(font, static_cast<Uint16>(FIRST_CHAR + i), white) };
+		if (!glyph) continue;
+
+		SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(glyph, nullptr, atlas, &cell);
+		mGlyphs[i].w = std::min(glyph->w, cellW);
+		SDL_FreeSurface(glyph);
+	}
+	TTF_CloseFont(font);
+
+	SDL_Texture* texture{ SDL_CreateTextureFromSurface(mSDL.lock()->getRenderer(), atlas) };
+	SDL_FreeSurface(atlas);
+	if (!texture) {
+		std::cerr << "Failed in GlyphAtlas::load trying to create the atlas texture. SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	mTexture = std::make_unique<Texture>(texture);
+
+	// a quad, four vertices and six indices a character
+	mQuads.reserve(static_cast<std::size_t>(reserveChars));
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	mVertices.reserve(static_cast<std::size_t>(reserveChars) * 4);
+	mIndices.reserve(static_cast<std::size_t>(reserveChars) * 6);
+#endif
+
+	return true;
+}
+
+// Queues a string to draw with its top left at x, y in the given colour. Drawn on the next flush().
+void GlyphAtlas::queueText(int x, int y, const char* text, SDL_Color color) {
+	if (!mTexture) return;
+
+	int penX{ x };
+	for (const char* c{ text }; *c != '\0'; ++c) {
+		int i{ getIndex(*c) };
+		const SDL_Rect& g{ mGlyphs[i] };
+
+		// spaces and missing glyphs only move the pen
+		if (g.w > 0) mQuads.push_back(Quad{ g, SDL_Rect{ penX, y, g.w, g.h }, color });
+
+		penX += mAdvance[i];
+	}
+}
+
+// Draws everything queued since the last flush in one call and clears the queue.
+void GlyphAtlas::flush() {
+	if (mTexture && !mQuads.empty()) {
+		SDL_Renderer* renderer{ mSDL.lock()->getRenderer() };
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		// two triangles a quad, all drawn in one call
+		float texW{ static_cast<float>(mTexture->getSize().x) };
+		float texH{ static_cast<float>(mTexture->getSize().y) };
+		for (const Quad& q : mQuads) {
+			float left{ static_cast<float>(q.dst.x) }, right{ static_cast<float>(q.dst.x + q.dst.w) };
+			float top{ static_cast<float>(q.dst.y) }, bottom{ static_cast<float>(q.dst.y + q.dst.h) };
+			float u0{ q.src.x / texW }, u1{ (q.src.x + q.src.w) / texW };
+			float v0{ q.src.y / texH }, v1{ (q.src.y + q.src.h) / texH };
+
+			int first{ static_cast<int>(mVertices.size()) };
+			mVertices.push_back(SDL_Vertex{ SDL_FPoint{ left, top }, q.color, SDL_FPoint{ u0, v0 } });
+			mVertices.push_back(SDL_Vertex{ SDL_FPoint{ right, top }, q.color, SDL_FPoint{ u1, v0 } });
+			mVertices.push_back(SDL_Vertex{ SDL_FPoint{ right, bottom }, q.color, SDL_FPoint{ u1, v1 } });
+			mVertices.push_back(SDL_Vertex{ SDL_FPoint{ left, bottom }, q.color, SDL_FPoint{ u0, v1 } });
+
+			for (int offset : { 0, 1, 2, 0, 2, 3 }) mIndices.push_back(first + offset);
+		}
+
+		SDL_RenderGeometry(renderer, mTexture->getTexture(),
+			mVertices.data(), static_cast<int>(mVertices.size()),
+			mIndices.data(), static_cast<int>(mIndices.size()));
+		mVertices.clear();
+		mIndices.clear();
+#else
+		// a copy per glyph, only changing the tint when the colour does
+		SDL_Texture* texture{ mTexture->getTexture() };
+		SDL_Color tint{ 255, 255, 255, 255 };
+		SDL_SetTextureColorMod(texture, tint.r, tint.g, tint.b);
+		SDL_SetTextureAlphaMod(texture, tint.a);
+		for (const Quad& q : mQuads) {
+			if (q.color.r != tint.r || q.color.g != tint.g || q.color.b != tint.b || q.color.a != tint.a) {
+				tint = q.color;
+				SDL_SetTextureColorMod(texture, tint.r, tint.g, tint.b);
+				SDL_SetTextureAlphaMod(texture, tint.a);
+			}
+			SDL_RenderCopy(renderer, texture, &q.src, &q.dst);
+		}
+#endif
+	}
+
+	mQuads.clear();
+}
+
+// Returns the pixel height of a line of text.
+int GlyphAtlas::getLineHeight() {
+	return mLineHeight;
+}
+
+// Returns the pixel width the given string would draw at.
+int GlyphAtlas::getTextWidth(const char* text) {
+	int width{ 0 };
+	for (const char* c{ text }; *c != '\0'; ++c) width += mAdvance[getIndex(*c)];
+	return width;
+}
+
+// Outputs the object information represented as a string
+std::string GlyphAtlas::toString() {
+	std::ostringstream str{};
+	str << "GlyphAtlas::Glyphs: " << (LAST_CHAR - FIRST_CHAR + 1) << ", Line height: " << mLineHeight;
+	if (mTexture) str << ", Texture: " << mTexture->getSize().x << "x" << mTexture->getSize().y;
+	str << "\n";
+	return str.str();
+}
+
+// Returns the atlas index of a character, using '?' for anything outside the atlas.
+int GlyphAtlas::getIndex(char c) {
+	if (c < FIRST_CHAR || c > LAST_CHAR) c = '?';
+	return c - FIRST_CHAR;
+}
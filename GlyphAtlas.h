@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SDLMan.h"
+#include "Texture.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+/* GlyphAtlas - Cached bitmap text drawn from one texture
+ *
+ * load() renders every printable ASCII glyph of a TTF font with SDL_ttf once, packs them into a grid on
+ * a single texture and remembers each glyph's rectangle and advance. After that drawing text never touches
+ * SDL_ttf: queueText() appends a quad per character and flush() draws them all with one SDL_RenderGeometry
+ * call. Glyphs are rendered white so each string can be tinted with vertex colours.
+ *
+ * SDL_RenderGeometry needs SDL 2.0.18 or newer. Built against older SDL, like the SDL2.dll shipped with the
+ * game, flush() falls back to an SDL_RenderCopy per glyph tinted with the texture colour mod instead.
+ *
+ * Quad and vertex storage is reserved at load and reused every frame so steady state drawing doesn't allocate.
+ */
+class GlyphAtlas {
+
+public:
+	static constexpr char	FIRST_CHAR	{ 32 };		// First glyph in the atlas (space)
+	static constexpr char	LAST_CHAR	{ 126 };	// Last glyph in the atlas (~). Anything outside the range draws as '?'.
+	static constexpr int	COLUMNS		{ 16 };		// Glyphs per row of the atlas texture
+
+	// Constructor takes the SDLMan whose renderer the atlas texture is made for.
+	GlyphAtlas(std::weak_ptr<SDLMan> sdl);
+	GlyphAtlas() = delete;
+
+	// Renders the font's glyphs at the given point size into the atlas texture. reserveChars sizes the vertex storage for that many
+	// characters queued per flush. Returns false if the font can't be opened or the texture can't be made.
+	bool load(std::string fontFile, int ptSize, int reserveChars);
+
+	// Queues a string to draw with its top left at x, y in the given colour. Drawn on the next flush().
+	void queueText(int x, int y, const char* text, SDL_Color color);
+
+	// Draws everything queued since the last flush in one call and clears the queue.
+	void flush();
+
+	// Returns the pixel height of a line of text.
+	int getLineHeight();
+
+	// Returns the pixel width the given string would draw at.
+	int getTextWidth(const char* text);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// SDLMan whose renderer we draw with
+	std::weak_ptr<SDLMan> mSDL{};
+
+	// The atlas texture
+	std::unique_ptr<Texture> mTexture{ nullptr };
+
+	// Each glyph's rectangle in the atlas and horizontal advance, indexed by character - FIRST_CHAR
+	SDL_Rect mGlyphs[LAST_CHAR - FIRST_CHAR + 1]{};
+	int mAdvance[LAST_CHAR - FIRST_CHAR + 1]{};
+
+	// Height of a line of text
+	int mLineHeight{ 0 };
+
+	// One glyph queued to draw: where it is in the atlas, where it goes on screen and its colour
+	struct Quad {
+		SDL_Rect src{};
+		SDL_Rect dst{};
+		SDL_Color color{};
+	};
+
+	// Quads queued since the last flush
+	std::vector<Quad> mQuads{};
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	// Vertices and indices flush() builds from the quads for SDL_RenderGeometry
+	std::vector<SDL_Vertex> mVertices{};
+	std::vector<int> mIndices{};
+#endif
+
+	// Returns the atlas index of a character, using '?' for anything outside the atlas.
+	static int getIndex(char c);
+};
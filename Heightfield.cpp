@@ -0,0 +1,99 @@
+#include "Heightfield.h"
+#include <algorithm>
+#include <sstream>
+
+// Builds the table from the given rectangles. Replaces anything built before.
+void Heightfield::build(const std::vector<SDL_Rect>& rects) {
+	mColSpan.clear();
+	mIntervals.clear();
+	mSpanStart.assign(1, 0);
+	mMinX = 0;
+	mMaxX = -1;
+
+	// every left and right edge starts a new span. Span k covers columns edges[k] to edges[k + 1] - 1.
+	std::vector<int> edges{};
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;	// empty rectangles can't collide with anything
+		edges.push_back(r.x);
+		edges.push_back(r.x + r.w);
+	}
+	if (edges.empty()) return;
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	mMinX = edges.front();
+	mMaxX = edges.back() - 1;
+	int spans{ static_cast<int>(edges.size()) - 1 };
+
+	// returns the span a rectangle edge starts
+	auto spanAt{ [&edges](int x) { return static_cast<int>(std::lower_bound(edges.begin(), edges.end(), x) - edges.begin()); } };
+
+	// count each span's rectangles, then copy their rows in
+	std::vector<int> start(static_cast<std::size_t>(spans) + 1, 0);
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;
+		for (int k{ spanAt(r.x) }, end{ spanAt(r.x + r.w) }; k < end; ++k) ++start[k + 1];
+	}
+	for (int k{ 0 }; k < spans; ++k) start[k + 1] += start[k];
+
+	std::vector<Interval> rows(start[spans]);
+	std::vector<int> next{ start.begin(), start.end() - 1 };
+	for (const SDL_Rect& r : rects) {
+		if (r.w <= 0 || r.h <= 0) continue;
+		for (int k{ spanAt(r.x) }, end{ spanAt(r.x + r.w) }; k < end; ++k) rows[next[k]++] = { r.y, r.y + r.h - 1 };
+	}
+
+	// sort each span's rows and merge any that overlap or touch
+	mIntervals.reserve(rows.size());
+	mSpanStart.reserve(static_cast<std::size_t>(spans) + 1);
+	for (int k{ 0 }; k < spans; ++k) {
+		std::sort(rows.begin() + start[k], rows.begin() + start[k + 1], [](const Interval& a, const Interval& b) { return a.top < b.top; });
+		std::size_t first{ mIntervals.size() };
+		for (int i{ start[k] }; i < start[k + 1]; ++i) {
+			if (mIntervals.size() > first && rows[i].top <= mIntervals.back().bottom + 1) {
+				mIntervals.back().bottom = std::max(mIntervals.back().bottom, rows[i].bottom);
+			} else {
+				mIntervals.push_back(rows[i]);
+			}
+		}
+		mSpanStart.push_back(static_cast<int>(mIntervals.size()));
+	}
+
+	// point every column at its span
+	mColSpan.resize(static_cast<std::size_t>(mMaxX) - mMinX + 1);
+	for (int k{ 0 }; k < spans; ++k) {
+		std::fill(mColSpan.begin() + (edges[k] - mMinX), mColSpan.begin() + (edges[k + 1] - mMinX), k);
+	}
+}
+
+// Returns true if any rectangle covers row y anywhere from column x1 to x2 inclusive, in either order. tested is set to the number of intervals compared.
+bool Heightfield::hasSpan(int x1, int x2, int y, int& tested) {
+	tested = 0;
+
+	// nothing solid beyond the outermost rectangle edges
+	int left{ std::max(std::min(x1, x2), mMinX) };
+	int right{ std::min(std::max(x1, x2), mMaxX) };
+	if (left > right) return false;
+
+	int lastSpan{ mColSpan[right - mMinX] };
+	for (int k{ mColSpan[left - mMinX] }; k <= lastSpan; ++k) {
+		for (int i{ mSpanStart[k] }; i < mSpanStart[k + 1]; ++i) {
+			const Interval& iv{ mIntervals[i] };
+			++tested;
+			if (iv.top > y) break;	// sorted by top so nothing further down reaches y
+			if (y <= iv.bottom) return true;
+		}
+	}
+
+	return false;
+}
+
+// Outputs the object information represented as a string
+std::string Heightfield::toString() {
+	int spans{ static_cast<int>(mSpanStart.size()) - 1 };
+	int most{ 0 };
+	for (int k{ 0 }; k < spans; ++k) most = std::max(most, mSpanStart[k + 1] - mSpanStart[k]);
+
+	std::ostringstream str{};
+	str << "Heightfield::Columns: " << mMinX << " to " << mMaxX << ", Spans: " << spans << ", Intervals: " << mIntervals.size() << ", Most in a span: " << most << "\n";
+	return str.str();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/* Heightfield - Per column table of the solid heights in a level for horizontal collision queries
+ *
+ * The most common collision query is "am I standing?", a short horizontal line under a sprite's feet,
+ * with its ceiling twin over its head. Built once when a level loads, this splits the level's width at
+ * every collision rectangle's left and right edge into spans of columns that all have the same
+ * rectangles over them and keeps, for each span, the rows those rectangles fill as a short sorted list
+ * of merged top to bottom intervals. A lookup table takes any column straight to its span.
+ *
+ * A horizontal line query is then a table lookup for each end, a walk over the few spans between them
+ * (usually one, a sprite's feet are only a few pixels wide) and a compare against each span's intervals.
+ * Matches SDL_IntersectRectAndLine exactly for horizontal lines. Walls are vertical lines and still go
+ * through CollisionGrid.
+ */
+class Heightfield {
+
+public:
+	// Builds the table from the given rectangles. Replaces anything built before.
+	void build(const std::vector<SDL_Rect>& rects);
+
+	// Returns true if any rectangle covers row y anywhere from column x1 to x2 inclusive, in either order. tested is set to the number of intervals compared.
+	bool hasSpan(int x1, int x2, int y, int& tested);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Rows filled in a span, top to bottom inclusive
+	struct Interval {
+		int top{ 0 };
+		int bottom{ 0 };
+	};
+
+	// First and last column any rectangle covers
+	int mMinX{ 0 };
+	int mMaxX{ -1 };
+
+	// Span holding each column from mMinX to mMaxX
+	std::vector<int> mColSpan{};
+
+	// Intervals of each span sorted by top. Span i's run from mSpanStart[i] to mSpanStart[i + 1].
+	std::vector<Interval> mIntervals{};
+	std::vector<int> mSpanStart{};
+};
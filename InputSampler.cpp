@@ -0,0 +1,46 @@
+#include "InputSampler.h"
+#include <sstream>
+
+InputSampler::InputSampler() {
+	mCountsPerMS = static_cast<decimal>(SDL_GetPerformanceFrequency()) / 1000;
+}
+
+// Stamps an input event with the current time and queues it for the next latch along with its LatencyProbe tag, 0 for real input.
+// Drops keyboard auto-repeats. Safe to call from any thread.
+void InputSampler::sample(const SDL_Event& e, Uint32 tag) {
+	if (e.type == SDL_KEYDOWN && e.key.repeat != 0) return;
+
+	TimedEvent te{ SDL_GetPerformanceCounter(), e, tag };
+	std::lock_guard<std::mutex> lock{ mMutex };
+	mQueue.push_back(te);
+}
+
+// Takes every event sampled so far. Call from the simulation immediately before the tick.
+// The returned events, in arrival order, stay valid until the next latch.
+const std::vector<InputSampler::TimedEvent>& InputSampler::latch() {
+	// swap the queue out under the lock so sampling is never held up while the player handles input
+	mLatched.clear();
+	{
+		std::lock_guard<std::mutex> lock{ mMutex };
+		mLatched.swap(mQueue);
+	}
+	Uint64 now{ SDL_GetPerformanceCounter() };
+
+	for (const TimedEvent& te : mLatched) {
+		decimal latency{ (now - te.counter) / mCountsPerMS };
+		if (latency > mMaxLatencyMS) mMaxLatencyMS = latency;
+		mTotalLatencyMS += latency;
+	}
+	mLatchedEvents += mLatched.size();
+
+	return mLatched;
+}
+
+// Outputs the object information represented as a string
+std::string InputSampler::toString() {
+	std::ostringstream str{};
+	str << "InputSampler::Events latched: " << mLatchedEvents;
+	str << ", Mean sample to latch: " << (mLatchedEvents > 0 ? mTotalLatencyMS / mLatchedEvents : 0) << "ms";
+	str << ", Max: " << mMaxLatencyMS << "ms\n";
+	return str.str();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <vector>
+#include <mutex>
+#include <string>
+
+/* InputSampler - Timestamped player input latched just before each simulation tick
+ *
+ * sample() is called wherever SDL events are pumped (the main thread) and stamps each event with the
+ * high resolution performance counter as it arrives. latch() is called by the simulation immediately
+ * before each tick and takes everything sampled so far, so input is picked up as late as possible rather
+ * than whenever the loop last happened to poll. The time from sample to latch is tracked so input
+ * latency can be watched.
+ *
+ * Keyboard auto-repeat events are dropped when sampled so holding a key can't re-trigger one shot
+ * actions like jumping.
+ */
+class InputSampler {
+
+public:
+	// An input event, the performance counter when it was sampled, and its LatencyProbe tag (0 for real input)
+	struct TimedEvent {
+		Uint64 counter{};
+		SDL_Event event{};
+		Uint32 tag{};
+	};
+
+	InputSampler();
+
+	// Stamps an input event with the current time and queues it for the next latch along with its LatencyProbe tag, 0 for real input.
+	// Drops keyboard auto-repeats. Safe to call from any thread.
+	void sample(const SDL_Event& e, Uint32 tag = 0);
+
+	// Takes every event sampled so far. Call from the simulation immediately before the tick.
+	// The returned events, in arrival order, stay valid until the next latch.
+	const std::vector<TimedEvent>& latch();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Events sampled since the last latch
+	std::vector<TimedEvent> mQueue{};
+
+	// Events taken by the last latch. Kept as a member so its storage is reused.
+	std::vector<TimedEvent> mLatched{};
+
+	// Guards mQueue between the sampling and simulation threads.
+	std::mutex mMutex{};
+
+	// Performance counter ticks per millisecond
+	decimal mCountsPerMS{};
+
+	// Sample to latch latency totals
+	Uint64 mLatchedEvents{ 0 };
+	decimal mTotalLatencyMS{ 0 };
+	decimal mMaxLatencyMS{ 0 };
+};
@@ -0,0 +1,88 @@
+#include "InputScript.h"
+#include "FensoxUtils.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+// Constructor takes the path to the script file. Call load() before use.
+InputScript::InputScript(std::string filename) {
+	mFilename = filename;
+}
+
+// Loads and parses the script file. Returns false and logs the line on a parse error.
+bool InputScript::load() {
+	std::ifstream file{ mFilename };
+	if (!file) {
+		std::cerr << "Failed in InputScript::load. Could not open input script: " << mFilename << std::endl;
+		return false;
+	}
+
+	mEvents.clear();
+	mNext = 0;
+
+	std::string line{};
+	int lineNum{ 0 };
+	while (std::getline(file, line)) {
+		++lineNum;
+
+		// strip comments and skip blank lines
+		size_t comment{ line.find('#') };
+		if (comment != std::string::npos) line.erase(comment);
+		FensoxUtils::strTrim(line);
+		if (line.empty()) continue;
+
+		// tick first, key state last and the key name between as names like "Left Shift" contain spaces
+		std::istringstream in{ line };
+		Uint64 tick{};
+		if (!(in >> tick)) {
+			std::cerr << "Failed in InputScript::load. Bad tick on line " << lineNum << " of " << mFilename << std::endl;
+			return false;
+		}
+
+		size_t stateAt{ line.find_last_of(" \t") };
+		std::string state{ line.substr(stateAt + 1) };
+		std::string keyName{ line.substr(0, stateAt) };
+		keyName.erase(0, keyName.find_first_of(" \t"));
+		FensoxUtils::strTrim(keyName);
+
+		SDL_Keycode key{ SDL_GetKeyFromName(keyName.c_str()) };
+		if (key == SDLK_UNKNOWN || (state != "down" && state != "up")) {
+			std::cerr << "Failed in InputScript::load. Bad key or state on line " << lineNum << " of " << mFilename << std::endl;
+			return false;
+		}
+
+		ScriptEvent se{};
+		se.tick = tick;
+		se.event.type = (state == "down") ? SDL_KEYDOWN : SDL_KEYUP;
+		se.event.key.state = (state == "down") ? SDL_PRESSED : SDL_RELEASED;
+		se.event.key.keysym.sym = key;
+		mEvents.push_back(se);
+	}
+
+	// keep file order for events on the same tick
+	std::stable_sort(mEvents.begin(), mEvents.end(), [](const ScriptEvent& a, const ScriptEvent& b) { return a.tick < b.tick; });
+
+	return true;
+}
+
+// Fills e with the next scripted event due on or before the given tick and returns true. Returns false when nothing more is due yet.
+bool InputScript::pollEvent(Uint64 tick, SDL_Event& e) {
+	if (mNext >= mEvents.size() || mEvents[mNext].tick > tick) return false;
+
+	e = mEvents[mNext].event;
+	++mNext;
+	return true;
+}
+
+// Returns true once every scripted event has been handed out.
+bool InputScript::isFinished() {
+	return mNext >= mEvents.size();
+}
+
+// Outputs the object information represented as a string
+std::string InputScript::toString() {
+	std::ostringstream str{};
+	str << "InputScript::File: " << mFilename << ", Events: " << mEvents.size() << ", Next: " << mNext << "\n";
+	return str.str();
+}
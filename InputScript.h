@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/* InputScript - Scripted player input for headless runs
+ *
+ * Loads a text file of keyboard events, each stamped with the simulation tick it happens on, and
+ * hands them back as SDL_Events when that tick comes around. Lets a headless run drive the player
+ * the same way every time without a keyboard.
+ *
+ * File format is one event per line, blank lines and anything after a # are ignored:
+ *     <tick> <SDL key name> <down|up>
+ * For example "120 Right down" holds the right arrow from tick 120 and "300 Right up" lets it go.
+ * Key names are those SDL_GetKeyFromName understands. Lines don't need to be in tick order.
+ */
+class InputScript {
+
+public:
+	// Constructor takes the path to the script file. Call load() before use.
+	InputScript(std::string filename);
+	InputScript() = delete;
+
+	// Loads and parses the script file. Returns false and logs the line on a parse error.
+	bool load();
+
+	// Fills e with the next scripted event due on or before the given tick and returns true. Returns false when nothing more is due yet.
+	bool pollEvent(Uint64 tick, SDL_Event& e);
+
+	// Returns true once every scripted event has been handed out.
+	bool isFinished();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// One scripted event and the tick it happens on
+	struct ScriptEvent {
+		Uint64 tick{};
+		SDL_Event event{};
+	};
+
+	// Path to the script file
+	std::string mFilename{};
+
+	// Scripted events sorted by tick
+	std::vector<ScriptEvent> mEvents{};
+
+	// Index of the next event to hand out
+	size_t mNext{ 0 };
+};
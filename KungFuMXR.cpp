@@ -1,6 +1,13 @@
 #include <memory>
 #include <iostream>
+#include <string>
 #include "GameLoop.h"
+#include "Log.h"
+#include "LevelGenerator.h"
+#include "EnvRunner.h"
+#include "FensoxUtils.h"
+#include "Metrics.h"
+#include <vector>
 
 /*
  * Entrypoint of the game.
@@ -8,13 +15,135 @@
  * A few things to note for converting to different systems. In he Globals.h file is a typedef for
  * floating point numbers. It is using double by default and can be changed in this one spot for a
  * global change in type.
+ *
+ * Run with "--headless <ticks> [input script]" to step the simulation that many ticks as fast as possible
+ * without a window or sound device, then print ticks per second and the final world state. The optional
+ * input script drives the player, see InputScript.h for its format.
+ *
+ * "--record <file>" records all player input and the final world state to a replay file. "--replay <file>"
+ * plays one back headless at full speed and checks it ends in the same state, exiting with 1 if it doesn't.
+ *
+ * "--latency <samples>" injects that many synthetic key presses, follows each to the frame that shows it
+ * and prints input to photon latency percentiles before quitting.
+ *
+ * "--generate-level <name> <rects> <sprites> [uniform|clustered|platforms] [immediate|spread|waves] [seed]"
+ * writes a synthetic stress level to <name>.dat and <name>.png and quits. See LevelGenerator.h.
+ *
+ * "--env <instances> <steps> [level file]" steps that many headless games in parallel with random actions,
+ * resetting each as it finishes, then prints ticks per second overall and per thread. See EnvRunner.h.
  * 
 */
 int main(int argc, char* argv[]) {
 	bool success = true;
 
+	// Start the log writer before anything logs
+	Log::start();
+
+	// Start exporting engine metrics if turned on. Once for the whole process, as many games may run in it at once (see EnvRunner).
+	if constexpr (FuGlobals::METRICS) Metrics::start(FuGlobals::METRICS_SINK);
+
+	// Write a stress level and quit if asked
+	if (argc >= 5 && std::string(argv[1]) == "--generate-level") {
+		LevelGenerator::Options options{};
+		if (!FensoxUtils::strToNum(argv[3], options.rects) || !FensoxUtils::strToNum(argv[4], options.sprites)) success = false;
+		if (argc > 5 && !LevelGenerator::parseRectLayout(argv[5], options.rectLayout)) success = false;
+		if (argc > 6 && !LevelGenerator::parseSpawnLayout(argv[6], options.spawnLayout)) success = false;
+		if (argc > 7 && !FensoxUtils::strToNum(argv[7], options.seed)) success = false;
+		if (options.rects < 0 || options.sprites < 0) success = false;
+
+		if (!success) {
+			std::cerr << "Failed in main. Usage: --generate-level <name> <rects> <sprites> [uniform|clustered|platforms] [immediate|spread|waves] [seed]" << std::endl;
+		} else {
+			LevelGenerator generator{ options };
+			success = generator.generate(argv[2]);
+			std::cout << "Generated level " << argv[2] << ": " << generator.toString() << std::endl;
+		}
+
+		if constexpr (FuGlobals::METRICS) Metrics::stop();
+		Log::stop();
+		return success ? 0 : 1;
+	}
+
+	// Measure parallel environment throughput and quit if asked
+	if (argc >= 4 && std::string(argv[1]) == "--env") {
+		EnvRunner::Options options{};
+		options.maxTicks = 60 * 1000 / FuGlobals::SIM_TICK_MS;
+		if (argc > 4) options.levelFile = argv[4];
+		Uint64 steps{ 0 };
+		if (!FensoxUtils::strToNum(argv[2], options.instances) || !FensoxUtils::strToNum(argv[3], steps)) {
+			std::cerr << "Failed in main. Usage: --env <instances> <steps> [level file]" << std::endl;
+			if constexpr (FuGlobals::METRICS) Metrics::stop();
+			Log::stop();
+			return 1;
+		}
+
+		EnvRunner env{ options };
+		success = env.init();
+		if (success) {
+			std::vector<Uint8> actions(env.getCount(), 0);
+			Uint64 start{ SDL_GetPerformanceCounter() };
+			for (Uint64 s{ 0 }; s < steps; ++s) {
+				// change held buttons now and then like a player would
+				for (Uint8& a : actions) {
+					if (FensoxUtils::getRandInt(0, 15) == 0) a = static_cast<Uint8>(FensoxUtils::getRandInt(0, (1 << EnvRunner::ACT_BUTTONS) - 1));
+				}
+				env.step(actions.data());
+				for (int i{ 0 }; i < env.getCount(); ++i) {
+					if (env.getDone()[i] && !env.reset(i)) success = false;
+				}
+			}
+
+			decimal seconds{ static_cast<decimal>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency() };
+			decimal tps{ seconds > 0 ? env.getTotalTicks() / seconds : 0 };
+			std::cout << env.toString();
+			std::cout << "EnvRunner::" << env.getTotalTicks() << " ticks in " << seconds << " seconds, " << tps << " ticks/sec, ";
+			std::cout << tps / (env.getWorkerCount() + 1) << " ticks/sec per thread" << std::endl;
+		}
+
+		if constexpr (FuGlobals::METRICS) Metrics::stop();
+		Log::stop();
+		return success ? 0 : 1;
+	}
+
+	// Check for headless, record and replay runs
+	bool headless{ false };
+	Uint64 headlessTicks{ 0 };
+	std::string inputScript{};
+	std::string recordFile{};
+	std::string replayFile{};
+	int latencySamples{ 0 };
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (arg == "--headless" && i + 1 < argc) {
+			headless = true;
+			if (!FensoxUtils::strToNum(argv[++i], headlessTicks)) {
+				success = false;
+				std::cerr << "Failed in main. Usage: --headless <ticks> [input script]" << std::endl;
+			}
+			if (i + 1 < argc && std::string(argv[i + 1]).find("--") != 0) inputScript = argv[++i];
+		} else if (arg == "--record" && i + 1 < argc) {
+			recordFile = argv[++i];
+		} else if (arg == "--replay" && i + 1 < argc) {
+			headless = true;
+			replayFile = argv[++i];
+		} else if (arg == "--latency" && i + 1 < argc) {
+			if (!FensoxUtils::strToNum(argv[++i], latencySamples)) {
+				success = false;
+				std::cerr << "Failed in main. Usage: --latency <samples>" << std::endl;
+			}
+		}
+	}
+
+	// Don't start a game on bad options
+	if (!success) {
+		if constexpr (FuGlobals::METRICS) Metrics::stop();
+		Log::stop();
+		return 1;
+	}
+
 	// Create a main game object.
 	std::unique_ptr<GameLoop> game{ std::make_unique<GameLoop>() };
+	game->setHeadless(headless);
 
 	// Call our function to initialize our graphics and sound systems
 	if (!game->initGameSystems()) {
@@ -28,8 +157,30 @@ int main(int argc, char* argv[]) {
 		std::cerr << "Failed in main. GameLoop::loadGameData returned false." << std::endl;
 	}
 
+	// Start recording before anything has a chance to happen
+	if (success && !recordFile.empty() && !game->setRecordFile(recordFile)) {
+		success = false;
+		std::cerr << "Failed in main. GameLoop::setRecordFile returned false." << std::endl;
+	}
+
+	// Measure input latency if asked
+	if (latencySamples > 0) game->setLatencyProbe(latencySamples);
+
 	// Start the game
-	if (success) game->runGameLoop();
+	if (success) {
+		if (!replayFile.empty()) {
+			if (!game->runReplay(replayFile)) success = false;
+		} else if (headless) {
+			if (!game->runHeadless(headlessTicks, inputScript)) success = false;
+		} else {
+			game->runGameLoop();
+		}
+	}
+
+	// Close the game down while the log is still running so its destructors' messages get written
+	game.reset();
+	if constexpr (FuGlobals::METRICS) Metrics::stop();
+	Log::stop();
 
-	return 0;
+	return success ? 0 : 1;
 }
\ No newline at end of file
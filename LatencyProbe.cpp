@@ -0,0 +1,126 @@
+#include "LatencyProbe.h"
+#include "FensoxUtils.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+// Constructor takes the number of samples to collect.
+LatencyProbe::LatencyProbe(int samples) {
+	mSamples.resize(samples > 0 ? samples : 1);
+	mCountsPerMS = static_cast<decimal>(SDL_GetPerformanceFrequency()) / 1000;
+
+	// our own event type so tags don't have to be squeezed into a key event
+	mEventType = SDL_RegisterEvents(1);
+	if (mEventType == static_cast<Uint32>(-1)) std::cerr << "Failed in LatencyProbe::LatencyProbe. SDL_RegisterEvents found no free event types. No events will be injected." << std::endl;
+}
+
+// Pushes the next synthetic key event onto SDL's event queue if it is time to. Main thread.
+void LatencyProbe::injectIfDue() {
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	if (mEventType == static_cast<Uint32>(-1) || mInjected >= mSamples.size() || now < mNextInject) return;
+
+	// only one event in flight at a time so stages can't be confused between samples
+	if (mInjected > 0 && mPresented < mInjected) return;
+
+	// presses and releases alternate starting with a press, so odd tags are presses
+	SDL_Event e{};
+	e.type = mEventType;
+	e.user.code = static_cast<Sint32>(mInjected + 1);
+	if (SDL_PushEvent(&e) != 1) return;
+
+	++mInjected;
+	mNextInject = now + static_cast<Uint64>(FensoxUtils::getRandInt(MIN_GAP_MS, MAX_GAP_MS) * mCountsPerMS);
+}
+
+// Stamps a probe event being taken off the SDL queue and fills key with the key event it stands for. Returns its tag,
+// or 0 if it wasn't one of ours. Main thread.
+Uint32 LatencyProbe::onPolled(const SDL_Event& e, SDL_Event& key) {
+	if (e.type != mEventType) return 0;
+
+	Uint32 tag{ static_cast<Uint32>(e.user.code) };
+	if (tag == 0 || tag > mSamples.size()) return 0;
+
+	mSamples[tag - 1].polled = SDL_GetPerformanceCounter();
+
+	bool down{ tag % 2 == 1 };
+	key = SDL_Event{};
+	key.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+	key.key.timestamp = e.user.timestamp;
+	key.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+	key.key.keysym.sym = PROBE_KEY;
+	return tag;
+}
+
+// Stamps the event with the given tag being applied to the player. 0 is untagged and ignored. Simulation side.
+void LatencyProbe::onApplied(Uint32 tag) {
+	if (tag == 0 || tag > mSamples.size()) return;
+
+	mSamples[tag - 1].applied = SDL_GetPerformanceCounter();
+	mApplied.store(tag, std::memory_order_release);
+}
+
+// Returns the newest tag applied so far for the snapshot to carry. Simulation side.
+Uint32 LatencyProbe::getAppliedTag() {
+	return mApplied.load(std::memory_order_acquire);
+}
+
+// Stamps every applied tag up to and including tag as published. Simulation side.
+void LatencyProbe::onPublished(Uint32 tag) {
+	Uint32 published{ mPublished.load(std::memory_order_relaxed) };
+	if (tag <= published) return;
+
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	for (Uint32 t{ published + 1 }; t <= tag; ++t) mSamples[t - 1].published = now;
+	mPublished.store(tag, std::memory_order_release);
+}
+
+// Stamps every published tag up to and including tag as presented. Call straight after the frame is presented. Main thread.
+void LatencyProbe::onPresented(Uint32 tag) {
+	// the snapshot's tag was published before the snapshot was, so the publish stamps are visible
+	if (tag <= mPresented || tag > mPublished.load(std::memory_order_acquire)) return;
+
+	Uint64 now{ SDL_GetPerformanceCounter() };
+	for (Uint32 t{ mPresented + 1 }; t <= tag; ++t) mSamples[t - 1].presented = now;
+	mPresented = tag;
+}
+
+// Returns true once all samples have been presented.
+bool LatencyProbe::isFinished() {
+	return mPresented >= mSamples.size();
+}
+
+// Outputs the loop configuration and latency distributions represented as a string
+std::string LatencyProbe::toString() {
+	using namespace FuGlobals;
+
+	const char* pace{ PACE_MODE == PaceMode::PM_HYBRID ? "hybrid" : (PACE_MODE == PaceMode::PM_VSYNC ? "vsync" : "uncapped") };
+
+	std::ostringstream str{};
+	str << "LatencyProbe::Config: Threaded: " << THREADED_SIM << ", Pacing: " << pace << ", Interpolate: " << INTERPOLATE;
+	str << ", Tick: " << SIM_TICK_MS << "ms, Frame: " << FPS_TARGET << "ms\n";
+	str << "LatencyProbe::Samples: " << mPresented << " of " << mSamples.size() << "\n";
+	str << stageToString("polled to applied", &Sample::applied);
+	str << stageToString("polled to published", &Sample::published);
+	str << stageToString("polled to presented", &Sample::presented);
+	return str.str();
+}
+
+// Returns the p50, p99 and max of one stage's latencies from polled as a string.
+std::string LatencyProbe::stageToString(const char* name, Uint64 Sample::* stage) {
+	std::vector<decimal> times{};
+	for (const Sample& s : mSamples) {
+		if (s.polled != 0 && s.*stage >= s.polled) times.push_back((s.*stage - s.polled) / mCountsPerMS);
+	}
+
+	std::ostringstream str{};
+	str << "LatencyProbe::" << name << ": ";
+	if (times.empty()) {
+		str << "no samples\n";
+		return str.str();
+	}
+
+	std::sort(times.begin(), times.end());
+	auto percentile = [&times](decimal p) { return times[static_cast<size_t>(p * (times.size() - 1))]; };
+	str << "p50 " << percentile(0.5) << "ms, p99 " << percentile(0.99) << "ms, max " << times.back() << "ms\n";
+	return str.str();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <vector>
+#include <string>
+#include <atomic>
+
+/* LatencyProbe - Input to photon latency measurement
+ *
+ * Injects synthetic key presses into SDL's event queue at random intervals and follows each one
+ * through the game loop. Presses are pushed as a user event type registered with SDL_RegisterEvents with
+ * a tag in the event's code, then turned into the key event when polled. From there the tag travels
+ * beside the event, in InputSampler::TimedEvent, so it can be recognised at each stage:
+ *     polled:    GameLoop::handleEvents takes it off the SDL queue (the start of every measurement)
+ *     applied:   the simulation latches it and MisterX handles it on a tick
+ *     published: a snapshot taken after that tick is handed to rendering
+ *     presented: SDLMan::refresh has presented a frame drawn from that snapshot
+ * Snapshots carry the newest applied tag so rendering knows which inputs a frame shows.
+ *
+ * Once the requested number of samples have been presented isFinished() returns true and toString()
+ * gives p50/p99/max latency from polled to each later stage, along with the loop configuration
+ * measured so pacing, vsync and threading settings can be compared run to run.
+ *
+ * poll, inject and present stamps are written by the main thread, apply and publish by the simulation.
+ * Each stage's progress is shared through an atomic tag count so every sample slot has a single writer.
+ */
+class LatencyProbe {
+
+public:
+	static constexpr SDL_Keycode	PROBE_KEY		{ SDLK_RIGHT };	// Key injected. Walking right and stopping changes MisterX state every time.
+	static constexpr Uint32			MIN_GAP_MS		{ 150 };		// Shortest time between injected events
+	static constexpr Uint32			MAX_GAP_MS		{ 350 };		// Longest time between injected events. Random gaps stop injection locking to the frame rate.
+
+	// Constructor takes the number of samples to collect.
+	LatencyProbe(int samples);
+	LatencyProbe() = delete;
+
+	// Pushes the next synthetic key event onto SDL's event queue if it is time to. Main thread.
+	void injectIfDue();
+
+	// Stamps a probe event being taken off the SDL queue and fills key with the key event it stands for. Returns its tag,
+	// or 0 if it wasn't one of ours. Main thread.
+	Uint32 onPolled(const SDL_Event& e, SDL_Event& key);
+
+	// Stamps the event with the given tag being applied to the player. 0 is untagged and ignored. Simulation side.
+	void onApplied(Uint32 tag);
+
+	// Returns the newest tag applied so far for the snapshot to carry. Simulation side.
+	Uint32 getAppliedTag();
+
+	// Stamps every applied tag up to and including tag as published. Simulation side.
+	void onPublished(Uint32 tag);
+
+	// Stamps every published tag up to and including tag as presented. Call straight after the frame is presented. Main thread.
+	void onPresented(Uint32 tag);
+
+	// Returns true once all samples have been presented.
+	bool isFinished();
+
+	// Outputs the loop configuration and latency distributions represented as a string
+	std::string toString();
+
+private:
+	// Stage stamps of one injected event as performance counter values
+	struct Sample {
+		Uint64 polled{};
+		Uint64 applied{};
+		Uint64 published{};
+		Uint64 presented{};
+	};
+
+	// One slot per sample indexed by tag - 1
+	std::vector<Sample> mSamples{};
+
+	// Performance counter ticks per millisecond
+	decimal mCountsPerMS{};
+
+	// SDL event type registered for injected events, (Uint32)-1 if registering failed
+	Uint32 mEventType{ static_cast<Uint32>(-1) };
+
+	// Performance counter value when the next event should be injected
+	Uint64 mNextInject{ 0 };
+
+	// Tags handed out so far. Tags start at 1 as 0 means untagged.
+	Uint32 mInjected{ 0 };
+
+	// Newest tag to reach each stage
+	std::atomic<Uint32> mApplied{ 0 };
+	std::atomic<Uint32> mPublished{ 0 };
+	Uint32 mPresented{ 0 };
+
+	// Returns the p50, p99 and max of one stage's latencies from polled as a string.
+	std::string stageToString(const char* name, Uint64 Sample::* stage);
+};
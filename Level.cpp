@@ -1,9 +1,13 @@
 #include "Level.h"
 #include "FensoxUtils.h"
 #include "StickMan.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <fstream>
 #include <sstream>
 #include <tuple>
+#include <algorithm>
 #include <iostream>
 
 // Constructor takes path to metadata file for the level relative to game executable and an SDLMan pointer to hold for rendering.
@@ -27,7 +31,7 @@ struct Level::SpriteStruct {
 
 // Destructor
 Level::~Level() {
-    if constexpr (FuGlobals::DEBUG_MODE) std::cerr << "Destructor: Level" << std::endl;
+    Log::debug("Destructor: Level");
     for (int i{}; i < mSprites->size(); ++i) mSprites->at(i).sprite.reset();
     mColRects.reset();
     mBGTexture.reset();
@@ -53,8 +57,21 @@ bool Level::load() {
     // Load in the level's background texture
     if (!loadBGTexture()) success = false;
 
+    // Index the collision rectangles over the level now its size is known
+    mColGrid.build(*mColRects, mBGTexture ? mBGTexture->getSize() : SDL_Point{ 0, 0 });
+    mGround.build(*mColRects);
+
+    // size the sprite hash for every sprite the level can spawn. They are added as they spawn and move.
+    SDL_Point maxSize{ 0, 0 };
+    for (const SpriteStruct& ss : *mSprites) {
+        SDL_Point size{ ss.sprite->getMaxCollisionSize() };
+        maxSize = { std::max(maxSize.x, size.x), std::max(maxSize.y, size.y) };
+    }
+    mSpriteHash.reset(mSprites->size(), maxSize);
+    mFoundSprites.reserve(mSprites->size());
+
     //***DEBUG***
-    if constexpr (FuGlobals::DEBUG_MODE) std::cout << toString();
+    if constexpr (FuGlobals::DEBUG_MODE) std::cout << toString() << mColGrid.toString() << mGround.toString() << mSpriteHash.toString();
 
     return success;
 }
@@ -171,14 +188,13 @@ bool Level::storeSprite(std::string value) {
     sprite->setLevel( mLevel );
     sprite->setX(spawnX);
     sprite->setY(spawnY);
+    sprite->storeTickStart();
 
     // store data in a SpriteStruct
     SpriteStruct ss{ std::move(sprite), spawnX, spawnY, playerX, false, greatLess };
     mSprites->push_back( std::move(ss) );
 
-    if constexpr (FuGlobals::DEBUG_MODE) {
-        std::cout << "Level::Sprite data: " << name << ", " << spawnX << ", " << spawnY << ", " << playerX << ", " << greatLess << std::endl;
-    }
+    Log::debug("Level::Sprite data: {}, {}, {}, {}, {}", name, spawnX, spawnY, playerX, greatLess);
 
     return success;
 }
@@ -248,6 +264,28 @@ void Level::setPlayer(std::weak_ptr<Sprite> player) {
     }
 }
 
+// Set's the simulation's timer wheel and hands it to all level sprites.
+void Level::setTimers(std::weak_ptr<TimerWheel> timers) {
+    for (std::size_t i{}; i < mSprites->size(); ++i) {
+        mSprites->at(i).sprite->setTimers(timers);
+    }
+}
+
+// Set's whethar the game loop is behind and optional drawing should be skipped.
+void Level::setDegraded(bool degraded) {
+    mDegraded = degraded;
+}
+
+// Returns true if the game loop is behind and optional work should be skipped.
+bool Level::isDegraded() {
+    return mDegraded;
+}
+
+// Returns the number of sprites spawned and simulated on the last tick.
+int Level::getVisibleSprites() {
+    return mVisibleSprites;
+}
+
 // Return player start position
 SDL_Point Level::getPlayStart() {
     return mPlayStart;
@@ -275,9 +313,73 @@ std::string Level::toString() {
     return str.str();
 }
 
-// Returns the height and width of the level background in an SDL_Point.
+// Folds the state of every level sprite into a running hash and returns it. See Sprite::hashState.
+Uint64 Level::hashSprites(Uint64 hash) {
+    for (std::size_t i{ 0 }; i < mSprites->size(); ++i) {
+        hash = mSprites->at(i).sprite->hashState(hash);
+    }
+    return hash;
+}
+
+// Outputs the position and health of every level sprite, one per line. Used to report the world state after headless runs.
+std::string Level::spritesToString() {
+    std::ostringstream str{};
+    for (std::size_t i{ 0 }; i < mSprites->size(); ++i) {
+        Sprite& sprite = *mSprites->at(i).sprite;
+        str << "Level::Sprite " << i << ": " << sprite.getName() << ", Position: " << sprite.getX() << ", " << sprite.getY();
+        str << ", Health: " << sprite.getHealth() << "/" << sprite.getHealthMax() << "\n";
+    }
+    return str.str();
+}
+
+// Writes the count spawned sprites nearest the given level position into out, three floats each: x and y relative to the position then health.
+// Nearest come first and the rest is zero filled when fewer have spawned. Returns how many have spawned. Builds observations for EnvRunner.
+int Level::storeObservation(float* out, int count, decimal x, decimal y) {
+    int visible{ 0 };
+    for (std::size_t i{}; i < mSprites->size(); ++i) {
+        if (mSprites->at(i).visible) ++visible;
+    }
+
+    // pick the nearest sprite after the last one picked each time round, ordered by distance then index so equal distances take turns
+    decimal lastDist{ -1 };
+    std::size_t lastIndex{ 0 };
+    for (int k{ 0 }; k < count; ++k) {
+        Sprite* best{ nullptr };
+        decimal bestDist{ 0 };
+        std::size_t bestIndex{ 0 };
+        for (std::size_t i{}; i < mSprites->size(); ++i) {
+            const SpriteStruct& ss = mSprites->at(i);
+            if (!ss.visible) continue;
+
+            decimal dx{ ss.sprite->getX() - x };
+            decimal dy{ ss.sprite->getY() - y };
+            decimal dist{ dx * dx + dy * dy };
+            if (dist < lastDist || (dist == lastDist && i <= lastIndex)) continue;
+            if (best == nullptr || dist < bestDist) {
+                best = ss.sprite.get();
+                bestDist = dist;
+                bestIndex = i;
+            }
+        }
+
+        float* o{ out + k * 3 };
+        if (best == nullptr) {
+            o[0] = o[1] = o[2] = 0;
+            continue;
+        }
+        o[0] = static_cast<float>(best->getX() - x);
+        o[1] = static_cast<float>(best->getY() - y);
+        o[2] = static_cast<float>(best->getHealth());
+        lastDist = bestDist;
+        lastIndex = bestIndex;
+    }
+
+    return visible;
+}
+
+// Returns the height and width of the level background in an SDL_Point. Uses the size cached by Texture so the simulation never has to call into SDL.
 SDL_Point Level::getSize() {
-    return mSDL.lock()->getSize( *(mBGTexture.get()) );
+    return mBGTexture->getSize();
 }
 
 // Set's the Sprite pointer that this level's viewport will stay centered on.
@@ -296,13 +398,13 @@ void Level::setLevel(std::weak_ptr<Level> level) {
     mLevel = level;
 }
 
-// Centers the viewport on given x, y coordinates adjusting for level boundries and movement buffer specified in FuGlobals::VIEWPORT_BUFFER.
-void Level::centerViewport() {
+// Centers the viewport on the snapshot's interpolated follow position adjusting for level boundries and movement buffer specified in FuGlobals::VIEWPORT_BUFFER.
+void Level::centerViewport(const RenderSnapshot& snap, decimal alpha) {
     // get center coordinates of viewport and sprite position
     int centerX{ FuGlobals::VIEWPORT_WIDTH / 2 };
     int centerY{ FuGlobals::VIEWPORT_HEIGHT / 2 };
-    int spriteX{ static_cast<int>(mFollowSprite.lock()->getX()) };
-    int spriteY{ static_cast<int>(mFollowSprite.lock()->getY()) };
+    int spriteX{ static_cast<int>(snap.followTickX + (snap.followX - snap.followTickX) * alpha) };
+    int spriteY{ static_cast<int>(snap.followTickY + (snap.followY - snap.followTickY) * alpha) };
 
     // calculate travel limits of sprite before we must scroll viewport
     int leftBound{ mViewport.x + centerX - FuGlobals::VIEWPORT_BUFFER / 2 };
@@ -344,13 +446,7 @@ void Level::drawColRects() {
 
 // Checks if the given point is colliding with any level geometry
 bool Level::isACollisionPoint(const SDL_Point& pnt) {
-    // loop through all our level collision rectangles checking for a collision
-    for (int i{}; i < mColRects->size(); ++i) {
-        const SDL_Rect& r = mColRects->at(i);
-        if (SDL_PointInRect(&pnt, &r)) return true;
-    }
-
-    return false;
+    return mColGrid.hasPoint(pnt);
 }
 
 // Checks if the given point is colliding with any level geometry. Parameter of PointF is cast to integer type SDL_Point.
@@ -360,24 +456,18 @@ bool Level::isACollisionPoint(PointF pnt) {
 
 // Checks if the given rectangle is colliding with any level geomtry.
 bool Level::isACollisionRect(const SDL_Rect& rect) {
-    // loop through all our level collision rectangles checking for a collision
-    for (int i{}; i < mColRects->size(); ++i) {
-        const SDL_Rect& r = mColRects->at(i);
-        if (SDL_HasIntersection(&rect, &r)) return true;
-    }
-
-    return false;
+    return mColGrid.hasRect(rect);
 }
 
 // Checks if the given line is colliding with any level geometry.
 bool Level::isACollisionLevel(Line line) {
-    // loop through all our level collision rectangles checking for a collision
-    for (int i{ 0 }; i < mColRects->size(); ++i) {
-        const SDL_Rect& r = mColRects->at(i);
-        if (SDL_IntersectRectAndLine(&r, &line.x1, &line.y1, &line.x2, &line.y2)) return true;
-    }
+    ProfileZone zone{ "Level::isACollisionLevel" };
 
-    return false;
+    // floor and ceiling checks are horizontal and answered from the heightfield, anything else tests only the rectangles near the line
+    int tested{ 0 };
+    bool collision{ line.y1 == line.y2 ? mGround.hasSpan(line.x1, line.x2, line.y1, tested) : mColGrid.hasLine(line, tested) };
+    Metrics::add(Metric::MT_COLLISION_RECTS, tested);
+    return collision;
 }
 
 // Checks if the given line is involved in a collision.
@@ -389,6 +479,7 @@ bool Level::isACollisionLevel(Line line) {
 // Returns true if a collision occurred.
 bool Level::isACollisionLine(FuGlobals::ColType inType, Line inLine, const Sprite &inIgnore, std::weak_ptr<Sprite> &colSprite) {
     using namespace FuGlobals;
+    Metrics::add(Metric::MT_COLLISION_QUERIES);
 
     bool collision{ false };
     switch (inType) {
@@ -409,16 +500,25 @@ bool Level::isACollisionLine(FuGlobals::ColType inType, Line inLine, const Sprit
 //		Sprite: a reference to the Sprite calling this function to be sure sprite's are not checking for collisions with themselves.
 //		std::shared_ptr<Sprite>: optional parameter to be filled with the Sprite we collided with.
 bool Level::isACollisionSprite(Line line, const Sprite& sprite, std::weak_ptr<Sprite> &colSprite) {
-    // loop through all our level sprite's checking for a collision
-    for (int i{}; i < mSprites->size(); ++i) {
-        SpriteStruct& ss = mSprites->at(i);
-        if (ss.sprite.get() == &sprite) continue; // skip if checking for collision against ourselves
-
-        SDL_Rect r = ss.sprite->getCollisionRect();
-        if (SDL_IntersectRectAndLine(&r, &line.x1, &line.y1, &line.x2, &line.y2)) {
-            colSprite = ss.sprite;
-            return true;
-        }
+    ProfileZone zone{ "Level::isACollisionSprite" };
+
+    // test only the spawned sprites near the line, keeping the first in level sprite order that's hit
+    int tested{ 0 };
+    int hit{ mSpriteHash.findFirst(std::min(line.x1, line.x2), std::min(line.y1, line.y2), std::max(line.x1, line.x2), std::max(line.y1, line.y2), [&](int i) {
+        Sprite* other{ mSprites->at(i).sprite.get() };
+        if (other == &sprite) return false; // skip if checking for collision against ourselves
+
+        // SDL clips the line it is given so test a copy
+        ++tested;
+        Line l{ line };
+        SDL_Rect r = other->getCollisionRect();
+        return SDL_IntersectRectAndLine(&r, &l.x1, &l.y1, &l.x2, &l.y2) == SDL_TRUE;
+    }) };
+    Metrics::add(Metric::MT_COLLISION_SPRITES, tested);
+
+    if (hit != -1) {
+        colSprite = mSprites->at(hit).sprite;
+        return true;
     }
 
     // check for collision with player (who is not kept in mSprites vector) only if we are not the player ourselves
@@ -433,28 +533,100 @@ bool Level::isACollisionSprite(Line line, const Sprite& sprite, std::weak_ptr<Sp
     return false;
 }
 
-// Processes all non-player sprite movement per frame
-void Level::moveSprites() {
+// Replaces out's contents with the spawned level sprites whose collision rectangles intersect area, in level sprite order. For AI and attacks.
+void Level::getSpritesInRect(const SDL_Rect& area, std::vector<std::weak_ptr<Sprite>>& out) {
+    out.clear();
+    if (area.w <= 0 || area.h <= 0) return;
+
+    int tested{ 0 };
+    mSpriteHash.findAll(area.x, area.y, area.x + area.w - 1, area.y + area.h - 1, mFoundSprites, [&](int i) {
+        ++tested;
+        SDL_Rect r = mSprites->at(i).sprite->getCollisionRect();
+        return SDL_HasIntersection(&area, &r) == SDL_TRUE;
+    });
+    Metrics::add(Metric::MT_COLLISION_SPRITES, tested);
+
+    for (int i : mFoundSprites) out.push_back(mSprites->at(i).sprite);
+}
+
+// Processes all non-player sprite movement per tick. dt is the tick length in seconds.
+void Level::moveSprites(decimal dt) {
+    ProfileZone zone{ "Level::moveSprites" };
+
+    int visible{ 0 };
     for (std::size_t i{}; i < mSprites->size(); ++i) {
         SpriteStruct& ss = mSprites->at(i);
 
         if (isSpawnTime(ss)) ss.visible = true;
 
-        if (ss.visible) ss.sprite->move();
+        if (ss.visible) {
+            ss.sprite->storeTickStart();
+            ss.sprite->move(dt);
+            mSpriteHash.update(static_cast<int>(i), static_cast<int>(ss.sprite->getX()), static_cast<int>(ss.sprite->getY()));
+            ++visible;
+        }
     }
+
+    mVisibleSprites = visible;
+    Metrics::set(Metric::MT_SPRITES_ACTIVE, mSprites->size());
+    Metrics::set(Metric::MT_SPRITES_VISIBLE, visible);
 }
 
-// Render all non-player sprites to drawing buffer
-void Level::renderSprites() {
+// Copies the state of all visible sprites, the player, the viewport follow position and HUD values into a snapshot. Called by the simulation at the end of a tick.
+void Level::storeSnapshot(RenderSnapshot& snap) {
+    // reuse the vector's storage from the last time this snapshot was filled
+    snap.sprites.clear();
     for (std::size_t i{}; i < mSprites->size(); ++i) {
-        SpriteStruct ss{ mSprites->at(i) };
-        
-        if (ss.visible) ss.sprite->render();
+        SpriteStruct& ss = mSprites->at(i);
+        if (!ss.visible) continue;
+
+        snap.sprites.emplace_back();
+        ss.sprite->storeSnapshot(snap.sprites.back());
+    }
+
+    // player and HUD
+    std::shared_ptr<Sprite> player{ mPlayer.lock() };
+    player->storeSnapshot(snap.player);
+    snap.playerHealth = player->getHealth();
+    snap.playerHealthMax = player->getHealthMax();
+
+    // position the viewport should follow
+    std::shared_ptr<Sprite> follow{ mFollowSprite.lock() };
+    snap.followTickX = follow->getRenderX(0);
+    snap.followTickY = follow->getRenderY(0);
+    snap.followX = follow->getX();
+    snap.followY = follow->getY();
+
+    snap.degraded = mDegraded;
+}
+
+// Runs AI for one slice of the visible non-player sprites. Sprite i thinks when i % period == slice so each sprite
+// thinks once per period ticks and the work is spread evenly over those ticks.
+void Level::thinkSprites(Uint32 slice, Uint32 period) {
+    for (std::size_t i{ slice }; i < mSprites->size(); i += period) {
+        SpriteStruct& ss = mSprites->at(i);
+        if (ss.visible) ss.sprite->think();
+    }
+}
+
+// Steps animation for all visible non-player sprites.
+void Level::animateSprites() {
+    for (std::size_t i{}; i < mSprites->size(); ++i) {
+        SpriteStruct& ss = mSprites->at(i);
+        if (ss.visible) ss.sprite->animate();
+    }
+}
+
+// Render all non-player sprites in a snapshot to drawing buffer. alpha is how far between the start and end of the snapshot's tick to draw them.
+void Level::renderSprites(const RenderSnapshot& snap, decimal alpha) {
+    SDLMan& sdl{ *mSDL.lock() };
+    for (const SpriteSnapshot& ss : snap.sprites) {
+        Sprite::render(sdl, ss, mViewport, alpha, !snap.degraded);
     }
 }
 
 // Accepts a SpriteStruct and calculates if the player has reached the point where sprite should spawn. Returns the result.
-bool Level::isSpawnTime(SpriteStruct ss) {
+bool Level::isSpawnTime(const SpriteStruct& ss) {
     decimal triggerX{ ss.triggerX };
     decimal playerX{ mPlayer.lock()->getX() };
     char gL{ ss.greatLess };
@@ -472,8 +644,8 @@ bool Level::isSpawnTime(SpriteStruct ss) {
     return false;
 }
 
-// Render the HUD to the drawing buffer
-void Level::renderHUD() {
+// Render the HUD from a snapshot to the drawing buffer
+void Level::renderHUD(const RenderSnapshot& snap) {
     using namespace FuGlobals;
 
     // render player health outline
@@ -483,21 +655,25 @@ void Level::renderHUD() {
     mSDL.lock()->drawRect(playerHealthOutline);
 
     // render player health
-    int scaleFactor{ PLAYER_HEALTH_WIDTH / mPlayer.lock()->getHealthMax() };
-    int healthWidth{ mPlayer.lock()->getHealth() * scaleFactor };
+    int scaleFactor{ PLAYER_HEALTH_WIDTH / snap.playerHealthMax };
+    int healthWidth{ snap.playerHealth * scaleFactor };
     mSDL.lock()->setDrawColor(255, 255, 0, PLAYER_HEALTH_ALPHA);
     mSDL.lock()->drawFillRect(11, 11, healthWidth-2, PLAYER_HEALTH_HEIGHT - 2);
 }
 
-// Render the level to the screen
-void Level::render() {
+// Render the level from a snapshot. alpha is how far between the start and end of the snapshot's tick to draw, 0 to 1.
+// Only reads the snapshot and level data that doesn't change after load so may be called from a render thread.
+void Level::render(const RenderSnapshot& snap, decimal alpha) {
+    ProfileZone zone{ "Level::render" };
+
     // center viewport on the Sprite we've been told to follow
-    centerViewport();
+    centerViewport(snap, alpha);
 
     // put all viewport data into a rectangle for rendering
     SDL_Rect vp{ mViewport.x, mViewport.y, FuGlobals::VIEWPORT_WIDTH, FuGlobals::VIEWPORT_HEIGHT };
 
     // Draw the area of the level our viewport is pointing at
+    Metrics::add(Metric::MT_RENDER_COPIES);
     SDL_RenderCopyEx(mSDL.lock()->getRenderer(),
         mBGTexture->getTexture(),
         &vp,
@@ -507,11 +683,16 @@ void Level::render() {
         SDL_FLIP_NONE);
 
     // Draw all non-player sprites
-    renderSprites();
+    renderSprites(snap, alpha);
 
     // Draw the HUD
-    renderHUD();
+    renderHUD(snap);
+
+    //***DEBUG*** if debug on draw all collision rectangles so visible on screen. Skipped while the game loop is catching up.
+    if constexpr (FuGlobals::DEBUG_MODE) {
+        if (!snap.degraded) drawColRects();
+    }
 
-    //***DEBUG*** if debug on draw all collision rectangles so visible on screen
-    if constexpr (FuGlobals::DEBUG_MODE) drawColRects();
+    // Draw the player last
+    Sprite::render(*mSDL.lock(), snap.player, mViewport, alpha, !snap.degraded);
 }
\ No newline at end of file
@@ -4,6 +4,11 @@
 #include "PointF.h"
 #include "SDLMan.h"
 #include "Line.h"
+#include "RenderSnapshot.h"
+#include "TimerWheel.h"
+#include "CollisionGrid.h"
+#include "Heightfield.h"
+#include "SpriteHash.h"
 #include <memory>
 #include <vector>
 #include <SDL.h>
@@ -49,17 +54,22 @@ public:
 	// Returns the viewport's top-left coordinates and width/height.
 	SDL_Point getPosition();
 
-	// Processes all non-player sprites per frame
-	void moveSprites();
+	// Processes all non-player sprites per tick. dt is the tick length in seconds.
+	void moveSprites(decimal dt);
 
-	// Render all non-player sprites to drawing buffer
-	void renderSprites();
+	// Runs AI for one slice of the visible non-player sprites. Sprite i thinks when i % period == slice so each sprite
+	// thinks once per period ticks and the work is spread evenly over those ticks.
+	void thinkSprites(Uint32 slice, Uint32 period);
 
-	// Render the HUD to the drawing buffer
-	void renderHUD();
+	// Steps animation for all visible non-player sprites.
+	void animateSprites();
 
-	// Render the level
-	void render();
+	// Copies the state of all visible sprites, the player, the viewport follow position and HUD values into a snapshot. Called by the simulation at the end of a tick.
+	void storeSnapshot(RenderSnapshot& snap);
+
+	// Render the level from a snapshot. alpha is how far between the start and end of the snapshot's tick to draw, 0 to 1.
+	// Only reads the snapshot and level data that doesn't change after load so may be called from a render thread.
+	void render(const RenderSnapshot& snap, decimal alpha);
 
 	// Set's the Sprite that this level's viewport will stay centered on. Parameter is a weak_ptr to the Sprite to follow. An overloaded version of this function exists to follow level Sprites.
 	void setFollowSprite(std::weak_ptr<Sprite> follow);
@@ -74,16 +84,56 @@ public:
 	// Set's the player object so the level can query player information.
 	void setPlayer(std::weak_ptr<Sprite> player);
 
+	// Set's the simulation's timer wheel and hands it to all level sprites.
+	void setTimers(std::weak_ptr<TimerWheel> timers);
+
+	// Set's whethar the game loop is behind and optional drawing should be skipped.
+	void setDegraded(bool degraded);
+
+	// Returns true if the game loop is behind and optional work should be skipped.
+	bool isDegraded();
+
+	// Returns the number of sprites spawned and simulated on the last tick.
+	int getVisibleSprites();
+
 	// Outputs the object information represented as a string
 	std::string toString();
 
+	// Folds the state of every level sprite into a running hash and returns it. See Sprite::hashState.
+	Uint64 hashSprites(Uint64 hash);
+
+	// Outputs the position and health of every level sprite, one per line. Used to report the world state after headless runs.
+	std::string spritesToString();
+
+	// Writes the count spawned sprites nearest the given level position into out, three floats each: x and y relative to the position then health.
+	// Nearest come first and the rest is zero filled when fewer have spawned. Returns how many have spawned. Builds observations for EnvRunner.
+	int storeObservation(float* out, int count, decimal x, decimal y);
+
+	// Replaces out's contents with the spawned level sprites whose collision rectangles intersect area, in level sprite order. For AI and attacks.
+	void getSpritesInRect(const SDL_Rect& area, std::vector<std::weak_ptr<Sprite>>& out);
+
 private:
+	// The microbenchmarks in Bench/ time the metadata parser on its own, without the texture and music loads.
+	friend class LevelBench;
+
 	// Easier to work with typedef: A vector of SDL rectangle objects held by a smart pointer. Holds all hard collision objects for the level.
 	typedef std::unique_ptr<std::vector<SDL_Rect>> ColRects;
 
 	// Holds all collision rectangles in a vector wrapped in a smart pointer.
 	ColRects mColRects{ nullptr };
 
+	// Index over mColRects built at the end of load(). Level collision queries other than horizontal lines go through it.
+	CollisionGrid mColGrid{};
+
+	// Solid rows per column of mColRects built at the end of load(). Floor and ceiling checks are horizontal lines and go through it.
+	Heightfield mGround{};
+
+	// Spawned sprites by position, numbered by their place in mSprites. Sized by load() and kept current by moveSprites().
+	SpriteHash mSpriteHash{};
+
+	// Sprite indices found by getSpritesInRect(). Kept between calls so queries don't allocate.
+	std::vector<int> mFoundSprites{};
+
 	// Struct to hold sprite info for one sprite for the current level. See level metadata file for member descriptions.
 	struct SpriteStruct;
 
@@ -129,6 +179,12 @@ private:
 	// Pointer to the player sprite. This get's passed to other level sprites for targeting AI.
 	std::weak_ptr<Sprite> mPlayer;
 
+	// Set by the game loop while it is catching up. Level and sprites skip optional work when true.
+	bool mDegraded{ false };
+
+	// Sprites spawned and simulated on the last tick
+	int mVisibleSprites{ 0 };
+
 	// Initialize/reset all level variables. Used on game initialization and also to clear old data when loading a new level.
 	void resetLevel();
 
@@ -153,14 +209,20 @@ private:
 	// Load in the level's music file. Returns Success.
 	bool loadMusicFile();
 
-	// Centers the viewport on given x, y coordinates adjusting for level boundries and movement buffer specified in FuGlobals::VIEWPORT_BUFFER.
-	void centerViewport();
+	// Centers the viewport on the snapshot's interpolated follow position adjusting for level boundries and movement buffer specified in FuGlobals::VIEWPORT_BUFFER.
+	void centerViewport(const RenderSnapshot& snap, decimal alpha);
+
+	// Render all non-player sprites in a snapshot to drawing buffer. alpha is how far between the start and end of the snapshot's tick to draw them.
+	void renderSprites(const RenderSnapshot& snap, decimal alpha);
+
+	// Render the HUD from a snapshot to the drawing buffer
+	void renderHUD(const RenderSnapshot& snap);
 
 	// Outlines all the collision rectangles in the level so visible on screen. Debugging and level design utility function.
 	void drawColRects();
 
 	// Accepts a SpriteStruct and calculates if the player has reached the point where sprite should spawn. Returns the result.
-	bool isSpawnTime(SpriteStruct ss);
+	bool isSpawnTime(const SpriteStruct& ss);
 
 	// Checks if the given line is colliding with another sprite.
 	// Parameters are:
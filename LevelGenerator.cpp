@@ -0,0 +1,219 @@
+#include "LevelGenerator.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+// Constructor takes the options to generate with. Width is cut to MAX_WIDTH and negative counts are taken as 0.
+LevelGenerator::LevelGenerator(Options options) {
+	mOptions = options;
+	mOptions.rects = std::max(mOptions.rects, 0);
+	mOptions.sprites = std::max(mOptions.sprites, 0);
+	if (mOptions.width > MAX_WIDTH) {
+		std::cerr << "Warning in LevelGenerator::LevelGenerator. Width " << mOptions.width << " is wider than a background texture can be, using " << MAX_WIDTH << "." << std::endl;
+		mOptions.width = MAX_WIDTH;
+	}
+	mOptions.width = std::max(mOptions.width, FuGlobals::VIEWPORT_WIDTH);
+	mOptions.height = std::max(mOptions.height, FLOOR_Y + 1);
+	mRandom.seed(mOptions.seed);
+}
+
+// Writes <name>.dat and <name>.png. The metadata file refers to the background by the path given. Returns false if either can't be written.
+bool LevelGenerator::generate(std::string name) {
+	mRandom.seed(mOptions.seed);
+	std::vector<SDL_Rect> rects{ makeRects() };
+	std::vector<SpawnPoint> sprites{ makeSprites() };
+
+	bool success{ true };
+	if (!saveData(name + ".dat", name + ".png", rects, sprites)) success = false;
+	if (!saveImage(name + ".png", rects)) success = false;
+	return success;
+}
+
+// Returns a random int from low to high inclusive.
+int LevelGenerator::getRand(int low, int high) {
+	std::uniform_int_distribution<int> range(low, std::max(low, high));
+	return range(mRandom);
+}
+
+// Returns the generated collision rectangles, the floor first.
+std::vector<SDL_Rect> LevelGenerator::makeRects() {
+	std::vector<SDL_Rect> rects{};
+	rects.reserve(static_cast<std::size_t>(mOptions.rects) + 1);
+	rects.push_back({ 0, FLOOR_Y, mOptions.width, mOptions.height - FLOOR_Y });
+
+	switch (mOptions.rectLayout) {
+		case RectLayout::RL_UNIFORM:
+			for (int i{ 0 }; i < mOptions.rects; ++i) {
+				SDL_Rect r{ 0, 0, getRand(16, 256), getRand(8, 64) };
+				r.x = getRand(0, mOptions.width - r.w);
+				r.y = getRand(0, FLOOR_Y - r.h);
+				rects.push_back(r);
+			}
+			break;
+
+		case RectLayout::RL_CLUSTERED: {
+			std::vector<SDL_Point> centres(CLUSTERS);
+			for (SDL_Point& c : centres) c = { getRand(0, mOptions.width), getRand(0, FLOOR_Y) };
+			std::normal_distribution<decimal> spreadX(0, 200);
+			std::normal_distribution<decimal> spreadY(0, 60);
+			for (int i{ 0 }; i < mOptions.rects; ++i) {
+				const SDL_Point& c{ centres[getRand(0, CLUSTERS - 1)] };
+				SDL_Rect r{ 0, 0, getRand(16, 128), getRand(8, 32) };
+				r.x = std::clamp(c.x + static_cast<int>(spreadX(mRandom)), 0, mOptions.width - r.w);
+				r.y = std::clamp(c.y + static_cast<int>(spreadY(mRandom)), 0, FLOOR_Y - r.h);
+				rects.push_back(r);
+			}
+			break;
+		}
+
+		case RectLayout::RL_PLATFORMS: {
+			// lay platforms left to right along a row, stepping up a row each time one fills
+			int x{ 0 };
+			int y{ FLOOR_Y - PLATFORM_STEP };
+			for (int i{ 0 }; i < mOptions.rects; ++i) {
+				SDL_Rect r{ x, y, getRand(64, 320), 16 };
+				if (r.x + r.w > mOptions.width) {
+					x = getRand(0, 96);
+					y = y - PLATFORM_STEP < 0 ? FLOOR_Y - PLATFORM_STEP : y - PLATFORM_STEP;
+					r.x = x;
+					r.y = y;
+				}
+				rects.push_back(r);
+				x = r.x + r.w + getRand(48, 160);
+			}
+			break;
+		}
+	}
+
+	return rects;
+}
+
+// Returns the generated sprite spawn points.
+std::vector<LevelGenerator::SpawnPoint> LevelGenerator::makeSprites() {
+	using namespace FuGlobals;
+
+	// sprites drop in from the height Level1's do and the player starts a half viewport in from the left
+	const int spawnY{ 200 };
+	const int playerX{ VIEWPORT_WIDTH / 2 };
+
+	std::vector<SpawnPoint> sprites{};
+	sprites.reserve(mOptions.sprites);
+	for (int i{ 0 }; i < mOptions.sprites; ++i) {
+		SpawnPoint sp{ getRand(0, mOptions.width), spawnY, 0, 'G' };
+
+		switch (mOptions.spawnLayout) {
+			case SpawnLayout::SL_IMMEDIATE:
+				sp.triggerX = 0;
+				break;
+
+			case SpawnLayout::SL_SPREAD:
+				if (sp.x > playerX) {
+					sp.triggerX = sp.x - VIEWPORT_WIDTH;
+				} else {
+					sp.triggerX = sp.x + VIEWPORT_WIDTH;
+					sp.greatLess = 'L';
+				}
+				break;
+
+			case SpawnLayout::SL_WAVES:
+				sp.triggerX = playerX - 1 + (i / WAVE_SIZE) * WAVE_SPACING;
+				sp.x = std::clamp(sp.triggerX + VIEWPORT_WIDTH / 2 + getRand(-200, 200), 0, mOptions.width);
+				break;
+		}
+
+		sprites.push_back(sp);
+	}
+
+	return sprites;
+}
+
+// Writes the metadata file. Returns false if it can't be written.
+bool LevelGenerator::saveData(std::string fileName, std::string bgFile, const std::vector<SDL_Rect>& rects, const std::vector<SpawnPoint>& sprites) {
+	std::ofstream out{ fileName };
+	if (!out) {
+		std::cerr << "Failed in LevelGenerator::saveData. Could not open \"" << fileName << "\"." << std::endl;
+		return false;
+	}
+
+	out << "# Kung Fu MXR - Standard Level Metadata File V.1.0\n";
+	out << "# Generated by LevelGenerator: " << toString() << "\n";
+	out << "# See Data/Level1.dat for the file format.\n\n";
+	out << "NAME=Stress " << mOptions.rects << " rects " << mOptions.sprites << " sprites\n";
+	out << "BACKGROUND=" << bgFile << "\n";
+	out << "TRANS_COLOR=92,148,252,0\n";
+	out << "MUSIC=Data/kung_fu_music_edited.mp3\n";
+	out << "PLAYER_START=" << FuGlobals::VIEWPORT_WIDTH / 2 << ", 0\n";
+
+	for (const SpawnPoint& sp : sprites) out << "SPRITE=STICKMAN, " << sp.x << ", " << sp.y << ", " << sp.triggerX << ", " << sp.greatLess << "\n";
+	for (const SDL_Rect& r : rects) out << "COLRECT=" << r.x << ", " << r.y << ", " << r.w << ", " << r.h << "\n";
+
+	out << "\n# End data file";
+	return out.good();
+}
+
+// Writes the background image with the rectangles drawn on it. Returns false if it can't be written.
+bool LevelGenerator::saveImage(std::string fileName, const std::vector<SDL_Rect>& rects) {
+	SDL_Surface* image{ SDL_CreateRGBSurfaceWithFormat(0, mOptions.width, mOptions.height, 32, SDL_PIXELFORMAT_RGBA32) };
+	if (!image) {
+		std::cerr << "Failed in LevelGenerator::saveImage trying to create a surface. SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	// sky from Level1's blue at the top fading lighter toward the floor, in bands
+	for (int y{ 0 }; y < FLOOR_Y; y += 8) {
+		int t{ y * 100 / FLOOR_Y };
+		SDL_Rect band{ 0, y, mOptions.width, 8 };
+		SDL_FillRect(image, &band, SDL_MapRGBA(image->format, static_cast<Uint8>(92 + t), static_cast<Uint8>(148 + t / 2), 252, 255));
+	}
+
+	// the floor, then the rectangles with a lighter top edge so ones that overlap can be told apart
+	for (std::size_t i{ 0 }; i < rects.size(); ++i) {
+		SDL_Rect r{ rects[i] };
+		SDL_FillRect(image, &r, i == 0 ? SDL_MapRGBA(image->format, 120, 80, 40, 255) : SDL_MapRGBA(image->format, 90, 90, 110, 255));
+		r.h = 2;
+		SDL_FillRect(image, &r, i == 0 ? SDL_MapRGBA(image->format, 160, 120, 70, 255) : SDL_MapRGBA(image->format, 150, 150, 170, 255));
+	}
+
+	// distance markers along the floor every viewport width so scrolling can be seen
+	for (int x{ 0 }; x < mOptions.width; x += FuGlobals::VIEWPORT_WIDTH) {
+		SDL_Rect mark{ x, FLOOR_Y, 4, 40 };
+		SDL_FillRect(image, &mark, SDL_MapRGBA(image->format, 240, 220, 60, 255));
+	}
+
+	bool success{ IMG_SavePNG(image, fileName.c_str()) == 0 };
+	if (!success) std::cerr << "Failed in LevelGenerator::saveImage trying to write \"" << fileName << "\". SDL_Image Error: " << IMG_GetError() << std::endl;
+	SDL_FreeSurface(image);
+
+	return success;
+}
+
+// Converts "uniform", "clustered" or "platforms" to a RectLayout. Returns false if the name isn't one of them.
+bool LevelGenerator::parseRectLayout(std::string name, RectLayout& layout) {
+	if (name == "uniform") layout = RectLayout::RL_UNIFORM;
+	else if (name == "clustered") layout = RectLayout::RL_CLUSTERED;
+	else if (name == "platforms") layout = RectLayout::RL_PLATFORMS;
+	else return false;
+	return true;
+}
+
+// Converts "immediate", "spread" or "waves" to a SpawnLayout. Returns false if the name isn't one of them.
+bool LevelGenerator::parseSpawnLayout(std::string name, SpawnLayout& layout) {
+	if (name == "immediate") layout = SpawnLayout::SL_IMMEDIATE;
+	else if (name == "spread") layout = SpawnLayout::SL_SPREAD;
+	else if (name == "waves") layout = SpawnLayout::SL_WAVES;
+	else return false;
+	return true;
+}
+
+// Outputs the object information represented as a string
+std::string LevelGenerator::toString() {
+	static constexpr const char* RECT_NAMES[]{ "uniform", "clustered", "platforms" };
+	static constexpr const char* SPAWN_NAMES[]{ "immediate", "spread", "waves" };
+
+	std::ostringstream str{};
+	str << mOptions.width << "x" << mOptions.height << ", " << mOptions.rects << " rects " << RECT_NAMES[static_cast<int>(mOptions.rectLayout)];
+	str << ", " << mOptions.sprites << " sprites " << SPAWN_NAMES[static_cast<int>(mOptions.spawnLayout)] << ", seed " << mOptions.seed;
+	return str.str();
+}
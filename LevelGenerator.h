@@ -0,0 +1,100 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <random>
+
+/* LevelGenerator - Writes synthetic stress levels for scaling tests
+ *
+ * generate() writes <name>.dat, a level metadata file in the same format as Data/Level1.dat, and <name>.png,
+ * a procedural background the size of the level with every collision rectangle drawn on it so they can be
+ * seen in game. The level has a floor along the bottom like Level1, a PLAYER_START at its left end, the
+ * requested number of extra collision rectangles and STICKMAN sprites, and uses Level1's music.
+ *
+ * Collision rectangles are laid out by RectLayout:
+ *     RL_UNIFORM		scattered evenly over the level above the floor
+ *     RL_CLUSTERED		bunched around CLUSTERS random points, the worst case for anything spatial
+ *     RL_PLATFORMS		side by side in rows of platforms stepping up from the floor
+ * Sprite spawn triggers are laid out by SpawnLayout:
+ *     SL_IMMEDIATE		every sprite spawns on the first tick, the worst case for Level::moveSprites
+ *     SL_SPREAD		each sprite spawns once the player is a viewport width away from it, as in Level1
+ *     SL_WAVES			sprites come in groups of WAVE_SIZE, each group spawning together WAVE_SPACING further on
+ *
+ * The same Options and seed always give the same level. Run the game with "--generate-level" to write one
+ * (see KungFuMXR.cpp) then load it in place of Data/Level1.dat.
+ */
+class LevelGenerator {
+
+public:
+	static constexpr int	MAX_WIDTH		{ 16384 };	// Widest background most renderers can make a texture from
+	static constexpr int	FLOOR_Y			{ 470 };	// Top of the floor, as in Level1
+	static constexpr int	CLUSTERS		{ 32 };		// Cluster centres for RL_CLUSTERED
+	static constexpr int	PLATFORM_STEP	{ 90 };		// Height between rows of platforms for RL_PLATFORMS
+	static constexpr int	WAVE_SIZE		{ 50 };		// Sprites per wave for SL_WAVES
+	static constexpr int	WAVE_SPACING	{ 640 };	// Player distance between waves for SL_WAVES
+
+	// How collision rectangles are placed. See class comment.
+	enum class RectLayout { RL_UNIFORM, RL_CLUSTERED, RL_PLATFORMS };
+
+	// How sprite spawn triggers are placed. See class comment.
+	enum class SpawnLayout { SL_IMMEDIATE, SL_SPREAD, SL_WAVES };
+
+	// What to generate. Defaults to a level the size of Level1 with 10,000 rectangles and 5,000 sprites.
+	struct Options {
+		int width{ 7680 };
+		int height{ FuGlobals::VIEWPORT_HEIGHT };
+		int rects{ 10000 };
+		int sprites{ 5000 };
+		RectLayout rectLayout{ RectLayout::RL_UNIFORM };
+		SpawnLayout spawnLayout{ SpawnLayout::SL_SPREAD };
+		Uint32 seed{ 1 };
+	};
+
+	// Constructor takes the options to generate with. Width is cut to MAX_WIDTH and negative counts are taken as 0.
+	LevelGenerator(Options options);
+	LevelGenerator() = delete;
+
+	// Writes <name>.dat and <name>.png. The metadata file refers to the background by the path given. Returns false if either can't be written.
+	bool generate(std::string name);
+
+	// Converts "uniform", "clustered" or "platforms" to a RectLayout. Returns false if the name isn't one of them.
+	static bool parseRectLayout(std::string name, RectLayout& layout);
+
+	// Converts "immediate", "spread" or "waves" to a SpawnLayout. Returns false if the name isn't one of them.
+	static bool parseSpawnLayout(std::string name, SpawnLayout& layout);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// What to generate
+	Options mOptions{};
+
+	// Random numbers for placement, seeded from the options so levels can be made again
+	std::mt19937 mRandom{};
+
+	// One sprite's spawn position and trigger. See the SPRITE key in Data/Level1.dat.
+	struct SpawnPoint {
+		int x{ 0 };
+		int y{ 0 };
+		int triggerX{ 0 };
+		char greatLess{ 'G' };
+	};
+
+	// Returns a random int from low to high inclusive.
+	int getRand(int low, int high);
+
+	// Returns the generated collision rectangles, the floor first.
+	std::vector<SDL_Rect> makeRects();
+
+	// Returns the generated sprite spawn points.
+	std::vector<SpawnPoint> makeSprites();
+
+	// Writes the metadata file. Returns false if it can't be written.
+	bool saveData(std::string fileName, std::string bgFile, const std::vector<SDL_Rect>& rects, const std::vector<SpawnPoint>& sprites);
+
+	// Writes the background image with the rectangles drawn on it. Returns false if it can't be written.
+	bool saveImage(std::string fileName, const std::vector<SDL_Rect>& rects);
+};
@@ -0,0 +1,172 @@
+#include "Log.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <cstring>
+
+std::vector<std::unique_ptr<Log::Ring>> Log::sRings{};
+std::mutex Log::sMutex{};
+std::thread Log::sWriter{};
+std::atomic<bool> Log::sRunning{ false };
+std::atomic<bool> Log::sStopped{ false };
+Uint64 Log::sStartCounter{ 0 };
+
+// Starts the writer thread.
+void Log::start() {
+	if (sRunning) return;
+
+	sStartCounter = SDL_GetPerformanceCounter();
+	sStopped = false;
+	sRunning = true;
+	sWriter = std::thread{ &Log::runWriter };
+}
+
+// Writes out everything logged and stops the writer thread.
+void Log::stop() {
+	if (sRunning) {
+		sRunning = false;
+		if (sWriter.joinable()) sWriter.join();
+	}
+
+	sStopped = true;
+	drain();
+
+	Uint64 dropped{ getDropped() };
+	if (dropped > 0) std::cerr << "Log::stop - " << dropped << " messages were dropped because a thread's log ring was full." << std::endl;
+}
+
+// Returns the number of messages dropped because a thread's ring was full
+Uint64 Log::getDropped() {
+	std::lock_guard<std::mutex> lock{ sMutex };
+	Uint64 dropped{ 0 };
+	for (const std::unique_ptr<Ring>& ring : sRings) dropped += ring->dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
+
+// Copies a string argument into the record's text, cut short if it doesn't fit.
+void Log::setText(Record& r, Arg& a, std::string_view text) {
+	std::size_t length{ std::min<std::size_t>(text.size(), TEXT_CHARS - r.textUsed) };
+	std::memcpy(r.text + r.textUsed, text.data(), length);
+
+	a.type = ArgType::AT_TEXT;
+	a.text.offset = static_cast<Uint16>(r.textUsed);
+	a.text.length = static_cast<Uint16>(length);
+	r.textUsed += static_cast<int>(length);
+}
+
+// Adds a record to the calling thread's ring, or writes it straight away after stop().
+void Log::push(const Record& r) {
+	if (sStopped) {
+		std::lock_guard<std::mutex> lock{ sMutex };
+		output(format(r));
+		return;
+	}
+
+	Ring& ring{ getRing() };
+	Uint64 head{ ring.head.load(std::memory_order_relaxed) };
+	if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ring.records[head % RING_SIZE] = r;
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+// Returns the calling thread's ring, registering one on first use.
+Log::Ring& Log::getRing() {
+	thread_local Ring* tRing{ nullptr };
+
+	if (!tRing) {
+		std::lock_guard<std::mutex> lock{ sMutex };
+		sRings.push_back(std::make_unique<Ring>());
+		tRing = sRings.back().get();
+	}
+
+	return *tRing;
+}
+
+// Body of the writer thread.
+void Log::runWriter() {
+	while (sRunning) {
+		SDL_Delay(FuGlobals::LOG_FLUSH_MS);
+		drain();
+	}
+}
+
+// Writes out everything waiting in every ring in time order.
+void Log::drain() {
+	// only ever touched here, under the lock, so kept to save reallocating every flush
+	static std::vector<Record> batch{};
+
+	std::lock_guard<std::mutex> lock{ sMutex };
+	batch.clear();
+
+	for (const std::unique_ptr<Ring>& ring : sRings) {
+		Uint64 tail{ ring->tail.load(std::memory_order_relaxed) };
+		Uint64 head{ ring->head.load(std::memory_order_acquire) };
+		for (Uint64 i{ tail }; i < head; ++i) batch.push_back(ring->records[i % RING_SIZE]);
+		ring->tail.store(head, std::memory_order_release);
+	}
+	if (batch.empty()) return;
+
+	// rings are each in order but threads interleave
+	std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) { return a.counter < b.counter; });
+
+	std::string lines{};
+	for (const Record& r : batch) lines += format(r);
+	output(lines);
+}
+
+// Formats a record as one line of text.
+std::string Log::format(const Record& r) {
+	using FuGlobals::LogLevel;
+
+	std::ostringstream str{};
+	decimal seconds{ r.counter > sStartCounter ? static_cast<decimal>(r.counter - sStartCounter) / SDL_GetPerformanceFrequency() : 0 };
+	str << std::fixed << std::setprecision(4) << std::setw(10) << seconds << " ";
+	str.unsetf(std::ios::fixed);
+	str << std::setprecision(6);
+
+	switch (r.level) {
+		case LogLevel::LL_DEBUG:	str << "DEBUG "; break;
+		case LogLevel::LL_INFO:		str << "INFO  "; break;
+		case LogLevel::LL_WARNING:	str << "WARN  "; break;
+		case LogLevel::LL_ERROR:	str << "ERROR "; break;
+	}
+
+	// put each argument where the next {} is
+	int next{ 0 };
+	for (const char* c{ r.format }; *c != '\0'; ++c) {
+		if (c[0] == '{' && c[1] == '}' && next < r.argCount) {
+			const Arg& a{ r.args[next++] };
+			switch (a.type) {
+				case ArgType::AT_INT:		str << a.i; break;
+				case ArgType::AT_UINT:		str << a.u; break;
+				case ArgType::AT_DOUBLE:	str << a.d; break;
+				case ArgType::AT_BOOL:		str << (a.u ? "true" : "false"); break;
+				case ArgType::AT_CHAR:		str << static_cast<char>(a.i); break;
+				case ArgType::AT_TEXT:		str.write(r.text + a.text.offset, a.text.length); break;
+			}
+			++c;
+		} else {
+			str << *c;
+		}
+	}
+	str << "\n";
+
+	return str.str();
+}
+
+// Writes formatted lines to LOG_FILE or the standard error stream. Caller holds sMutex.
+void Log::output(const std::string& lines) {
+	if (FuGlobals::LOG_FILE[0] == '\0') {
+		std::cerr << lines << std::flush;
+		return;
+	}
+
+	static std::ofstream file{ FuGlobals::LOG_FILE, std::ios::app };
+	file << lines << std::flush;
+}
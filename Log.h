@@ -0,0 +1,176 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+/* Log - Asynchronous logging for the game and simulation threads
+ *
+ * Log calls take a format string with {} where each argument goes:
+ *     Log::debug("Colliding with sprite: {} punching: {}", name, mPunching);
+ * The format string must be a string literal as only the pointer is kept. Numbers, bools and chars are
+ * stored as they are and strings are copied (up to TEXT_CHARS in total per message), so the call is a
+ * few stores into the calling thread's ring buffer with no formatting, locking or I/O. A background
+ * writer thread wakes every LOG_FLUSH_MS, formats everything waiting in time order and writes it to
+ * LOG_FILE or the standard error stream. Messages from a thread whose ring is full are dropped and counted
+ * rather than making the game wait.
+ *
+ * Calls below FuGlobals::LOG_LEVEL are removed at compile time. start() is called at the top of main
+ * and stop() at the end, which writes out whatever is left. Messages logged after stop() are written
+ * straight away on the calling thread.
+ */
+class Log {
+
+public:
+	static constexpr int RING_SIZE	{ 1024 };	// Messages buffered per thread
+	static constexpr int MAX_ARGS	{ 6 };		// Most arguments per message. Extra {} print as they are.
+	static constexpr int TEXT_CHARS	{ 64 };		// Characters of string arguments kept per message. Longer strings are cut short.
+
+	// Logs at debug level.
+	template <typename... Args>
+	static void debug(const char* format, const Args&... args) { write<FuGlobals::LogLevel::LL_DEBUG>(format, args...); }
+
+	// Logs at info level.
+	template <typename... Args>
+	static void info(const char* format, const Args&... args) { write<FuGlobals::LogLevel::LL_INFO>(format, args...); }
+
+	// Logs at warning level.
+	template <typename... Args>
+	static void warning(const char* format, const Args&... args) { write<FuGlobals::LogLevel::LL_WARNING>(format, args...); }
+
+	// Logs at error level.
+	template <typename... Args>
+	static void error(const char* format, const Args&... args) { write<FuGlobals::LogLevel::LL_ERROR>(format, args...); }
+
+	// Logs a message at the given level. Removed at compile time below FuGlobals::LOG_LEVEL.
+	template <FuGlobals::LogLevel level, typename... Args>
+	static void write(const char* format, const Args&... args) {
+		if constexpr (level >= FuGlobals::LOG_LEVEL) {
+			static_assert(sizeof...(Args) <= MAX_ARGS, "Log: too many arguments");
+			Record r{};
+			r.counter = SDL_GetPerformanceCounter();
+			r.format = format;
+			r.level = level;
+			(setArg(r, args), ...);
+			push(r);
+		}
+	}
+
+	// Starts the writer thread.
+	static void start();
+
+	// Writes out everything logged and stops the writer thread.
+	static void stop();
+
+	// Returns the number of messages dropped because a thread's ring was full
+	static Uint64 getDropped();
+
+private:
+	// Kinds of stored argument
+	enum class ArgType { AT_INT, AT_UINT, AT_DOUBLE, AT_BOOL, AT_CHAR, AT_TEXT };
+
+	// Where a text argument sits in its record's text
+	struct TextRef {
+		Uint16 offset;
+		Uint16 length;
+	};
+
+	// A stored argument
+	struct Arg {
+		ArgType type{ ArgType::AT_INT };
+		union {
+			Sint64 i;
+			Uint64 u;
+			double d;
+			TextRef text;
+		};
+	};
+
+	// One message waiting to be written
+	struct Record {
+		Uint64 counter{ 0 };
+		const char* format{ nullptr };
+		FuGlobals::LogLevel level{ FuGlobals::LogLevel::LL_DEBUG };
+		int argCount{ 0 };
+		int textUsed{ 0 };
+		Arg args[MAX_ARGS]{};
+		char text[TEXT_CHARS]{};
+	};
+
+	// One thread's ring. The owning thread writes records and moves head, the writer thread reads them and moves tail.
+	struct Ring {
+		Record records[RING_SIZE]{};
+		std::atomic<Uint64> head{ 0 };
+		std::atomic<Uint64> tail{ 0 };
+		std::atomic<Uint64> dropped{ 0 };
+	};
+
+	// Every thread's ring. Kept until exit so messages from finished threads still get written.
+	static std::vector<std::unique_ptr<Ring>> sRings;
+
+	// Guards sRings and writing output
+	static std::mutex sMutex;
+
+	// Writer thread, its run flag, and whethar stop() has been called
+	static std::thread sWriter;
+	static std::atomic<bool> sRunning;
+	static std::atomic<bool> sStopped;
+
+	// Performance counter at start up. Times are written relative to it.
+	static Uint64 sStartCounter;
+
+	// Stores one argument in a record.
+	template <typename T>
+	static void setArg(Record& r, const T& value) {
+		Arg& a{ r.args[r.argCount++] };
+		if constexpr (std::is_same_v<T, bool>) {
+			a.type = ArgType::AT_BOOL;
+			a.u = value;
+		} else if constexpr (std::is_same_v<T, char>) {
+			a.type = ArgType::AT_CHAR;
+			a.i = value;
+		} else if constexpr (std::is_enum_v<T>) {
+			a.type = ArgType::AT_INT;
+			a.i = static_cast<Sint64>(value);
+		} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			a.type = ArgType::AT_INT;
+			a.i = value;
+		} else if constexpr (std::is_integral_v<T>) {
+			a.type = ArgType::AT_UINT;
+			a.u = value;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			a.type = ArgType::AT_DOUBLE;
+			a.d = value;
+		} else {
+			setText(r, a, std::string_view{ value });
+		}
+	}
+
+	// Copies a string argument into the record's text, cut short if it doesn't fit.
+	static void setText(Record& r, Arg& a, std::string_view text);
+
+	// Adds a record to the calling thread's ring, or writes it straight away after stop().
+	static void push(const Record& r);
+
+	// Returns the calling thread's ring, registering one on first use.
+	static Ring& getRing();
+
+	// Body of the writer thread.
+	static void runWriter();
+
+	// Writes out everything waiting in every ring in time order.
+	static void drain();
+
+	// Formats a record as one line of text.
+	static std::string format(const Record& r);
+
+	// Writes formatted lines to LOG_FILE or the standard error stream. Caller holds sMutex.
+	static void output(const std::string& lines);
+};
@@ -0,0 +1,183 @@
+#include "Metrics.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+std::vector<std::unique_ptr<Metrics::ThreadCounters>> Metrics::sThreads{};
+std::mutex Metrics::sMutex{};
+std::atomic<Sint64> Metrics::sGauges[static_cast<int>(Metric::MT_COUNT)]{};
+Uint64 Metrics::sLastTotals[static_cast<int>(Metric::MT_COUNT)]{};
+std::thread Metrics::sExporter{};
+std::atomic<bool> Metrics::sRunning{ false };
+std::string Metrics::sSink{};
+int Metrics::sSocket{ -1 };
+
+// Starts the exporter thread writing to the given sink: a file path or "unix:<socket path>". Returns false if the sink can't be used.
+bool Metrics::start(const std::string& sink) {
+	if (sRunning) return true;
+
+#ifdef _WIN32
+	if (sink.find("unix:") == 0) {
+		std::cerr << "Failed in Metrics::start. Unix socket sinks are not supported on Windows: " << sink << std::endl;
+		return false;
+	}
+#endif
+
+	sSink = sink;
+	sRunning = true;
+	sExporter = std::thread{ &Metrics::runExporter };
+	return true;
+}
+
+// Writes a last line and stops the exporter thread.
+void Metrics::stop() {
+	if (!sRunning) return;
+
+	sRunning = false;
+	if (sExporter.joinable()) sExporter.join();
+
+#ifndef _WIN32
+	if (sSocket != -1) close(sSocket);
+	sSocket = -1;
+#endif
+}
+
+// Returns the line protocol line for everything since the last call. Called by the exporter each period.
+std::string Metrics::collect() {
+	constexpr int count{ static_cast<int>(Metric::MT_COUNT) };
+
+	// sum every thread's counters
+	Uint64 totals[count]{};
+	{
+		std::lock_guard<std::mutex> lock{ sMutex };
+		for (const std::unique_ptr<ThreadCounters>& tc : sThreads) {
+			for (int i{ 0 }; i < count; ++i) totals[i] += tc->values[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	std::ostringstream line{};
+	line << "kfmxr ";
+	for (int i{ 0 }; i < count; ++i) {
+		Metric m{ static_cast<Metric>(i) };
+		if (i > 0) line << ",";
+
+		if (isGauge(m)) {
+			line << getName(m) << "=" << sGauges[i].load(std::memory_order_relaxed) << "i";
+		} else {
+			line << getName(m) << "=" << (totals[i] - sLastTotals[i]) << "i";
+			sLastTotals[i] = totals[i];
+		}
+	}
+
+	auto now{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()) };
+	line << " " << now.count() << "\n";
+
+	return line.str();
+}
+
+// Returns a counter's total across all threads since start up, or a gauge's value.
+Sint64 Metrics::getTotal(Metric metric) {
+	int i{ static_cast<int>(metric) };
+	if (isGauge(metric)) return sGauges[i].load(std::memory_order_relaxed);
+
+	Uint64 total{ 0 };
+	std::lock_guard<std::mutex> lock{ sMutex };
+	for (const std::unique_ptr<ThreadCounters>& tc : sThreads) total += tc->values[i].load(std::memory_order_relaxed);
+	return static_cast<Sint64>(total);
+}
+
+// Returns the calling thread's counters, registering them on first use.
+Metrics::ThreadCounters& Metrics::getThreadCounters() {
+	thread_local ThreadCounters* tCounters{ nullptr };
+
+	if (!tCounters) {
+		std::lock_guard<std::mutex> lock{ sMutex };
+		sThreads.push_back(std::make_unique<ThreadCounters>());
+		tCounters = sThreads.back().get();
+	}
+
+	return *tCounters;
+}
+
+// Returns the line protocol field name of a metric.
+const char* Metrics::getName(Metric metric) {
+	switch (metric) {
+		case Metric::MT_TICKS:				return "ticks";
+		case Metric::MT_FRAMES:				return "frames";
+		case Metric::MT_COLLISION_QUERIES:	return "collision_queries";
+		case Metric::MT_COLLISION_RECTS:	return "collision_rects_tested";
+		case Metric::MT_COLLISION_SPRITES:	return "collision_sprites_tested";
+		case Metric::MT_RENDER_COPIES:		return "render_copies";
+		case Metric::MT_SOUNDS_PLAYED:		return "sounds_played";
+		case Metric::MT_ASSETS_LOADED:		return "assets_loaded";
+		case Metric::MT_SPRITES_ACTIVE:		return "sprites_active";
+		case Metric::MT_SPRITES_VISIBLE:	return "sprites_visible";
+		case Metric::MT_TEXTURE_BYTES:		return "texture_bytes";
+		default:							return "unknown";
+	}
+}
+
+// Returns true if the metric is a gauge.
+bool Metrics::isGauge(Metric metric) {
+	return metric == Metric::MT_SPRITES_ACTIVE || metric == Metric::MT_SPRITES_VISIBLE || metric == Metric::MT_TEXTURE_BYTES;
+}
+
+// Body of the exporter thread.
+void Metrics::runExporter() {
+	Uint32 lastExport{ SDL_GetTicks() };
+
+	while (sRunning) {
+		// short sleeps so stop() doesn't wait out a whole period
+		SDL_Delay(50);
+		if (SDL_GetTicks() - lastExport < FuGlobals::METRICS_PERIOD_MS) continue;
+
+		lastExport = SDL_GetTicks();
+		write(collect());
+	}
+
+	// one last line covering the part period before stopping
+	write(collect());
+}
+
+// Writes a line to the sink. Returns false on failure. Only called from the exporter thread.
+bool Metrics::write(const std::string& line) {
+#ifndef _WIN32
+	if (sSink.find("unix:") == 0) {
+		// connect, or reconnect after the listener went away
+		if (sSocket == -1) {
+			std::string path{ sSink.substr(5) };
+			sockaddr_un addr{};
+			addr.sun_family = AF_UNIX;
+			std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+			sSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (sSocket == -1) return false;
+			if (connect(sSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+				close(sSocket);
+				sSocket = -1;
+				return false;
+			}
+		}
+
+		if (send(sSocket, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) {
+			close(sSocket);
+			sSocket = -1;
+			return false;
+		}
+		return true;
+	}
+#endif
+
+	std::ofstream out{ sSink, std::ios::app };
+	if (!out) return false;
+	out << line;
+	return out.good();
+}
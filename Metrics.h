@@ -0,0 +1,125 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+// Engine metrics. Counters count events and are exported as the number since the last export. Gauges hold a current value.
+enum class Metric {
+	MT_TICKS,					// Counter: simulation ticks run
+	MT_FRAMES,					// Counter: frames presented
+	MT_COLLISION_QUERIES,		// Counter: Level::isACollisionLine calls
+	MT_COLLISION_RECTS,			// Counter: level collision rectangles tested
+	MT_COLLISION_SPRITES,		// Counter: sprite collision rectangles tested
+	MT_RENDER_COPIES,			// Counter: SDL_RenderCopyEx calls
+	MT_SOUNDS_PLAYED,			// Counter: sound effects sent to the mixer
+	MT_ASSETS_LOADED,			// Counter: images, sounds and music loaded from disk
+	MT_SPRITES_ACTIVE,			// Gauge: sprites in the level
+	MT_SPRITES_VISIBLE,			// Gauge: sprites spawned and being simulated
+	MT_TEXTURE_BYTES,			// Gauge: estimated bytes of textures loaded, at 4 bytes per pixel
+	MT_COUNT
+};
+
+/* Metrics - Engine counters and gauges exported as line protocol
+ *
+ * Hot paths call Metrics::add() for counters and Metrics::set() or adjust() for gauges. Counters go into
+ * a block owned by the calling thread so counting is a plain relaxed store with no sharing between
+ * threads. Once every METRICS_PERIOD_MS an exporter thread sums every thread's counters and writes one
+ * InfluxDB line protocol line with how much each counter went up and each gauge's value:
+ *     kfmxr ticks=125i,frames=124i,collision_queries=2000i,... 1600000000000000000
+ *
+ * The sink is a file appended to, or a Unix domain stream socket when given as "unix:<path>". A socket
+ * that isn't listening is retried each period. Unix sockets aren't supported on Windows builds.
+ *
+ * Counting is also on for the flight recorder and performance overlay. The overlay reads running totals with getTotal(),
+ * the flight recorder reads the simulation thread's own counters with getThreadTotal() so it takes no lock per tick.
+ * With FuGlobals::METRICS, FLIGHT_RECORDER and PERF_OVERLAY all off add(), set() and adjust() are empty inlines the compiler removes.
+ */
+class Metrics {
+
+public:
+	// Whethar anything reads the metrics so they need counting
+	static constexpr bool ENABLED{ FuGlobals::METRICS || FuGlobals::FLIGHT_RECORDER || FuGlobals::PERF_OVERLAY };
+
+	// Adds to a counter from the calling thread.
+	static void add(Metric metric, Uint64 amount = 1) {
+		if constexpr (ENABLED) {
+			std::atomic<Uint64>& value{ getThreadCounters().values[static_cast<int>(metric)] };
+			value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+	}
+
+	// Sets a gauge.
+	static void set(Metric metric, Sint64 value) {
+		if constexpr (ENABLED) sGauges[static_cast<int>(metric)].store(value, std::memory_order_relaxed);
+	}
+
+	// Adds to or takes from a gauge.
+	static void adjust(Metric metric, Sint64 amount) {
+		if constexpr (ENABLED) sGauges[static_cast<int>(metric)].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	// Starts the exporter thread writing to the given sink: a file path or "unix:<socket path>". Returns false if the sink can't be used.
+	static bool start(const std::string& sink);
+
+	// Writes a last line and stops the exporter thread.
+	static void stop();
+
+	// Returns the line protocol line for everything since the last call. Called by the exporter each period.
+	static std::string collect();
+
+	// Returns a counter's total across all threads since start up, or a gauge's value.
+	static Sint64 getTotal(Metric metric);
+
+	// Returns a counter's total on the calling thread since it first counted. Takes no lock. Not for gauges.
+	static Uint64 getThreadTotal(Metric metric) {
+		if constexpr (!ENABLED) return 0;
+		return getThreadCounters().values[static_cast<int>(metric)].load(std::memory_order_relaxed);
+	}
+
+private:
+	// One thread's counters. Only the owning thread writes.
+	struct ThreadCounters {
+		std::atomic<Uint64> values[static_cast<int>(Metric::MT_COUNT)]{};
+	};
+
+	// Counter blocks of every thread that has counted. Kept until exit so counts from finished threads aren't lost.
+	static std::vector<std::unique_ptr<ThreadCounters>> sThreads;
+
+	// Guards sThreads
+	static std::mutex sMutex;
+
+	// Gauge values
+	static std::atomic<Sint64> sGauges[static_cast<int>(Metric::MT_COUNT)];
+
+	// Counter totals at the last collect()
+	static Uint64 sLastTotals[static_cast<int>(Metric::MT_COUNT)];
+
+	// Exporter thread and its run flag
+	static std::thread sExporter;
+	static std::atomic<bool> sRunning;
+
+	// Sink as given to start(), and the socket when it is a Unix socket
+	static std::string sSink;
+	static int sSocket;
+
+	// Returns the calling thread's counters, registering them on first use.
+	static ThreadCounters& getThreadCounters();
+
+	// Returns the line protocol field name of a metric.
+	static const char* getName(Metric metric);
+
+	// Returns true if the metric is a gauge.
+	static bool isGauge(Metric metric);
+
+	// Body of the exporter thread.
+	static void runExporter();
+
+	// Writes a line to the sink. Returns false on failure. Only called from the exporter thread.
+	static bool write(const std::string& line);
+};
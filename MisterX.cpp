@@ -1,39 +1,41 @@
 #include "MisterX.h"
 #include "FensoxUtils.h"
 #include "FuGlobals.h"
+#include "Profiler.h"
+#include "Log.h"
 #include <iostream>
 #include <cstdlib>
 
 MisterX::MisterX(std::weak_ptr<SDLMan> sdlMan) : Sprite{ sdlMan } {
 	// set our Mr. X specific members
-	mMetaFilename = "data/MisterX.dat";
-	mSpriteSheet = "data/MasterSS.png";
+	mMetaFilename = "Data/MisterX.dat";
+	mSpriteSheet = "Data/MasterSS.png";
     setActionMode("WALK_LEFT", true);
     mTrans = SDL_Color{ 255, 0, 255, 0 };
 	mName = "MisterX";
     mScale = 3;
 
     // load sound effects
-    mSDL.lock()->addSoundEffect("MRX_PUNCH", "data/mrx_punch.wav");
-    mSDL.lock()->addSoundEffect("MRX_KICK", "data/mrx_kick.wav");
+    mSDL.lock()->addSoundEffect("MRX_PUNCH", "Data/mrx_punch.wav");
+    mSDL.lock()->addSoundEffect("MRX_KICK", "Data/mrx_kick.wav");
 };
 
 //**DEBUG** Outputs some debugging info
 void MisterX::outputDebug() {
     using namespace FuGlobals;
 
-    std::cout << "Player x,y:\t\t" << getX() << ", " << getY() << "\n";
-    std::cout << "Velocity l,r,u,d:\t" << mVeloc.left << ", " << mVeloc.right << ", " << mVeloc.up << ", " << mVeloc.down << "\n";
-    std::cout << "Health:\t\t\t" << getHealth() << "\n";
-    std::cout << "mActionMode:\t\t" << getActionMode() << "\n";
-    std::cout << "mLastActionMode:\t" << getLastActionMode() << "\n";
-    std::cout << "mCurrentFrame:\t\t" << mCurrentFrame << "\n";
-    std::cout << "getRect x, y:\t\t" << getRect().x << ", " << getRect().y << "\n";
-    std::cout << "Downbumping:\t\t" << std::boolalpha << isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0) << "\n";
-    std::cout << "mDucking:\t\t" << std::boolalpha << mDucking << "\n";
-    std::cout << "mAttacking:\t\t" << std::boolalpha << mAttacking << "\n";
-    std::cout << "mJumping:\t\t" << std::boolalpha << mJumping << "\n";
-    std::cout << "FPS:\t\t\t" << mSDL.lock()->getFPS() << "\n" << std::endl;
+    Log::debug("Player x,y:\t\t{}, {}", getX(), getY());
+    Log::debug("Velocity l,r,u,d:\t{}, {}, {}, {}", mVeloc.left, mVeloc.right, mVeloc.up, mVeloc.down);
+    Log::debug("Health:\t\t\t{}", getHealth());
+    Log::debug("mActionMode:\t\t{}", getActionMode());
+    Log::debug("mLastActionMode:\t{}", getLastActionMode());
+    Log::debug("mCurrentFrame:\t\t{}", mCurrentFrame);
+    Log::debug("getRect x, y:\t\t{}, {}", getRect().x, getRect().y);
+    Log::debug("Downbumping:\t\t{}", isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0));
+    Log::debug("mDucking:\t\t{}", mDucking);
+    Log::debug("mAttacking:\t\t{}", mAttacking);
+    Log::debug("mJumping:\t\t{}", mJumping);
+    Log::debug("FPS:\t\t\t{}", mSDL.lock()->getFPS());
 }
 
 // Handles joystick input from the player.
@@ -128,7 +130,7 @@ void MisterX::handleInputKeyboard(const SDL_Keycode& key, bool press) {
             if (press) outputDebug();
             break;
         case SDLK_SPACE:
-            //***DEBUG*** For some reason holding down spacebar makes player jump repeatedly yet gamepad button doesn't even though they have same code.
+            // key auto-repeat is filtered out by InputSampler so holding space gives one jump like the gamepad button
             if (press && !mJumping && !mDucking) mJumping = true;
             break;
         case SDLK_DOWN:
@@ -164,13 +166,13 @@ void MisterX::handleInputKeyboard(const SDL_Keycode& key, bool press) {
 }
 
 // Handles the player requesting to move to the right.
-void MisterX::moveRight() {
+void MisterX::moveRight(decimal dt) {
     using namespace FuGlobals;
 
     if (mDucking || mAttacking || !mWalkingRight) return;
 
     // if the previous action was different set new mActionMode, set animation frame to 0, and don't move player position
-    if ( (getActionMode() != "WALK_RIGHT") && (getActionMode() != "JUMP_RIGHT") ) {
+    if ( (getActionModeID() != AM_WALK_RIGHT) && (getActionModeID() != AM_JUMP_RIGHT) ) {
         mFacingRight = true;
         if (!isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0)) {
             setActionMode("JUMP_RIGHT", false);
@@ -179,27 +181,24 @@ void MisterX::moveRight() {
         }        
     } else {
         // if we have no vertical velocity make sure we are not in the jump animation
-        if (mVeloc.down == 0 && mVeloc.up == 0 && getActionMode().compare("WALK_RIGHT") != 0) {
+        if (mVeloc.down == 0 && mVeloc.up == 0 && getActionModeID() != AM_WALK_RIGHT) {
             setActionMode("WALK_RIGHT", true);
         }
 
-        // step animation frame if enough time has passed and we're not pressed up against an object
-        if (checkWalkTime() && !isCollision(ColType::CT_LEVEL, ColDirect::CD_RIGHT, 1)) advanceFrame();
-
-        // increase velocity based on FPS calc to reach our per second goal
-        mVeloc.right += WALK_VELOCITY_PER / mSDL.lock()->getFPS();
+        // increase velocity by one tick's share of our per second goal
+        mVeloc.right += WALK_VELOCITY_PER * dt;
         if (mVeloc.right > WALK_MAX) mVeloc.right = WALK_MAX;
     }
 }
 
 // Handles the player requesting to move to the left.
-void MisterX::moveLeft() {
+void MisterX::moveLeft(decimal dt) {
     using namespace FuGlobals;
 
     if ( mDucking || mAttacking || !mWalkingLeft) return;
 
     // if the previous action was different set new mActionMode, mCurrentFrame 0, and don't move player position
-    if ( (getActionMode() != "WALK_LEFT") && (getActionMode() != "JUMP_LEFT") ) {
+    if ( (getActionModeID() != AM_WALK_LEFT) && (getActionModeID() != AM_JUMP_LEFT) ) {
         mFacingRight = false;
         if (!isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0)) {
             setActionMode("JUMP_LEFT", false);
@@ -208,29 +207,37 @@ void MisterX::moveLeft() {
         }
     } else {
         // if we have no vertical velocity make sure we are not in the jump animation
-        if (mVeloc.down == 0 && mVeloc.up == 0 && getActionMode().compare("WALK_LEFT") != 0) {
+        if (mVeloc.down == 0 && mVeloc.up == 0 && getActionModeID() != AM_WALK_LEFT) {
             setActionMode("WALK_LEFT", true);
         }
 
-        // step animation frame if enough time has passed and we're not pressed up against an object
-        if ( checkWalkTime() && !isCollision(ColType::CT_LEVEL, ColDirect::CD_LEFT, 1)) advanceFrame();
-
-        // increase velocity based on FPS calc to reach our per second goal
-        mVeloc.left += WALK_VELOCITY_PER / mSDL.lock()->getFPS();
+        // increase velocity by one tick's share of our per second goal
+        mVeloc.left += WALK_VELOCITY_PER * dt;
         if (mVeloc.left > WALK_MAX) mVeloc.left = WALK_MAX;
     }
 }
 
+// Steps the walking animation while walking. Run by the game loop's animation subsystem.
+void MisterX::animate() {
+    using namespace FuGlobals;
+
+    if (mDucking || mAttacking) return;
+
+    // step animation frame if enough time has passed and we're not pressed up against an object
+    if (mWalkingLeft && (getActionModeID() == AM_WALK_LEFT || getActionModeID() == AM_JUMP_LEFT)) {
+        if (checkWalkTime() && !isCollision(ColType::CT_LEVEL, ColDirect::CD_LEFT, 1)) advanceFrame();
+    } else if (mWalkingRight && (getActionModeID() == AM_WALK_RIGHT || getActionModeID() == AM_JUMP_RIGHT)) {
+        if (checkWalkTime() && !isCollision(ColType::CT_LEVEL, ColDirect::CD_RIGHT, 1)) advanceFrame();
+    }
+}
+
 // Return bool whethar enough time has passed to change walk animation. Resets timer on true result.
 bool MisterX::checkWalkTime() {
-    // we are walking - check if enough time has passed before taking a step
-    Uint32 currentTime{ SDL_GetTicks() };
-    if (currentTime - mLastAnimStep >= WALK_WAIT_TIME) {
-        mLastAnimStep = currentTime;
-        return true;
-    } else {
-        return false;
-    }
+    // we are walking - a step is allowed once the walk timer has fired, then start it again for the next step
+    if (!mWalkStepReady) return false;
+
+    setFlagAfter(WALK_WAIT_TIME, mWalkStepReady);
+    return true;
 }
 
 // Adjust the player position back inside the level if an out of bounds location has been detected.
@@ -258,10 +265,10 @@ void MisterX::jump() {
     // only launch into a jump if we have something to launch off of
     if (isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0)) {
         // check if we are already in the jump animation. Which means we are just landing not taking off
-        if ( getActionMode().compare("JUMP_RIGHT") == 0 ) {
+        if ( getActionModeID() == AM_JUMP_RIGHT ) {
             setActionMode("WALK_RIGHT", true);
             mJumping = false;
-        } else if ( getActionMode().compare("JUMP_LEFT") == 0 ) {
+        } else if ( getActionModeID() == AM_JUMP_LEFT ) {
             setActionMode("WALK_LEFT", true);
             mJumping = false;
         } else {
@@ -275,8 +282,6 @@ void MisterX::jump() {
             // increase our upward velocity
             mVeloc.down = 0;
             mVeloc.up = JUMP_VELOCITY; 
-            //***DEBUG*** need to adjust above to be FPS based so jump height doesn't change depending on performance! Like moveRight and moveLeft
-            // ... work's if framerate is capped at 120fps but on a slow device that can't make 120fps jump height will be smaller
         }
     }
 }
@@ -289,12 +294,12 @@ void MisterX::punch() {
 
     // If start of punch action set our attack start time and play sound effect
     if (getActionMode().find("PUNCH_") != 0) {
-        mSDL.lock()->playSoundEffect("MRX_PUNCH");
-        mAttackTime = SDL_GetTicks();
+        mSDL.lock()->queueSoundEffect("MRX_PUNCH");
+        setFlagAfter(ATTACK_TIME, mAttackOver);
     }
     
     // if not in punch mode yet pick correct punch mode
-    switch (hash( getActionMode().c_str() )) {
+    switch (getActionModeID()) {
         case (hash("DUCK_RIGHT")):
             setActionMode("PUNCH_DUCK_RIGHT", false);
             break;
@@ -315,9 +320,8 @@ void MisterX::punch() {
             break;
     }
 
-    // stay in punch mode animation until ATTACK_TIME has passed
-    Uint32 time{ SDL_GetTicks() - mAttackTime };
-    if ((time) >= ATTACK_TIME) {
+    // stay in punch mode animation until the attack timer has fired
+    if (mAttackOver) {
         revertLastActionMode();
         mPunching = false;
         mAttacking = false;
@@ -333,11 +337,11 @@ void MisterX::kick() {
 
     // If start of kick action set our attack start time and play sound effect
     if (getActionMode().find("KICK_") == std::string::npos) {
-        mSDL.lock()->playSoundEffect("MRX_KICK");
-        mAttackTime = SDL_GetTicks();
+        mSDL.lock()->queueSoundEffect("MRX_KICK");
+        setFlagAfter(ATTACK_TIME, mAttackOver);
 
         // choose correct action mode
-        switch (hash(getActionMode().c_str())) {
+        switch (getActionModeID()) {
             case (hash("DUCK_RIGHT")):
                 setActionMode("KICK_DUCK_RIGHT", false);
                 break;
@@ -358,9 +362,8 @@ void MisterX::kick() {
                 break;
         }
     }
-    // stay in kick mode animation until ATTACK_TIME has passed
-    Uint32 time{ SDL_GetTicks() - mAttackTime };
-    if ((time) >= ATTACK_TIME) {
+    // stay in kick mode animation until the attack timer has fired
+    if (mAttackOver) {
         revertLastActionMode();
         mKicking = false;
         mAttacking = false;
@@ -413,22 +416,21 @@ void MisterX::processAttack() {
     //***DEBUG***
     if constexpr (FuGlobals::DEBUG_MODE) {
         if (mAttackDmgDone) {        
-            std::cout << "Colliding with sprite: " << colSprite.lock()->getName() << "\n";
-            std::cout << "mPunching: " << std::boolalpha << mPunching << "\n";
-            std::cout << "mKicking: " << std::boolalpha << mKicking << "\n";
-            std::cout << std::endl;
+            Log::debug("Colliding with sprite: {}, mPunching: {}, mKicking: {}", colSprite.lock()->getName(), mPunching, mKicking);
         }
     }
 }
 
 // Moves player based on velocities adjusting for gravity, friction, and collisions. Extends then calls the Sprite class
-// default move function for a few custom player effects like respecting level boundries that other sprites do not need to do.
-void MisterX::move() {
+// default move function for a few custom player effects like respecting level boundries that other sprites do not need to do. dt is the tick length in seconds.
+void MisterX::move(decimal dt) {
+    ProfileZone zone{ "MisterX::move" };
+
     jump();                 // Handle any jumping
     
-    moveLeft();             // Handle any requests to move left
+    moveLeft(dt);           // Handle any requests to move left
 
-    moveRight();            // Handle any requests to move right
+    moveRight(dt);          // Handle any requests to move right
 
     duck();                 // Handle any requests to duck
 
@@ -436,7 +438,7 @@ void MisterX::move() {
 
     kick();                 // Handle any requests to kick
 
-    Sprite::move();         // call Sprite move function to perform actual movement based on our velocities, handling collision detection, etc
+    Sprite::move(dt);       // call Sprite move function to perform actual movement based on our velocities, handling collision detection, etc
 
     adjustForLevelBounds(); // Check player hasn't exceeded level bounds. Sprite class doesn't do this for us as other Sprites can leave level bounds.
 
@@ -7,11 +7,11 @@
 class MisterX : public Sprite {
 
 public:
-	static constexpr decimal	WALK_VELOCITY_PER	{ 100 };		// Walk velocity increase per real world second. Higher than WALK_MAX to overcome global friction constants.
-	static constexpr decimal	WALK_MAX			{ 5 };			// Maximum velocity can walk per real world second
-	static constexpr Uint32		WALK_WAIT_TIME		{ 250 };		// Milliseconds between change of animation 
-	static constexpr decimal	JUMP_VELOCITY		{ 8.5 };		// Initial force a sprite generates to start a jump in pixels per second
-	static constexpr Uint32		ATTACK_TIME			{ 100 };		// Milliseconds to hold an attack animation on screen before returning to former animation
+	static constexpr decimal	WALK_VELOCITY_PER	{ 12500 };		// Walk velocity increase in pixels/second per real world second. Higher than WALK_MAX to overcome global friction constants.
+	static constexpr decimal	WALK_MAX			{ 625 };		// Maximum walking velocity in pixels per second
+	static constexpr Uint32		WALK_WAIT_TIME		{ 250 };		// Simulation milliseconds between change of animation 
+	static constexpr decimal	JUMP_VELOCITY		{ 1062.5 };		// Initial upward velocity a sprite starts a jump with in pixels per second
+	static constexpr Uint32		ATTACK_TIME			{ 100 };		// Simulation milliseconds to hold an attack animation on screen before returning to former animation
 	static constexpr int		ATTACK_DMG_PUNCH	{ 10 };			// Damage to opponent health from a punch attack
 	static constexpr int		ATTACK_DMG_KICK		{ 10 };			// Damage to opponent health from a kick attack
 
@@ -28,8 +28,11 @@ public:
 	void handleInputGamepad(const SDL_ControllerButtonEvent e, bool press);
 
 	// Moves player based on velocities adjusting for gravity, friction, and collisions. Overrides the Sprite class default move function
-	// for a few custom player effects like respecting level boundries that other sprites do not need to do.
-	void move();
+	// for a few custom player effects like respecting level boundries that other sprites do not need to do. dt is the tick length in seconds.
+	void move(decimal dt) override;
+
+	// Steps the walking animation while walking. Run by the game loop's animation subsystem.
+	void animate() override;
 
 private:
 	// If we are actively walking left. Used for all animations, as well as walking, to indicate direction.
@@ -53,17 +56,17 @@ private:
 	// indicates if an attack key has been released. Prevents player from just holding down button and having a turbo attack.
 	bool mAttackReleased{ true };
 
-	// Holds the SDL ticks the last time an animation frame changed for the walking action
-	Uint32 mLastAnimStep{};
+	// Set by the walk timer once WALK_WAIT_TIME has passed since the last walking animation frame change
+	bool mWalkStepReady{ true };
 
-	// Holds the SDL ticks the time that an attack started
-	Uint32 mAttackTime{};
+	// Set by the attack timer once ATTACK_TIME has passed since an attack started
+	bool mAttackOver{ false };
 
-	// Handles the player requesting to move to the right.
-	void moveRight();
+	// Handles the player requesting to move to the right. dt is the tick length in seconds.
+	void moveRight(decimal dt);
 
-	// Handles the player requesting to move to the right.
-	void moveLeft();
+	// Handles the player requesting to move to the left. dt is the tick length in seconds.
+	void moveLeft(decimal dt);
 
 	// Handles the player jumping
 	void jump();
@@ -0,0 +1,122 @@
+#include "PerfHeatmap.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+// Starts over with cells covering a level of the given pixel size.
+void PerfHeatmap::reset(SDL_Point levelSize) {
+	using FuGlobals::HEATMAP_CELL;
+
+	mLevelSize = levelSize;
+	mCols = (levelSize.x + HEATMAP_CELL - 1) / HEATMAP_CELL;
+	mRows = (levelSize.y + HEATMAP_CELL - 1) / HEATMAP_CELL;
+	mCells.assign(static_cast<std::size_t>(mCols) * mRows, Cell{});
+}
+
+// Adds a tick's time in milliseconds at the given level position. Simulation side only.
+void PerfHeatmap::addTick(decimal x, decimal y, decimal ms) {
+	Cell* cell{ getCell(x, y) };
+	if (!cell) return;
+
+	++cell->ticks;
+	cell->tickSum += static_cast<float>(ms);
+	cell->tickMax = std::max(cell->tickMax, static_cast<float>(ms));
+}
+
+// Adds a frame's time in milliseconds at the given level position. Render side only.
+void PerfHeatmap::addFrame(decimal x, decimal y, decimal ms) {
+	Cell* cell{ getCell(x, y) };
+	if (!cell) return;
+
+	++cell->frames;
+	cell->frameSum += static_cast<float>(ms);
+	cell->frameMax = std::max(cell->frameMax, static_cast<float>(ms));
+}
+
+// Writes <name>.csv and <name>.png. Returns false if either can't be written.
+bool PerfHeatmap::save(std::string name) {
+	bool success{ true };
+	if (!saveCSV(name + ".csv")) success = false;
+	if (!saveImage(name + ".png")) success = false;
+	return success;
+}
+
+// Outputs the object information represented as a string
+std::string PerfHeatmap::toString() {
+	int visited{ 0 };
+	for (const Cell& c : mCells) if (c.ticks > 0 || c.frames > 0) ++visited;
+
+	std::ostringstream str{};
+	str << "PerfHeatmap::Level: " << mLevelSize.x << "x" << mLevelSize.y << ", Cells: " << mCols << "x" << mRows << ", Visited: " << visited << "\n";
+	return str.str();
+}
+
+// Returns the cell holding a level position, or nullptr outside the level.
+PerfHeatmap::Cell* PerfHeatmap::getCell(decimal x, decimal y) {
+	if (x < 0 || y < 0 || x >= mLevelSize.x || y >= mLevelSize.y) return nullptr;
+
+	int col{ static_cast<int>(x) / FuGlobals::HEATMAP_CELL };
+	int row{ static_cast<int>(y) / FuGlobals::HEATMAP_CELL };
+	return &mCells[static_cast<std::size_t>(row) * mCols + col];
+}
+
+// Writes the CSV file. Returns false if it can't be written.
+bool PerfHeatmap::saveCSV(std::string fileName) {
+	std::ofstream out{ fileName };
+	if (!out) {
+		std::cerr << "Failed in PerfHeatmap::saveCSV. Could not open \"" << fileName << "\"." << std::endl;
+		return false;
+	}
+
+	out << "x,y,w,h,ticks,tick_mean_ms,tick_max_ms,frames,frame_mean_ms,frame_max_ms\n";
+	for (int row{ 0 }; row < mRows; ++row) {
+		for (int col{ 0 }; col < mCols; ++col) {
+			const Cell& c{ mCells[static_cast<std::size_t>(row) * mCols + col] };
+			if (c.ticks == 0 && c.frames == 0) continue;
+
+			out << col * FuGlobals::HEATMAP_CELL << "," << row * FuGlobals::HEATMAP_CELL << "," << FuGlobals::HEATMAP_CELL << "," << FuGlobals::HEATMAP_CELL << ",";
+			out << c.ticks << "," << (c.ticks > 0 ? c.tickSum / c.ticks : 0) << "," << c.tickMax << ",";
+			out << c.frames << "," << (c.frames > 0 ? c.frameSum / c.frames : 0) << "," << c.frameMax << "\n";
+		}
+	}
+
+	return out.good();
+}
+
+// Writes the PNG file. Returns false if it can't be written.
+bool PerfHeatmap::saveImage(std::string fileName) {
+	if (mLevelSize.x <= 0 || mLevelSize.y <= 0) return false;
+
+	SDL_Surface* image{ SDL_CreateRGBSurfaceWithFormat(0, mLevelSize.x, mLevelSize.y, 32, SDL_PIXELFORMAT_RGBA32) };
+	if (!image) {
+		std::cerr << "Failed in PerfHeatmap::saveImage trying to create a surface. SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	SDL_FillRect(image, nullptr, SDL_MapRGBA(image->format, 0, 0, 0, 0));
+
+	// colour by mean frame time, or tick time when headless runs have no frames
+	auto cost{ [](const Cell& c) { return c.frames > 0 ? c.frameSum / c.frames : (c.ticks > 0 ? c.tickSum / c.ticks : 0.0f); } };
+	float maxCost{ 0 };
+	for (const Cell& c : mCells) maxCost = std::max(maxCost, cost(c));
+
+	for (int row{ 0 }; row < mRows; ++row) {
+		for (int col{ 0 }; col < mCols; ++col) {
+			const Cell& c{ mCells[static_cast<std::size_t>(row) * mCols + col] };
+			if (c.ticks == 0 && c.frames == 0) continue;
+
+			float t{ maxCost > 0 ? cost(c) / maxCost : 0 };
+			Uint8 red{ static_cast<Uint8>(255 * t) };
+			Uint8 blue{ static_cast<Uint8>(255 * (1 - t)) };
+			SDL_Rect r{ col * FuGlobals::HEATMAP_CELL, row * FuGlobals::HEATMAP_CELL, FuGlobals::HEATMAP_CELL, FuGlobals::HEATMAP_CELL };
+			SDL_FillRect(image, &r, SDL_MapRGBA(image->format, red, 0, blue, 160));
+		}
+	}
+
+	bool success{ IMG_SavePNG(image, fileName.c_str()) == 0 };
+	if (!success) std::cerr << "Failed in PerfHeatmap::saveImage trying to write \"" << fileName << "\". SDL_Image Error: " << IMG_GetError() << std::endl;
+	SDL_FreeSurface(image);
+
+	return success;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/* PerfHeatmap - Tick and frame cost bucketed by where the player is in the level
+ *
+ * Owned by GameLoop and sized to the level background when a level loads. The level is split into
+ * cells HEATMAP_CELL pixels square. Each simulation tick adds its time to the cell the player ended the
+ * tick in and each presented frame adds its time to the cell the player was drawn in, keeping a count,
+ * sum and max per cell.
+ *
+ * save() writes two files for level designers:
+ *     <name>.csv  one row per visited cell: its level pixel position, tick and frame counts, mean and max ms
+ *     <name>.png  an image the size of the level background with each visited cell coloured from blue (cheap)
+ *                 to red (the most expensive cell) by mean frame time, transparent where the player never
+ *                 went. Lay it over the level background to see which geometry and sprite placements cost.
+ *
+ * Ticks are only added from the simulation side and frames only from the render side so neither needs a
+ * lock. Call save() once both have stopped.
+ */
+class PerfHeatmap {
+
+public:
+	// Starts over with cells covering a level of the given pixel size.
+	void reset(SDL_Point levelSize);
+
+	// Adds a tick's time in milliseconds at the given level position. Simulation side only.
+	void addTick(decimal x, decimal y, decimal ms);
+
+	// Adds a frame's time in milliseconds at the given level position. Render side only.
+	void addFrame(decimal x, decimal y, decimal ms);
+
+	// Writes <name>.csv and <name>.png. Returns false if either can't be written.
+	bool save(std::string name);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Cost gathered in one cell
+	struct Cell {
+		Uint32 ticks{ 0 };
+		Uint32 frames{ 0 };
+		float tickSum{ 0 };
+		float tickMax{ 0 };
+		float frameSum{ 0 };
+		float frameMax{ 0 };
+	};
+
+	// Level size in pixels and in cells
+	SDL_Point mLevelSize{};
+	int mCols{ 0 };
+	int mRows{ 0 };
+
+	// Cells row by row
+	std::vector<Cell> mCells{};
+
+	// Returns the cell holding a level position, or nullptr outside the level.
+	Cell* getCell(decimal x, decimal y);
+
+	// Writes the CSV file. Returns false if it can't be written.
+	bool saveCSV(std::string fileName);
+
+	// Writes the PNG file. Returns false if it can't be written.
+	bool saveImage(std::string fileName);
+};
@@ -0,0 +1,167 @@
+#include "PerfOverlay.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include <cstdio>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+
+// Constructor takes the SDLMan to draw with and the frame budget in milliseconds. Graphs are scaled to twice the budget.
+PerfOverlay::PerfOverlay(std::weak_ptr<SDLMan> sdl, decimal budgetMS) : mAtlas{ sdl } {
+	mSDL = sdl;
+	mBudgetMS = budgetMS;
+	mGraphMS = budgetMS * 2;
+}
+
+// Builds the glyph atlas from FuGlobals::OVERLAY_FONT. Returns false if it can't be built.
+bool PerfOverlay::load() {
+	// look next to the executable first, then in the working directory like the rest of the game's data
+	std::string fontFile{ FuGlobals::OVERLAY_FONT };
+	char* basePath{ SDL_GetBasePath() };
+	if (basePath) {
+		std::string nextToExe{ std::string{ basePath } + fontFile };
+		SDL_free(basePath);
+		if (std::ifstream{ nextToExe }) fontFile = nextToExe;
+	}
+
+	return mAtlas.load(fontFile, FuGlobals::OVERLAY_FONT_SIZE, LINES * LINE_CHARS + 16);
+}
+
+// Shows or hides the overlay.
+void PerfOverlay::toggle() {
+	mVisible = !mVisible;
+
+	// start the rates over rather than averaging across the time we were hidden
+	mLastTextCounter = 0;
+}
+
+// Returns true while the overlay is shown.
+bool PerfOverlay::isVisible() {
+	return mVisible;
+}
+
+// Draws the overlay if visible. simStats is the simulation tick series, tick the simulation tick being shown.
+void PerfOverlay::render(FrameStats& simStats, Uint64 tick) {
+	if (!mVisible) return;
+	ProfileZone zone{ "PerfOverlay::render" };
+
+	Uint64 start{ SDL_GetPerformanceCounter() };
+	Uint64 freq{ SDL_GetPerformanceFrequency() };
+	SDLMan& sdl{ *mSDL.lock() };
+
+	// sample this frame for the graphs
+	mFrameMS[mNext] = static_cast<float>(sdl.getFrameStats().getLast());
+	mTickMS[mNext] = static_cast<float>(simStats.getLast());
+	mNext = (mNext + 1) % GRAPH_SAMPLES;
+
+	++mFramesSinceText;
+	decimal sinceText{ mLastTextCounter == 0 ? 0 : (start - mLastTextCounter) * 1000.0 / freq };
+	if (mLastTextCounter == 0 || sinceText >= TEXT_MS) updateText(simStats, tick, sinceText);
+
+	// panel in the top right corner, clear of the health bar
+	int lineH{ mAtlas.getLineHeight() };
+	int panelW{ GRAPH_SAMPLES * BAR_W + MARGIN * 2 };
+	int panelH{ MARGIN * 4 + lineH * (LINES + 2) + GRAPH_H * 2 };
+	int x{ FuGlobals::VIEWPORT_WIDTH - panelW - 10 };
+	int y{ 10 };
+	sdl.setDrawColor(0, 0, 0, 160);
+	sdl.drawFillRect(x, y, panelW, panelH);
+
+	// text lines then a label and graph for frames and for ticks
+	SDL_Color textColor{ 255, 255, 255, 255 };
+	int textX{ x + MARGIN };
+	int textY{ y + MARGIN };
+	for (int i{ 0 }; i < LINES; ++i) {
+		mAtlas.queueText(textX, textY, mLines[i], textColor);
+		textY += lineH;
+	}
+
+	textY += MARGIN;
+	mAtlas.queueText(textX, textY, "frame ms", SDL_Color{ 120, 255, 120, 255 });
+	textY += lineH;
+	drawGraph(sdl, textX, textY, mFrameMS, true);
+
+	textY += GRAPH_H + MARGIN;
+	mAtlas.queueText(textX, textY, "sim tick ms", SDL_Color{ 120, 200, 255, 255 });
+	textY += lineH;
+	drawGraph(sdl, textX, textY, mTickMS, false);
+
+	mAtlas.flush();
+
+	// what this took, shown on the next text update
+	decimal cost{ (SDL_GetPerformanceCounter() - start) * 1000.0 / freq };
+	mCostMS = mCostMS == 0 ? cost : mCostMS * 0.95 + cost * 0.05;
+}
+
+// Outputs the object information represented as a string
+std::string PerfOverlay::toString() {
+	std::ostringstream str{};
+	str << "PerfOverlay::Visible: " << mVisible << ", Cost: " << mCostMS << " ms\n";
+	str << mAtlas.toString();
+	return str.str();
+}
+
+// Reformats the text lines from the current statistics.
+void PerfOverlay::updateText(FrameStats& simStats, Uint64 tick, decimal elapsedMS) {
+	SDLMan& sdl{ *mSDL.lock() };
+	FrameStats::Summary frame{ sdl.getFrameStats().getSummary() };
+	FrameStats::Summary sim{ simStats.getSummary() };
+
+	Sint64 ticks{ Metrics::getTotal(Metric::MT_TICKS) };
+	Sint64 queries{ Metrics::getTotal(Metric::MT_COLLISION_QUERIES) };
+	Sint64 copies{ Metrics::getTotal(Metric::MT_RENDER_COPIES) };
+
+	// rates over the time since the last update. The first update after showing has nothing to compare with.
+	decimal ticksPerSec{ 0 }, queriesPerTick{ 0 }, copiesPerFrame{ 0 };
+	if (elapsedMS > 0) {
+		ticksPerSec = (ticks - mLastTicks) * 1000.0 / elapsedMS;
+		if (ticks > mLastTicks) queriesPerTick = static_cast<decimal>(queries - mLastQueries) / (ticks - mLastTicks);
+		if (mFramesSinceText > 0) copiesPerFrame = static_cast<decimal>(copies - mLastCopies) / mFramesSinceText;
+	}
+
+	std::snprintf(mLines[0], LINE_CHARS, "FPS %.1f  frame %.2f  p99 %.2f ms", sdl.getFPS(), frame.mean, frame.p99);
+	std::snprintf(mLines[1], LINE_CHARS, "sim %.3f  p99 %.3f ms  %.0f ticks/s", sim.mean, sim.p99, ticksPerSec);
+	std::snprintf(mLines[2], LINE_CHARS, "tick %llu  sprites %lld/%lld  coll/tick %.1f", static_cast<unsigned long long>(tick),
+		static_cast<long long>(Metrics::getTotal(Metric::MT_SPRITES_VISIBLE)), static_cast<long long>(Metrics::getTotal(Metric::MT_SPRITES_ACTIVE)), queriesPerTick);
+	std::snprintf(mLines[3], LINE_CHARS, "draws/frame %.1f  overlay %.3f ms", copiesPerFrame, mCostMS);
+
+	mLastTextCounter = SDL_GetPerformanceCounter();
+	mFramesSinceText = 0;
+	mLastTicks = ticks;
+	mLastQueries = queries;
+	mLastCopies = copies;
+}
+
+// Draws a bar graph of the given samples with its top left at x, y. Bars longer than the budget are red when markBudget is set.
+void PerfOverlay::drawGraph(SDLMan& sdl, int x, int y, const float* samples, bool markBudget) {
+	int bars{ 0 }, overBars{ 0 };
+
+	// oldest sample on the left
+	for (int i{ 0 }; i < GRAPH_SAMPLES; ++i) {
+		float ms{ samples[(mNext + i) % GRAPH_SAMPLES] };
+		int h{ static_cast<int>(std::min<decimal>(ms / mGraphMS, 1.0) * GRAPH_H) };
+		if (h < 1) h = 1;
+
+		SDL_Rect bar{ x + i * BAR_W, y + GRAPH_H - h, BAR_W, h };
+		if (markBudget && ms > mBudgetMS) mOverBars[overBars++] = bar;
+		else mBars[bars++] = bar;
+	}
+
+	SDL_Renderer* renderer{ sdl.getRenderer() };
+	if (markBudget) sdl.setDrawColor(120, 255, 120, 220);
+	else sdl.setDrawColor(120, 200, 255, 220);
+	SDL_RenderFillRects(renderer, mBars, bars);
+
+	if (overBars > 0) {
+		sdl.setDrawColor(255, 80, 80, 220);
+		SDL_RenderFillRects(renderer, mOverBars, overBars);
+	}
+
+	// line across at the budget
+	if (markBudget) {
+		int budgetY{ y + GRAPH_H - static_cast<int>(mBudgetMS / mGraphMS * GRAPH_H) };
+		sdl.setDrawColor(255, 255, 255, 120);
+		SDL_RenderDrawLine(renderer, x, budgetY, x + GRAPH_SAMPLES * BAR_W, budgetY);
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SDLMan.h"
+#include "GlyphAtlas.h"
+#include "FrameStats.h"
+#include <SDL.h>
+#include <string>
+#include <memory>
+
+/* PerfOverlay - In game performance readout drawn over the HUD
+ *
+ * Owned by GameLoop and drawn after the level and HUD each frame while visible (F3 toggles it). Shows
+ * frame rate, frame and simulation tick times with their p99, ticks per second, active and visible
+ * sprites, collision queries per tick, draw calls per frame and what the overlay itself costs, above
+ * bar graphs of the last GRAPH_SAMPLES frame and tick times. Bars over the frame budget are drawn red.
+ *
+ * Text comes from a GlyphAtlas so a frame is a handful of draw calls: the panel, one SDL_RenderFillRects
+ * per bar colour and a single geometry call for all the text (a copy per glyph on SDL older than 2.0.18). Numbers are formatted into fixed buffers
+ * every TEXT_MS rather than every frame, which keeps them readable and means the overlay doesn't allocate.
+ */
+class PerfOverlay {
+
+public:
+	static constexpr int		GRAPH_SAMPLES	{ 120 };	// Frames shown in each graph
+	static constexpr int		BAR_W			{ 3 };		// Pixel width of a graph bar
+	static constexpr int		GRAPH_H			{ 40 };		// Pixel height of a graph
+	static constexpr int		LINES			{ 4 };		// Lines of text
+	static constexpr int		LINE_CHARS		{ 64 };		// Longest line of text
+	static constexpr int		MARGIN			{ 6 };		// Pixels between the panel edge and its contents
+	static constexpr Uint32		TEXT_MS			{ 250 };	// Milliseconds between text updates
+
+	// Constructor takes the SDLMan to draw with and the frame budget in milliseconds. Graphs are scaled to twice the budget.
+	PerfOverlay(std::weak_ptr<SDLMan> sdl, decimal budgetMS);
+	PerfOverlay() = delete;
+
+	// Builds the glyph atlas from FuGlobals::OVERLAY_FONT. Returns false if it can't be built.
+	bool load();
+
+	// Shows or hides the overlay.
+	void toggle();
+
+	// Returns true while the overlay is shown.
+	bool isVisible();
+
+	// Draws the overlay if visible. simStats is the simulation tick series, tick the simulation tick being shown.
+	void render(FrameStats& simStats, Uint64 tick);
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// SDLMan we draw with
+	std::weak_ptr<SDLMan> mSDL{};
+
+	// Cached glyphs the text is drawn from
+	GlyphAtlas mAtlas;
+
+	// Frame budget and the time at the top of the graphs in milliseconds
+	decimal mBudgetMS{};
+	decimal mGraphMS{};
+
+	// Shown or hidden
+	bool mVisible{ false };
+
+	// Last GRAPH_SAMPLES frame and tick times and where the next goes
+	float mFrameMS[GRAPH_SAMPLES]{};
+	float mTickMS[GRAPH_SAMPLES]{};
+	int mNext{ 0 };
+
+	// Graph bars built each frame, split into under and over budget
+	SDL_Rect mBars[GRAPH_SAMPLES]{};
+	SDL_Rect mOverBars[GRAPH_SAMPLES]{};
+
+	// Formatted text and the counters it was last updated from
+	char mLines[LINES][LINE_CHARS]{};
+	Uint64 mLastTextCounter{ 0 };
+	Uint64 mFramesSinceText{ 0 };
+	Sint64 mLastTicks{ 0 };
+	Sint64 mLastQueries{ 0 };
+	Sint64 mLastCopies{ 0 };
+
+	// Moving average of the overlay's own cost in milliseconds
+	decimal mCostMS{ 0 };
+
+	// Reformats the text lines from the current statistics.
+	void updateText(FrameStats& simStats, Uint64 tick, decimal elapsedMS);
+
+	// Draws a bar graph of the given samples with its top left at x, y. Bars longer than the budget are red when markBudget is set.
+	void drawGraph(SDLMan& sdl, int x, int y, const float* samples, bool markBudget);
+};
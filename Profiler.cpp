@@ -0,0 +1,103 @@
+#include "Profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::sBuffers{};
+std::mutex Profiler::sMutex{};
+
+// Records a finished zone on the calling thread. start and end are SDL performance counter values.
+void Profiler::record(const char* name, Uint64 start, Uint64 end) {
+	ThreadBuffer& buffer{ getBuffer() };
+
+	Uint64 count{ buffer.count.load(std::memory_order_relaxed) };
+	buffer.zones[count % RING_SIZE] = Zone{ name, start, end };
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+// Names the calling thread in the trace output.
+void Profiler::setThreadName(const char* name) {
+	if constexpr (FuGlobals::PROFILE) getBuffer().name = name;
+}
+
+// Writes all recorded zones as Chrome trace event JSON to the given file. Safe to call while other threads record. Returns false if the file can't be written.
+bool Profiler::dumpTrace(const std::string& filename) {
+	std::ofstream out{ filename };
+	if (!out) {
+		std::cerr << "Failed in Profiler::dumpTrace. Could not open trace file for writing: " << filename << std::endl;
+		return false;
+	}
+
+	double usPerCount{ 1000000.0 / SDL_GetPerformanceFrequency() };
+	bool first{ true };
+	size_t written{ 0 };
+
+	// counter values in microseconds run to ten or more digits, so write them in full to the nearest nanosecond
+	out << std::fixed << std::setprecision(3);
+	out << "{\"traceEvents\":[\n";
+
+	std::lock_guard<std::mutex> lock{ sMutex };
+	for (const std::unique_ptr<ThreadBuffer>& buffer : sBuffers) {
+		// thread name metadata so the viewer labels each track
+		if (!first) out << ",\n";
+		first = false;
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+		writeEscaped(out, buffer->name);
+		out << "\"}}";
+
+		// the newest RING_SIZE zones are in the ring. Leave a margin at the old end which a running thread may be writing over.
+		Uint64 count{ buffer->count.load(std::memory_order_acquire) };
+		Uint64 begin{ count > static_cast<Uint64>(RING_SIZE - DUMP_MARGIN) ? count - (RING_SIZE - DUMP_MARGIN) : 0 };
+
+		for (Uint64 i{ begin }; i < count; ++i) {
+			const Zone& z{ buffer->zones[i % RING_SIZE] };
+			out << ",\n{\"name\":\"";
+			writeEscaped(out, z.name);
+			out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id;
+			out << ",\"ts\":" << z.start * usPerCount << ",\"dur\":" << (z.end - z.start) * usPerCount << "}";
+			++written;
+		}
+	}
+
+	out << "\n]}\n";
+
+	if constexpr (FuGlobals::DEBUG_MODE) std::cout << "Profiler::Wrote " << written << " zones to " << filename << std::endl;
+	return out.good();
+}
+
+// Returns the calling thread's buffer, registering one on first use.
+Profiler::ThreadBuffer& Profiler::getBuffer() {
+	thread_local ThreadBuffer* tBuffer{ nullptr };
+
+	if (!tBuffer) {
+		std::lock_guard<std::mutex> lock{ sMutex };
+		sBuffers.push_back(std::make_unique<ThreadBuffer>());
+		tBuffer = sBuffers.back().get();
+		tBuffer->id = static_cast<int>(sBuffers.size());
+		tBuffer->zones.resize(RING_SIZE);
+	}
+
+	return *tBuffer;
+}
+
+// Writes text to out as the contents of a JSON string, escaping quotes, backslashes and control characters.
+void Profiler::writeEscaped(std::ostream& out, const char* text) {
+	if (!text) return;
+	for (const char* c{ text }; *c; ++c) {
+		switch (*c) {
+			case '"':	out << "\\\""; break;
+			case '\\':	out << "\\\\"; break;
+			case '\n':	out << "\\n"; break;
+			case '\r':	out << "\\r"; break;
+			case '\t':	out << "\\t"; break;
+			default:
+				// any other control character as a \u escape
+				if (static_cast<unsigned char>(*c) < 0x20) {
+					static const char* HEX{ "0123456789abcdef" };
+					out << "\\u00" << HEX[(*c >> 4) & 0xf] << HEX[*c & 0xf];
+				} else {
+					out << *c;
+				}
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <ostream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+/* Profiler - Scoped CPU timing zones with Chrome trace export
+ *
+ * Put a ProfileZone on the stack at the top of a block to time it:
+ *     ProfileZone zone{ "Level::render" };
+ * The zone is recorded when it goes out of scope. Zone names must be string literals or otherwise
+ * outlive the profiler as only the pointer is kept.
+ *
+ * Each thread writes to its own ring buffer of the last RING_SIZE zones so recording never takes a lock.
+ * dumpTrace() writes every buffer out as Chrome trace event JSON which chrome://tracing and
+ * ui.perfetto.dev can open. Zones on a thread nest by time so the viewer shows the call hierarchy.
+ *
+ * With FuGlobals::PROFILE off every ProfileZone member function is an empty inline and the compiler
+ * removes them entirely.
+ */
+class Profiler {
+
+public:
+	static constexpr int RING_SIZE{ 1 << 16 };	// Zones kept per thread
+	static constexpr int DUMP_MARGIN{ 1024 };	// Oldest zones skipped when dumping a running thread as it may be overwriting them
+
+	// Records a finished zone on the calling thread. start and end are SDL performance counter values.
+	static void record(const char* name, Uint64 start, Uint64 end);
+
+	// Names the calling thread in the trace output.
+	static void setThreadName(const char* name);
+
+	// Writes all recorded zones as Chrome trace event JSON to the given file. Safe to call while other threads record. Returns false if the file can't be written.
+	static bool dumpTrace(const std::string& filename);
+
+private:
+	// One recorded zone
+	struct Zone {
+		const char* name{ nullptr };
+		Uint64 start{};
+		Uint64 end{};
+	};
+
+	// Ring buffer of one thread's zones. Only the owning thread writes.
+	struct ThreadBuffer {
+		int id{};
+		const char* name{ "Thread" };
+		std::vector<Zone> zones{};
+		std::atomic<Uint64> count{ 0 };
+	};
+
+	// All thread buffers. Buffers live until the program ends so a dump can read threads that have finished.
+	static std::vector<std::unique_ptr<ThreadBuffer>> sBuffers;
+
+	// Guards sBuffers while a thread registers or a dump walks it.
+	static std::mutex sMutex;
+
+	// Returns the calling thread's buffer, registering one on first use.
+	static ThreadBuffer& getBuffer();
+
+	// Writes text to out as the contents of a JSON string, escaping quotes, backslashes and control characters.
+	static void writeEscaped(std::ostream& out, const char* text);
+};
+
+// Times the enclosing scope and records it with the Profiler. Compiles to nothing when FuGlobals::PROFILE is off.
+class ProfileZone {
+
+public:
+	ProfileZone(const char* name) {
+		if constexpr (FuGlobals::PROFILE) {
+			mName = name;
+			mStart = SDL_GetPerformanceCounter();
+		}
+	}
+
+	~ProfileZone() {
+		if constexpr (FuGlobals::PROFILE) Profiler::record(mName, mStart, SDL_GetPerformanceCounter());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* mName{ nullptr };
+	Uint64 mStart{ 0 };
+};
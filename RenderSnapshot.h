@@ -0,0 +1,32 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include "Texture.h"
+#include "Line.h"
+#include <SDL.h>
+#include <vector>
+
+// Everything needed to draw one Sprite, copied out of the simulation at the end of a tick.
+struct SpriteSnapshot {
+	Texture* texture{ nullptr };			// Sprite sheet. Owned by the Sprite which outlives any snapshot of it.
+	SDL_Rect clip{};						// Current animation frame on the sprite sheet
+	int scale{ 1 };							// Scaling factor applied to the clip when drawn
+	decimal tickX{ 0 }, tickY{ 0 };			// Position at the start of the tick. Render interpolates from here...
+	decimal x{ 0 }, y{ 0 };					// ...to the position at the end of the tick.
+	Line colBtm{}, colTop{}, colLeft{}, colRight{};	// Collision lines, level relative. Only drawn in debug mode.
+};
+
+// An immutable picture of the world published by the simulation once per tick and consumed by rendering.
+// Rendering reads only this (plus level data that never changes after load) so it can run on another thread.
+struct RenderSnapshot {
+	Uint64 tick{ 0 };						// Simulation tick this snapshot was taken after
+	Uint64 publishCounter{ 0 };				// SDL performance counter when published. Lets a render thread work out interpolation alpha.
+	std::vector<SpriteSnapshot> sprites{};	// Visible non-player sprites
+	SpriteSnapshot player{};				// The player, drawn last
+	decimal followTickX{ 0 }, followTickY{ 0 };	// Position the viewport follows at the start of the tick...
+	decimal followX{ 0 }, followY{ 0 };		// ...and at the end of the tick.
+	int playerHealth{ 0 };					// HUD values
+	int playerHealthMax{ 1 };
+	bool degraded{ false };					// Simulation was catching up. Skip optional drawing.
+	Uint32 inputTag{ 0 };					// Newest LatencyProbe input applied before this snapshot, 0 if none
+};
@@ -0,0 +1,229 @@
+#include "Replay.h"
+#include <iostream>
+#include <sstream>
+#include <iterator>
+
+// Constructor takes the path of the file to record to or play back from.
+Replay::Replay(std::string filename) {
+	mFilename = filename;
+}
+
+// Opens the file and writes the header. tickMS is the simulation tick length, playback refuses a file recorded with a different one.
+bool Replay::startRecording(Uint32 tickMS) {
+	mOut.open(mFilename, std::ios::binary | std::ios::trunc);
+	if (!mOut) {
+		std::cerr << "Failed in Replay::startRecording. Could not open replay file for writing: " << mFilename << std::endl;
+		return false;
+	}
+
+	mOut.write("KFXR", 4);
+	writeFixed(VERSION, 1);
+	writeFixed(tickMS, 4);
+	mLastTick = 0;
+
+	return true;
+}
+
+// Writes an input event applied on the given tick. Events other than keyboard and gamepad input are ignored.
+void Replay::recordEvent(Uint64 tick, const SDL_Event& e) {
+	if (!mOut.is_open()) return;
+
+	switch (e.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			writeRecordStart(tick, e.type == SDL_KEYDOWN ? RT_KEY_DOWN : RT_KEY_UP);
+			writeVarint(static_cast<Uint32>(e.key.keysym.sym));
+			break;
+
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP:
+			writeRecordStart(tick, e.type == SDL_CONTROLLERBUTTONDOWN ? RT_BUTTON_DOWN : RT_BUTTON_UP);
+			writeFixed(e.cbutton.button, 1);
+			break;
+
+		case SDL_CONTROLLERAXISMOTION:
+			writeRecordStart(tick, RT_AXIS);
+			writeFixed(e.caxis.axis, 1);
+			writeFixed(static_cast<Uint16>(e.caxis.value), 2);
+			break;
+	}
+}
+
+// Writes the end record with the total ticks run and the final world state hash then closes the file.
+bool Replay::finishRecording(Uint64 ticks, Uint64 hash) {
+	if (!mOut.is_open()) return false;
+
+	// a quit can arrive on a tick that never ran so don't let the final delta go backwards
+	writeRecordStart(ticks > mLastTick ? ticks : mLastTick, RT_END);
+	writeVarint(ticks);
+	writeFixed(hash, 8);
+	mOut.close();
+
+	if (mOut.fail()) {
+		std::cerr << "Failed in Replay::finishRecording. Error writing replay file: " << mFilename << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// Returns true between startRecording() and finishRecording().
+bool Replay::isRecording() {
+	return mOut.is_open();
+}
+
+// Loads a recording for playback. tickMS must match the tick length it was recorded with.
+bool Replay::load(Uint32 tickMS) {
+	std::ifstream file{ mFilename, std::ios::binary };
+	if (!file) {
+		std::cerr << "Failed in Replay::load. Could not open replay file: " << mFilename << std::endl;
+		return false;
+	}
+	std::vector<Uint8> buf{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	// check the header
+	size_t pos{ 0 };
+	Uint64 version{}, fileTickMS{};
+	if (buf.size() < 4 || std::string(buf.begin(), buf.begin() + 4) != "KFXR") {
+		std::cerr << "Failed in Replay::load. Not a replay file: " << mFilename << std::endl;
+		return false;
+	}
+	pos = 4;
+	if (!readFixed(buf, pos, 1, version) || version != VERSION || !readFixed(buf, pos, 4, fileTickMS)) {
+		std::cerr << "Failed in Replay::load. Unsupported replay version in: " << mFilename << std::endl;
+		return false;
+	}
+	if (fileTickMS != tickMS) {
+		std::cerr << "Failed in Replay::load. Replay was recorded with " << fileTickMS << "ms ticks but the game runs " << tickMS << "ms ticks." << std::endl;
+		return false;
+	}
+
+	mEvents.clear();
+	mNext = 0;
+	Uint64 tick{ 0 };
+
+	// read records until the end record
+	while (true) {
+		Uint64 value{}, delta{}, type{};
+		if (!readVarint(buf, pos, delta) || !readFixed(buf, pos, 1, type)) break;
+		tick += delta;
+
+		if (type == RT_END) {
+			if (!readVarint(buf, pos, mTicks) || !readFixed(buf, pos, 8, mHash)) break;
+			return true;
+		}
+
+		ReplayEvent re{};
+		re.tick = tick;
+		switch (type) {
+			case RT_KEY_DOWN:
+			case RT_KEY_UP:
+				if (!readVarint(buf, pos, value)) break;
+				re.event.type = (type == RT_KEY_DOWN) ? SDL_KEYDOWN : SDL_KEYUP;
+				re.event.key.state = (type == RT_KEY_DOWN) ? SDL_PRESSED : SDL_RELEASED;
+				re.event.key.keysym.sym = static_cast<SDL_Keycode>(static_cast<Uint32>(value));
+				break;
+
+			case RT_BUTTON_DOWN:
+			case RT_BUTTON_UP:
+				if (!readFixed(buf, pos, 1, value)) break;
+				re.event.type = (type == RT_BUTTON_DOWN) ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+				re.event.cbutton.state = (type == RT_BUTTON_DOWN) ? SDL_PRESSED : SDL_RELEASED;
+				re.event.cbutton.button = static_cast<Uint8>(value);
+				break;
+
+			case RT_AXIS:
+				if (!readFixed(buf, pos, 1, value)) break;
+				re.event.caxis.axis = static_cast<Uint8>(value);
+				if (!readFixed(buf, pos, 2, value)) break;
+				re.event.type = SDL_CONTROLLERAXISMOTION;
+				re.event.caxis.value = static_cast<Sint16>(static_cast<Uint16>(value));
+				break;
+
+			case RT_DEGRADED:
+				if (!readFixed(buf, pos, 1, value)) break;
+				re.event.type = DEGRADED_EVENT;
+				re.event.user.code = static_cast<Sint32>(value);
+				break;
+		}
+
+		// a record that failed to read leaves the event type unset
+		if (re.event.type == 0) break;
+		mEvents.push_back(re);
+	}
+
+	std::cerr << "Failed in Replay::load. Replay file is truncated or corrupt: " << mFilename << std::endl;
+	return false;
+}
+
+// Fills e with the next recorded event due on or before the given tick and returns true. Returns false when nothing more is due yet.
+bool Replay::pollEvent(Uint64 tick, SDL_Event& e) {
+	if (mNext >= mEvents.size() || mEvents[mNext].tick > tick) return false;
+
+	e = mEvents[mNext].event;
+	++mNext;
+	return true;
+}
+
+// Returns the total ticks of a loaded recording.
+Uint64 Replay::getTicks() {
+	return mTicks;
+}
+
+// Returns the final world state hash of a loaded recording.
+Uint64 Replay::getHash() {
+	return mHash;
+}
+
+// Outputs the object information represented as a string
+std::string Replay::toString() {
+	std::ostringstream str{};
+	str << "Replay::File: " << mFilename << ", Events: " << mEvents.size() << ", Ticks: " << mTicks << ", Hash: " << std::hex << mHash << std::dec << "\n";
+	return str.str();
+}
+
+// Writes the tick delta and type that start every record.
+void Replay::writeRecordStart(Uint64 tick, RecordType type) {
+	writeVarint(tick - mLastTick);
+	writeFixed(type, 1);
+	mLastTick = tick;
+}
+
+// Writes an unsigned value 7 bits per byte, high bit set on all but the last byte.
+void Replay::writeVarint(Uint64 value) {
+	while (value >= 0x80) {
+		mOut.put(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	mOut.put(static_cast<char>(value));
+}
+
+// Writes a value of the given byte count, little endian.
+void Replay::writeFixed(Uint64 value, int bytes) {
+	for (int i{ 0 }; i < bytes; ++i) {
+		mOut.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+// Reads a varint from the buffer at pos, advancing pos. Returns false if the buffer runs out.
+bool Replay::readVarint(const std::vector<Uint8>& buf, size_t& pos, Uint64& value) {
+	value = 0;
+	for (int shift{ 0 }; shift < 64; shift += 7) {
+		if (pos >= buf.size()) return false;
+		Uint8 byte{ buf[pos++] };
+		value |= static_cast<Uint64>(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+// Reads a little endian value of the given byte count from the buffer at pos, advancing pos. Returns false if the buffer runs out.
+bool Replay::readFixed(const std::vector<Uint8>& buf, size_t& pos, int bytes, Uint64& value) {
+	if (pos + bytes > buf.size()) return false;
+
+	value = 0;
+	for (int i{ 0 }; i < bytes; ++i) {
+		value |= static_cast<Uint64>(buf[pos++]) << (8 * i);
+	}
+	return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+/* Replay - Records player input to a compact binary file and plays it back
+ *
+ * Every input event that reaches the player is written with the simulation tick it was applied on.
+ * Since the simulation is fixed step and all timing is counted in ticks, feeding the same events in on
+ * the same ticks reproduces the run exactly. Playback needs no window or wall clock so it runs
+ * headless at full speed, which makes a recorded session a repeatable performance workload.
+ *
+ * Older recordings also hold changes to the game loop's degraded flag, from when it skipped AI. They
+ * come back from pollEvent() as DEGRADED_EVENT events with user.code set to the new value. The flag
+ * only skips drawing now so nothing new records it and playback ignores them.
+ *
+ * At the end of a recording the total tick count and a hash of the final world state are written so
+ * playback can check it ended up in the same place.
+ *
+ * File layout, all multi-byte values little endian:
+ *     header:  "KFXR", Uint8 version, Uint32 simulation tick length in milliseconds
+ *     records: varint ticks since the previous record, Uint8 record type, then the payload for that type
+ *                 key down/up: varint keycode | button down/up: Uint8 button | axis: Uint8 axis, Sint16 value | degraded: Uint8
+ *     end:     a record of end type with payload varint total ticks, Uint64 final state hash
+ */
+class Replay {
+
+public:
+	static constexpr Uint32	DEGRADED_EVENT	{ SDL_USEREVENT };	// Event type pollEvent() uses to hand back a change to the degraded flag
+	static constexpr Uint8	VERSION			{ 1 };				// File format version
+
+	// Constructor takes the path of the file to record to or play back from.
+	Replay(std::string filename);
+	Replay() = delete;
+
+	// Opens the file and writes the header. tickMS is the simulation tick length, playback refuses a file recorded with a different one.
+	bool startRecording(Uint32 tickMS);
+
+	// Writes an input event applied on the given tick. Events other than keyboard and gamepad input are ignored.
+	void recordEvent(Uint64 tick, const SDL_Event& e);
+
+	// Writes the end record with the total ticks run and the final world state hash then closes the file.
+	bool finishRecording(Uint64 ticks, Uint64 hash);
+
+	// Returns true between startRecording() and finishRecording().
+	bool isRecording();
+
+	// Loads a recording for playback. tickMS must match the tick length it was recorded with.
+	bool load(Uint32 tickMS);
+
+	// Fills e with the next recorded event due on or before the given tick and returns true. Returns false when nothing more is due yet.
+	bool pollEvent(Uint64 tick, SDL_Event& e);
+
+	// Returns the total ticks of a loaded recording.
+	Uint64 getTicks();
+
+	// Returns the final world state hash of a loaded recording.
+	Uint64 getHash();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Record types as stored in the file
+	enum RecordType : Uint8 {
+		RT_KEY_DOWN,
+		RT_KEY_UP,
+		RT_BUTTON_DOWN,
+		RT_BUTTON_UP,
+		RT_AXIS,
+		RT_DEGRADED,		// only in older recordings, read and ignored
+		RT_END = 255
+	};
+
+	// One loaded event and the tick it was applied on
+	struct ReplayEvent {
+		Uint64 tick{};
+		SDL_Event event{};
+	};
+
+	// Path to the replay file
+	std::string mFilename{};
+
+	// File being recorded to
+	std::ofstream mOut{};
+
+	// Tick of the last record written. Records store the distance from it to stay small.
+	Uint64 mLastTick{ 0 };
+
+	// Events of a loaded recording in tick order
+	std::vector<ReplayEvent> mEvents{};
+
+	// Index of the next loaded event to hand out
+	size_t mNext{ 0 };
+
+	// Total ticks of a loaded recording
+	Uint64 mTicks{ 0 };
+
+	// Final world state hash of a loaded recording
+	Uint64 mHash{ 0 };
+
+	// Writes the tick delta and type that start every record.
+	void writeRecordStart(Uint64 tick, RecordType type);
+
+	// Writes an unsigned value 7 bits per byte, high bit set on all but the last byte.
+	void writeVarint(Uint64 value);
+
+	// Writes a value of the given byte count, little endian.
+	void writeFixed(Uint64 value, int bytes);
+
+	// Reads a varint from the buffer at pos, advancing pos. Returns false if the buffer runs out.
+	static bool readVarint(const std::vector<Uint8>& buf, size_t& pos, Uint64& value);
+
+	// Reads a little endian value of the given byte count from the buffer at pos, advancing pos. Returns false if the buffer runs out.
+	static bool readFixed(const std::vector<Uint8>& buf, size_t& pos, int bytes, Uint64& value);
+};
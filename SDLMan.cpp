@@ -1,8 +1,13 @@
 #include "SDLMan.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <SDL_image.h>
+#include <SDL_ttf.h>
 #include <SDL_thread.h>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 // Constructor. Takes window caption string, bool to start with a fullscreen window, and width and height of starting window.
 // If not full screen and no width and height supplied then defaults to global VIEWPORT_W & VIEWPORT_H size.
@@ -15,7 +20,7 @@ SDLMan::SDLMan(std::string windowCaption, bool fullScreen, int width, int height
 
 // Destructor. Close down SDL.
 SDLMan::~SDLMan() {
-	if (DEBUG_MODE) std::cerr << "Destructor: SDLMan" << std::endl;
+	Log::debug("Destructor: SDLMan");
 
 	// Destroy buffer texture, renderer, and the window
 	SDL_DestroyRenderer(mRenderer);
@@ -36,6 +41,7 @@ SDLMan::~SDLMan() {
 	mSoundMap = nullptr;
 
 	// Quit SDL subsystems
+	TTF_Quit();
 	SDL_Quit();
 	IMG_Quit();
 	Mix_Quit();
@@ -43,8 +49,16 @@ SDLMan::~SDLMan() {
 
 // Initilizes SDL, creates the window and renderer but does not show the window until a call to showWindow is made. This must be called first before SDLMan will function.
 bool SDLMan::init() {
+	// Headless runs use SDL's dummy drivers so no display or sound device is needed. Textures still load so sprites get their real sizes.
+	if (mHeadless) {
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	}
+
 	// Attempt to initialize SDL returning false on failure and logging an error.
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) < 0) {
+	Uint32 sdlFlags{ SDL_INIT_VIDEO | SDL_INIT_AUDIO };
+	if (!mHeadless) sdlFlags = sdlFlags | SDL_INIT_GAMECONTROLLER;
+	if (SDL_Init(sdlFlags) < 0) {
 		std::cerr << "Failed in SDLMan::init: SDL could not initialize. SDL Error: \n" << SDL_GetError();
 		return false;
 	}
@@ -60,8 +74,11 @@ bool SDLMan::init() {
 		return false;
 	}
 	
-	// Create renderer for window (defaults to no vSync which can later be turned on with setVSync).
-	mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED);
+	// Create renderer for window (defaults to no vSync which can be turned on with setVSync before calling init).
+	Uint32 rendererFlags{ SDL_RENDERER_ACCELERATED };
+	if (mHeadless) rendererFlags = SDL_RENDERER_SOFTWARE;
+	if (mVSync && !mHeadless) rendererFlags = rendererFlags | SDL_RENDERER_PRESENTVSYNC;
+	mRenderer = SDL_CreateRenderer(mWindow, -1, rendererFlags);
 	if (!mRenderer) {
 		std::cerr << "Failed in SDLMan:init: Renderer could not be created. SDL Error: \n" << SDL_GetError();
 		return false;
@@ -87,6 +104,14 @@ bool SDLMan::init() {
 	// Initialize our unordered map of sound effects
 	mSoundMap = std::make_unique<SoundMap>();
 
+	// Initialize SDL_ttf for overlay text. The game runs without it so only warn.
+	if (TTF_Init() != 0) {
+		std::cerr << "Warning in SDLMan::init, SDL_ttf could not initialize. SDL_ttf Error: " << TTF_GetError() << std::endl;
+	}
+
+	// No gamepads when headless
+	if (mHeadless) return true;
+
 	// Load in game controller mappings database.
 	int iMapResult{ SDL_GameControllerAddMappingsFromFile("gamecontrollerdb.txt") };
 	if (DEBUG_MODE) std::cout << "SDLMan::openGamepad - Loaded gamecontrollerdb.txt mappings file with result: " << iMapResult << std::endl;
@@ -100,13 +125,6 @@ bool SDLMan::init() {
 	openGamepad();
 	SDL_GameControllerEventState(SDL_ENABLE);
 
-	// Initialize variables used for FPS calculation
-	//memset(mFPSTimes, 0, sizeof(mFPSTimes)); //***DEBUG*** delete this if our new for loop works
-	for (int i{}; i < FPS_AVG; ++i) mFPSTimes[i] = FPS_INIT;
-	mFPSCount = 0;
-	mFPS = FPS_INIT;
-	mFPSLast = SDL_GetTicks();
-
 	return true;
 }
 
@@ -144,9 +162,15 @@ void SDLMan::closeGamepad() {
 
 // Renders to the screen the contents of the buffer
 void SDLMan::refresh() {
+	ProfileZone zone{ "SDLMan::refresh" };
+
 	// Flip SDL's internal buffer to the window and clear buffer
 	SDL_RenderPresent(mRenderer);
 	SDL_RenderClear(mRenderer);
+
+	// time from the last present to this one
+	mFrameStats.mark();
+	Metrics::add(Metric::MT_FRAMES);
 }
 
 // Show or hide the window. Returns false if SDL hasn't been initialized yet.
@@ -183,6 +207,17 @@ int SDLMan::getWindowW() {
 	return mWindowW;
 }
 
+// Returns the milliseconds between refreshes of the display the window is on, 0 if unknown or there is no window.
+decimal SDLMan::getRefreshMS() {
+	if (!mWindow) return 0;
+
+	SDL_DisplayMode mode{};
+	int display{ SDL_GetWindowDisplayIndex(mWindow) };
+	if (display < 0 || SDL_GetCurrentDisplayMode(display, &mode) != 0 || mode.refresh_rate <= 0) return 0;
+
+	return 1000.0 / mode.refresh_rate;
+}
+
 // Set's the window width.
 void SDLMan::setWindowW(int windowW) {
 	mWindowW = windowW;
@@ -200,6 +235,26 @@ void SDLMan::setFullscreen(bool fs) {
 	}
 }
 
+// Set's whethar the renderer presents in sync with the display refresh. Must be called before init() to take effect.
+void SDLMan::setVSync(bool vSync) {
+	mVSync = vSync;
+}
+
+// Set's whethar to run without a display or sound device using SDL's dummy drivers and a software renderer. Must be called before init() to take effect.
+void SDLMan::setHeadless(bool headless) {
+	mHeadless = headless;
+}
+
+// Returns true if running on SDL's dummy drivers.
+bool SDLMan::isHeadless() {
+	return mHeadless;
+}
+
+// Set's whethar sound effects are ignored. Muted, queueing and playing sounds do nothing so several headless games can share this SDLMan from their own threads.
+void SDLMan::setMuted(bool muted) {
+	mMuted = muted;
+}
+
 // Returns the height and width of a Texture object's wrapped SDL_Texture. Return type holding width/height is an SDL_Point.
 SDL_Point SDLMan::getSize(Texture &text) {
 	SDL_Point size{};
@@ -322,6 +377,7 @@ std::unique_ptr<Texture> SDLMan::loadImage(std::string fileName, SDL_Color color
 	//Get rid of old loaded surface
 	SDL_FreeSurface(loadedSurface);
 	loadedSurface = nullptr;
+	Metrics::add(Metric::MT_ASSETS_LOADED);
 	
 	// Wrap the SDL_Texture in our Texture class and return as a smart pointer
 	return std::make_unique<Texture>(newTexture);
@@ -342,10 +398,18 @@ SDL_Renderer* SDLMan::getRenderer() {
 bool SDLMan::loadMusic(std::string musicFile) {
 	bool success{ true };
 
+	// free any music loaded before, a new level or game loading reuses this SDLMan
+	if (mMusic) {
+		Mix_FreeMusic(mMusic);
+		mMusic = nullptr;
+	}
+
 	mMusic = Mix_LoadMUS( musicFile.c_str() );
 	if (!mMusic) {
 		success = false;
 		std::cerr << "Failed in SDLMan::loadMusic. SDL_mixer Error: \n" << Mix_GetError() << std::endl;
+	} else {
+		Metrics::add(Metric::MT_ASSETS_LOADED);
 	}
 
 	return success;
@@ -382,15 +446,19 @@ bool SDLMan::addSoundEffect(std::string name, std::string filepath) {
 		return false;
 	}
 
-	// Add the sound effect to the SoundMap
-	(*mSoundMap)[name] = sound;
+	// Add the sound effect to the SoundMap, freeing any it replaces
+	Mix_Chunk*& entry{ (*mSoundMap)[name] };
+	if (entry) Mix_FreeChunk(entry);
+	entry = sound;
+	Metrics::add(Metric::MT_ASSETS_LOADED);
 
 	return true;
 }
 
 // Play's the specified sound effect stored in the sound map indicated by the string parameter. The sound effect had to been previously loaded using addSoundEffect().
 // Returns false if no sound with that name could be found.
-void SDLMan::playSoundEffect(std::string name) {
+void SDLMan::playSoundEffect(const std::string& name) {
+	if (mMuted) return;
 	if (mSoundMap == nullptr) {
 		std::cerr << "Warning in SDLMan::playSoundEffect. Did not attempt to play sound effect with the name \"" << name << "\". SDLMan SoundMap has not been initialized." << std::endl;
 		return;
@@ -399,9 +467,42 @@ void SDLMan::playSoundEffect(std::string name) {
 	Mix_Chunk* sound{ (*mSoundMap)[name] };
 	if (Mix_PlayChannel(-1, sound, 0) == -1) {
 		std::cerr << "Warning in SDLMan::playSoundEffect. Failed to play sound named \"" << name << "\". SDL_Mixer Error: " << Mix_GetError() << std::endl;
+	} else {
+		Metrics::add(Metric::MT_SOUNDS_PLAYED);
 	}
 }
 
+// Queues the specified sound effect to be played on the next call to playQueuedSounds(). The same sound queued more than once before then plays once.
+// Lets the game loop's audio subsystem batch sound playback at its own rate. Prints a warning to the standard error stream if no sound has that name.
+void SDLMan::queueSoundEffect(const std::string& name) {
+	if (mMuted) return;
+	if (mSoundMap == nullptr) {
+		std::cerr << "Warning in SDLMan::queueSoundEffect. Did not attempt to queue sound effect with the name \"" << name << "\". SDLMan SoundMap has not been initialized." << std::endl;
+		return;
+	}
+
+	SoundMap::iterator it{ mSoundMap->find(name) };
+	if (it == mSoundMap->end()) {
+		std::cerr << "Warning in SDLMan::queueSoundEffect. No sound effect named \"" << name << "\"." << std::endl;
+		return;
+	}
+
+	if (std::find(mSoundQueue.begin(), mSoundQueue.end(), it->second) == mSoundQueue.end()) mSoundQueue.push_back(it->second);
+}
+
+// Plays and clears all sound effects queued with queueSoundEffect().
+void SDLMan::playQueuedSounds() {
+	if (mMuted) return;
+	for (Mix_Chunk* sound : mSoundQueue) {
+		if (Mix_PlayChannel(-1, sound, 0) == -1) {
+			std::cerr << "Warning in SDLMan::playQueuedSounds. Failed to play a queued sound. SDL_Mixer Error: " << Mix_GetError() << std::endl;
+		} else {
+			Metrics::add(Metric::MT_SOUNDS_PLAYED);
+		}
+	}
+	mSoundQueue.clear();
+}
+
 // Attempts to remove the specified sound effect stored in the sound map indicated by the string parameter if one exists.
 void SDLMan::removeSoundEffect(std::string name) {
 	if (mSoundMap == nullptr) {
@@ -416,48 +517,22 @@ void SDLMan::removeSoundEffect(std::string name) {
 	}
 }
 
-// Calculates the current FPS using an averaging method of the last ten frames. Must be called every game tick for other FPS functions to work correctly.
-void SDLMan::calculateFPS() {
-	// fpsIndex is the position in the FPS averaging array. It ranges from 0 to FPS_AVG and rotates back to 0 after reaching FPS_AVG.
-	Uint32 fpsIndex{ mFPSCount % FPS_AVG };
-
-	// store the current time
-	Uint32 getticks{ SDL_GetTicks() };
-
-	// save the frame time value
-	mFPSTimes[fpsIndex] = getticks - mFPSLast;
-
-	// save the last frame time for the next fpsthink
-	mFPSLast = getticks;
-
-	// increment the frame count
-	++mFPSCount;
-
-	// test to see if the whole array has been written to or not. Stops strange values first FPS_AVG frames
-	Uint32 count{};
-	if (mFPSCount < FPS_AVG) {
-		count = mFPSCount;
-	} else {
-		count = FPS_AVG;
-	}
-
-	// add up all the values and divide to get the average frame time.
-	mFPS = 0;
-	for (Uint32 i = 0; i < count; i++) mFPS += mFPSTimes[i];
-	mFPS /= count;
+// Outputs the frame rate and frame time statistics to console, at most once a second.
+void SDLMan::outputFPS() {
+	Uint32 now{ SDL_GetTicks() };
+	if (now - mFPSLastOutput < 1000) return;
+	mFPSLastOutput = now;
 
-	// now to make it an actual frames per second value
-	mFPS = 1000.0 / mFPS;
+	std::cout << getFPS() << " FPS, " << mFrameStats.toString();
 }
 
-// Returns the current average FPS count.
+// Returns the average frames presented per second over the recent frame time window.
 decimal SDLMan::getFPS() {
-	// if this is the first five seconds of SDL running, return the FPS_INIT value to give our averaging time to catch up.
-	if (SDL_GetTicks() > 5000) 	return mFPS;
-	else return FPS_INIT;
+	FrameStats::Summary s{ mFrameStats.getSummary() };
+	return s.mean > 0 ? 1000.0 / s.mean : 0;
 }
 
-// Outputs the FPS count to console.
-void SDLMan::outputFPS() {
-	std::cout << getFPS() << "\n";
+// Returns the statistics of the interval between presented frames.
+FrameStats& SDLMan::getFrameStats() {
+	return mFrameStats;
 }
\ No newline at end of file
@@ -3,11 +3,13 @@
 #include "Texture.h"
 #include "FuGlobals.h"
 #include "Line.h"
+#include "FrameStats.h"
 #include <SDL.h>
 #include <SDL_mixer.h>
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 /* SDLMan - SDL Manager Utility Class
  *
@@ -25,17 +27,15 @@
  * the back buffer rendered too will stay constant and be scaled to
  * fit window when refresh() is called.
  *
- * If your application physics depend on accurate FPS calculation then
- * calculateFPS() must be called every game loop. It stores an average
- * of the last FPS_AVG frames calculations in a member variable that can be
- * obtained with getFPS() or output to the console with outputFPS().
+ * refresh() times the interval between presented frames into a FrameStats
+ * series. getFrameStats() gives other systems its mean, tail percentiles, etc.
+ * and getFPS() or outputFPS() give the average frame rate. Game physics use the
+ * fixed step SimClock and do not read these values.
  *
  */
 class SDLMan {
 
 public:
-	static constexpr Uint32 FPS_AVG			{ 250 };						// How many FPS calculations to store in an array for FPS averaging. Smooths FPS calc.
-	static constexpr Uint32 FPS_INIT		{ 125 };						// Initial value to fill FPS averaging array with. Smooths initial few seconds of calculations depending on FPS_AVG size.
 	static constexpr Uint32 MIXING_CHANNELS	{ 16 };							// How many audio mixing channels to allocate. Increase if getting "SDL_Mixer Error: No free channels available" errors.
 	static constexpr Uint32 WINDOW_DEF_W	{ FuGlobals::VIEWPORT_WIDTH };	// Default window width
 	static constexpr Uint32 WINDOW_DEF_H	{ FuGlobals::VIEWPORT_HEIGHT };	// Default window height
@@ -66,12 +66,27 @@ public:
 	// Return's the window width.
 	int getWindowW();
 
+	// Returns the milliseconds between refreshes of the display the window is on, 0 if unknown or there is no window.
+	decimal getRefreshMS();
+
 	// Set's the window width.
 	void setWindowW(int windowW);
 
 	// Set's the window fullscreen boolean value
 	void setFullscreen(bool fs);
 
+	// Set's whethar the renderer presents in sync with the display refresh. Must be called before init() to take effect.
+	void setVSync(bool vSync);
+
+	// Set's whethar to run without a display or sound device using SDL's dummy drivers and a software renderer. Must be called before init() to take effect.
+	void setHeadless(bool headless);
+
+	// Returns true if running on SDL's dummy drivers.
+	bool isHeadless();
+
+	// Set's whethar sound effects are ignored. Muted, queueing and playing sounds do nothing so several headless games can share this SDLMan from their own threads.
+	void setMuted(bool muted);
+
 	// Draws the buffer to the screen and clears the buffer
 	void refresh();
 
@@ -121,7 +136,14 @@ public:
 
 	// Play's the specified sound effect stored in the sound map indicated by the string parameter. The sound effect had to been previously loaded using addSoundEffect().
 	// Prints a warning to the standard error stream if the sound could not be played for any reason.
-	void playSoundEffect(std::string name);
+	void playSoundEffect(const std::string& name);
+
+	// Queues the specified sound effect to be played on the next call to playQueuedSounds(). The same sound queued more than once before then plays once.
+	// Lets the game loop's audio subsystem batch sound playback at its own rate. Prints a warning to the standard error stream if no sound has that name.
+	void queueSoundEffect(const std::string& name);
+
+	// Plays and clears all sound effects queued with queueSoundEffect().
+	void playQueuedSounds();
 
 	// Attempts to remove the specified sound effect stored in the sound map indicated by the string parameter if one exists.
 	void removeSoundEffect(std::string name);
@@ -144,15 +166,15 @@ public:
 	// Provide a pointer to our renderer for others to use to draw themselves.
 	SDL_Renderer* getRenderer();
 
-	// Calculates the current FPS using an averaging method of the last ten frames. Must be called every game tick for other FPS functions to work correctly.
-	void calculateFPS();
-
-	// Outputs the FPS count to console using an averaging method.
+	// Outputs the frame rate and frame time statistics to console, at most once a second.
 	void outputFPS();
 
-	// Returns the current average FPS count.
+	// Returns the average frames presented per second over the recent frame time window.
 	decimal getFPS();
 
+	// Returns the statistics of the interval between presented frames.
+	FrameStats& getFrameStats();
+
 private:
 	// A typedef for the datatype that stores sound effects. The string is the ID of the sound effect stored in the map. The sound effect is stored as a pointer to a Mix_Chunk.
 	typedef std::unordered_map<std::string, Mix_Chunk*> SoundMap;
@@ -163,6 +185,9 @@ private:
 	// Holds the unordered map of lookup name/sound effect in a smart pointer.
 	std::unique_ptr<SoundMap> mSoundMap{ nullptr };
 
+	// Sound effects waiting for playQueuedSounds(). Holds the chunks themselves so playing needs no map lookups.
+	std::vector<Mix_Chunk*> mSoundQueue{};
+
 	// Pointer holding the SDL_Window we'll be rendering to
 	SDL_Window* mWindow{ nullptr };
 
@@ -188,15 +213,18 @@ private:
 	// Full screen window or not
 	bool mWindowFull{ false };
 
-	// An array to store frame times for averaging FPS to smooth out calculation
-	Uint32 mFPSTimes[ FPS_AVG ];
+	// Create the renderer with vsync or not
+	bool mVSync{ false };
+
+	// Run on SDL's dummy video and audio drivers with a software renderer
+	bool mHeadless{ false };
 
-	// Last calculated SDL_GetTicks
-	Uint32 mFPSLast;
+	// Ignore sound effects
+	bool mMuted{ false };
 
-	// total frames rendered
-	Uint32 mFPSCount;
+	// Interval between presented frames
+	FrameStats mFrameStats{ "Render frame" };
 
-	// the current average FPS value
-	decimal mFPS;
+	// SDL_GetTicks when outputFPS last printed
+	Uint32 mFPSLastOutput{ 0 };
 };
\ No newline at end of file
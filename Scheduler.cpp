@@ -0,0 +1,85 @@
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "AllocTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// Constructor takes the length of one simulation tick in milliseconds, used to convert rates to periods.
+Scheduler::Scheduler(Uint32 tickMS) {
+	mTickMS = tickMS;
+}
+
+// Registers a task. Parameters are a name for debugging output, rate in Hz (clamped to the tick rate), phase offset in ticks,
+// priority (lower runs first), whethar it is staggered, whethar it is optional, and the function to run. The name must be a
+// string literal as it tags profiler zones and allocations, which keep only the pointer.
+void Scheduler::addTask(const char* name, decimal hz, Uint32 phase, int priority, bool staggered, bool optional, TaskFunction task) {
+	Task t{ name, getPeriod(hz), phase, priority, staggered, optional, task };
+	t.phase %= t.period;
+	mTasks.push_back(t);
+
+	// keep tasks in priority order. Stable so equal priorities run in the order they were added.
+	std::stable_sort(mTasks.begin(), mTasks.end(), [](const Task& a, const Task& b) {
+		return a.priority < b.priority;
+	});
+}
+
+// Runs all tasks due on the given tick. degraded skips optional tasks.
+void Scheduler::runTick(Uint64 tick, bool degraded) {
+	for (Task& t : mTasks) {
+		t.lastMS = 0;
+		if (degraded && t.optional) continue;
+
+		Uint32 slice{ static_cast<Uint32>((tick + t.phase) % t.period) };
+		if (!t.staggered && slice != 0) continue;
+
+		ProfileZone zone{ t.name };
+		AllocScope scope{ t.name };
+		// task times are only read by the flight recorder
+		if constexpr (FuGlobals::FLIGHT_RECORDER) {
+			Uint64 start{ SDL_GetPerformanceCounter() };
+			t.function(t.staggered ? slice : 0, t.period);
+			t.lastMS = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+		} else {
+			t.function(t.staggered ? slice : 0, t.period);
+		}
+	}
+}
+
+// Returns the period in whole ticks closest to the given rate in Hz. Never less than 1.
+Uint32 Scheduler::getPeriod(decimal hz) {
+	if (hz <= 0 || mTickMS == 0) return 1;
+
+	decimal ticksPerSecond{ 1000.0 / mTickMS };
+	Uint32 period{ static_cast<Uint32>(std::lround(ticksPerSecond / hz)) };
+	if (period < 1) period = 1;
+
+	return period;
+}
+
+// Returns the number of registered tasks.
+std::size_t Scheduler::getTaskCount() const {
+	return mTasks.size();
+}
+
+// Returns the name of the task at the given index in run order.
+const char* Scheduler::getTaskName(std::size_t i) const {
+	return mTasks[i].name;
+}
+
+// Returns the milliseconds the task at the given index took on the last tick, 0 if it didn't run or FLIGHT_RECORDER is off.
+decimal Scheduler::getTaskMS(std::size_t i) const {
+	return mTasks[i].lastMS;
+}
+
+// Returns the registered tasks and their periods represented as a string.
+std::string Scheduler::toString() {
+	std::ostringstream str{};
+	for (const Task& t : mTasks) {
+		str << "Scheduler::" << t.name << ": every " << t.period << " ticks, phase " << t.phase << ", priority " << t.priority;
+		if (t.staggered) str << ", staggered";
+		if (t.optional) str << ", optional";
+		str << "\n";
+	}
+	return str.str();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+/* Scheduler - Runs game subsystems at independent rates
+ *
+ * Owned by GameLoop and run once per simulation tick. Each subsystem registers a task with a
+ * rate in Hz, a phase offset in ticks, and a priority. A rate is turned into a period of whole
+ * ticks and the task runs on ticks where (tick + phase) % period == 0. Due tasks run lowest
+ * priority number first. Giving tasks of the same rate different phases spreads them across ticks.
+ *
+ * A staggered task runs every tick instead but is told which slice of period it is on. The task
+ * does 1/period of its work each tick (e.g. one in every period enemies re-plans) so each item
+ * still updates at the requested rate while the cost is spread evenly over the ticks.
+ *
+ * Optional tasks are skipped on ticks the game loop is catching up (see DEGRADE_WHEN_BEHIND). Whethar
+ * that happens depends on wall clock load, so optional tasks must not change simulation state.
+ */
+class Scheduler {
+
+public:
+	// Signature of a task. slice is which part of its work a staggered task should do this tick (always 0 for a normal task) and period is its period in ticks.
+	typedef std::function<void(Uint32 slice, Uint32 period)> TaskFunction;
+
+	// Constructor takes the length of one simulation tick in milliseconds, used to convert rates to periods.
+	Scheduler(Uint32 tickMS);
+	Scheduler() = delete;
+
+	// Registers a task. Parameters are a name for debugging output, rate in Hz (clamped to the tick rate), phase offset in ticks,
+	// priority (lower runs first), whethar it is staggered, whethar it is optional, and the function to run. The name must be a
+	// string literal as it tags profiler zones and allocations, which keep only the pointer.
+	void addTask(const char* name, decimal hz, Uint32 phase, int priority, bool staggered, bool optional, TaskFunction task);
+
+	// Runs all tasks due on the given tick. degraded skips optional tasks.
+	void runTick(Uint64 tick, bool degraded);
+
+	// Returns the period in whole ticks closest to the given rate in Hz. Never less than 1.
+	Uint32 getPeriod(decimal hz);
+
+	// Returns the number of registered tasks.
+	std::size_t getTaskCount() const;
+
+	// Returns the name of the task at the given index in run order.
+	const char* getTaskName(std::size_t i) const;
+
+	// Returns the milliseconds the task at the given index took on the last tick, 0 if it didn't run or FLIGHT_RECORDER is off.
+	decimal getTaskMS(std::size_t i) const;
+
+	// Returns the registered tasks and their periods represented as a string.
+	std::string toString();
+
+private:
+	// One registered subsystem
+	struct Task {
+		const char* name{ nullptr };
+		Uint32 period{ 1 };
+		Uint32 phase{ 0 };
+		int priority{ 0 };
+		bool staggered{ false };
+		bool optional{ false };
+		TaskFunction function{};
+		decimal lastMS{ 0 };
+	};
+
+	// Length of one tick in milliseconds
+	Uint32 mTickMS{};
+
+	// All registered tasks kept sorted by priority
+	std::vector<Task> mTasks{};
+};
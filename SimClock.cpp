@@ -0,0 +1,137 @@
+#include "SimClock.h"
+#include <sstream>
+#include <cmath>
+
+// Constructor takes the simulated length of one tick and the real time that must pass before each tick is due, both in milliseconds.
+SimClock::SimClock(Uint32 tickMS, Uint32 paceMS) {
+	mTickMS = tickMS;
+	mPaceMS = paceMS;
+	mDT = mTickMS / 1000.0;
+	mCountsPerMS = SDL_GetPerformanceFrequency() / 1000.0;
+	reset();
+}
+
+// Restarts real time measurement from now and clears any built up lag. Tick count is left alone.
+void SimClock::reset() {
+	mPrevious = SDL_GetPerformanceCounter();
+	mLag = 0;
+}
+
+// Reads the performance counter and adds the real time elapsed since the last call to our lag. Call once per game loop iteration.
+void SimClock::update() {
+	Uint64 current{ SDL_GetPerformanceCounter() };
+	mLag += (current - mPrevious) / mCountsPerMS;
+	mPrevious = current;
+}
+
+// Returns true if enough real time has built up for another simulation tick.
+bool SimClock::tickDue() {
+	return mLag >= mPaceMS;
+}
+
+// Consumes one tick worth of lag and advances the simulation tick count.
+void SimClock::tick() {
+	if (mPaceMS == 0) mLag = 0;
+	else mLag -= mPaceMS;
+	++mTicks;
+}
+
+// Returns the fixed length of one simulation tick in seconds. This is the dt passed to all integrators.
+decimal SimClock::getDT() {
+	return mDT;
+}
+
+// Returns the fixed length of one simulation tick in milliseconds.
+Uint32 SimClock::getTickMS() {
+	return mTickMS;
+}
+
+// Returns the real time pacing of one tick in milliseconds. 0 means unpaced.
+Uint32 SimClock::getPaceMS() {
+	return mPaceMS;
+}
+
+// Returns the number of simulation ticks run since construction.
+Uint64 SimClock::getTicks() {
+	return mTicks;
+}
+
+// Returns the amount of simulated time elapsed in seconds.
+decimal SimClock::getSimTime() {
+	return mTicks * mDT;
+}
+
+// Returns the real time in milliseconds that has built up but not yet been consumed by a tick.
+decimal SimClock::getLag() {
+	return mLag;
+}
+
+// Returns the lag including real time elapsed since the last update() without adding it. Lets a frame pacer watch for the next tick.
+decimal SimClock::peekLag() {
+	return mLag + (SDL_GetPerformanceCounter() - mPrevious) / mCountsPerMS;
+}
+
+// Returns how far real time has progressed towards the next tick, from 0 to 1. Used to interpolate rendering between ticks. Always 1 when unpaced.
+decimal SimClock::getAlpha() {
+	if (mPaceMS == 0) return 1;
+
+	// a capped catch up frame can leave more than one tick of lag behind. Never extrapolate past the current state.
+	decimal alpha{ mLag / mPaceMS };
+	if (alpha > 1) alpha = 1;
+
+	return alpha;
+}
+
+// Returns interpolation alpha for a tick that finished at the given performance counter value, from 0 to 1. Only reads
+// values fixed at construction so a render thread may call it while the simulation thread owns the clock.
+decimal SimClock::getAlphaSince(Uint64 counter) {
+	if (mPaceMS == 0) return 1;
+
+	decimal alpha{ (SDL_GetPerformanceCounter() - counter) / mCountsPerMS / mPaceMS };
+	if (alpha > 1) alpha = 1;
+
+	return alpha;
+}
+
+// Returns the number of whole ticks the built up lag is worth. Always 1 when unpaced.
+Uint32 SimClock::getTicksDue() {
+	if (mPaceMS == 0) return 1;
+	return static_cast<Uint32>(mLag / mPaceMS);
+}
+
+// Caps built up lag at maxLagMS. The whole ticks thrown away are added to the dropped tick count. Returns the number dropped.
+Uint32 SimClock::clampLag(Uint32 maxLagMS) {
+	if (mPaceMS == 0 || mLag <= maxLagMS) return 0;
+
+	// only throw away whole ticks so the fractional remainder carries on as normal
+	Uint32 dropped{ static_cast<Uint32>(std::ceil((mLag - maxLagMS) / mPaceMS)) };
+	mLag -= static_cast<decimal>(dropped) * mPaceMS;
+	mDroppedTicks += dropped;
+
+	return dropped;
+}
+
+// Records a frame that ran out of catch up ticks before the lag was consumed.
+void SimClock::countCappedFrame() {
+	++mCappedFrames;
+}
+
+// Returns the total ticks thrown away by clampLag().
+Uint64 SimClock::getDroppedTicks() {
+	return mDroppedTicks;
+}
+
+// Returns the total frames that hit the catch up limit.
+Uint64 SimClock::getCappedFrames() {
+	return mCappedFrames;
+}
+
+// Returns the clock's tick and catch up statistics represented as a string.
+std::string SimClock::toString() {
+	std::ostringstream str{};
+	str << "SimClock::Ticks: " << mTicks << "\n";
+	str << "SimClock::Sim Time: " << getSimTime() << "s\n";
+	str << "SimClock::Dropped Ticks: " << mDroppedTicks << "\n";
+	str << "SimClock::Capped Frames: " << mCappedFrames << "\n";
+	return str.str();
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+
+/* SimClock - Fixed step simulation clock
+ *
+ * Owned by GameLoop. Measures real time with SDL's high resolution performance counter
+ * and hands out simulation ticks of a fixed length. Every physics and movement routine
+ * integrates with getDT() so a run is reproducible no matter how fast frames are rendered.
+ *
+ * The simulated tick length and the real time pacing of ticks are kept separate. A tick is
+ * always tickMS of game time but is only due once paceMS of real time has built up. Setting
+ * paceMS lower or higher than tickMS runs the game faster or slower than real time, and a
+ * paceMS of 0 makes every call to tickDue() true so the caller can step as fast as it likes.
+ *
+ * After a stall the caller should clampLag() and limit how many ticks it runs per frame so
+ * catching up never makes the stall worse. Dropped ticks and capped frames are counted.
+ */
+class SimClock {
+
+public:
+	// Constructor takes the simulated length of one tick and the real time that must pass before each tick is due, both in milliseconds.
+	SimClock(Uint32 tickMS, Uint32 paceMS);
+	SimClock() = delete;
+
+	// Restarts real time measurement from now and clears any built up lag. Tick count is left alone.
+	void reset();
+
+	// Reads the performance counter and adds the real time elapsed since the last call to our lag. Call once per game loop iteration.
+	void update();
+
+	// Returns true if enough real time has built up for another simulation tick.
+	bool tickDue();
+
+	// Consumes one tick worth of lag and advances the simulation tick count.
+	void tick();
+
+	// Returns the fixed length of one simulation tick in seconds. This is the dt passed to all integrators.
+	decimal getDT();
+
+	// Returns the fixed length of one simulation tick in milliseconds.
+	Uint32 getTickMS();
+
+	// Returns the real time pacing of one tick in milliseconds. 0 means unpaced.
+	Uint32 getPaceMS();
+
+	// Returns the number of simulation ticks run since construction.
+	Uint64 getTicks();
+
+	// Returns the amount of simulated time elapsed in seconds.
+	decimal getSimTime();
+
+	// Returns the real time in milliseconds that has built up but not yet been consumed by a tick.
+	decimal getLag();
+
+	// Returns the lag including real time elapsed since the last update() without adding it. Lets a frame pacer watch for the next tick.
+	decimal peekLag();
+
+	// Returns how far real time has progressed towards the next tick, from 0 to 1. Used to interpolate rendering between ticks. Always 1 when unpaced.
+	decimal getAlpha();
+
+	// Returns interpolation alpha for a tick that finished at the given performance counter value, from 0 to 1. Only reads
+	// values fixed at construction so a render thread may call it while the simulation thread owns the clock.
+	decimal getAlphaSince(Uint64 counter);
+
+	// Returns the number of whole ticks the built up lag is worth. Always 1 when unpaced.
+	Uint32 getTicksDue();
+
+	// Caps built up lag at maxLagMS. The whole ticks thrown away are added to the dropped tick count. Returns the number dropped.
+	Uint32 clampLag(Uint32 maxLagMS);
+
+	// Records a frame that ran out of catch up ticks before the lag was consumed.
+	void countCappedFrame();
+
+	// Returns the total ticks thrown away by clampLag().
+	Uint64 getDroppedTicks();
+
+	// Returns the total frames that hit the catch up limit.
+	Uint64 getCappedFrames();
+
+	// Returns the clock's tick and catch up statistics represented as a string.
+	std::string toString();
+
+private:
+	// Simulated length of one tick in milliseconds
+	Uint32 mTickMS{};
+
+	// Real milliseconds that must build up before a tick is due
+	Uint32 mPaceMS{};
+
+	// Fixed dt in seconds, cached from mTickMS
+	decimal mDT{};
+
+	// Ticks of the performance counter per millisecond, cached from SDL_GetPerformanceFrequency
+	decimal mCountsPerMS{};
+
+	// Performance counter value at the last update
+	Uint64 mPrevious{};
+
+	// Real time in milliseconds not yet consumed by a tick
+	decimal mLag{};
+
+	// Total simulation ticks run
+	Uint64 mTicks{};
+
+	// Total ticks thrown away rather than simulated after a stall
+	Uint64 mDroppedTicks{};
+
+	// Total frames that ran out of catch up ticks
+	Uint64 mCappedFrames{};
+};
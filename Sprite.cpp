@@ -1,6 +1,9 @@
 #include "Sprite.h"
 #include "FensoxUtils.h"
 #include "FuGlobals.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <SDL_image.h>
 #include <iostream>
 #include <fstream>
@@ -15,11 +18,15 @@ Sprite::Sprite(std::weak_ptr<SDLMan> sdlMan) {
 
     // set default action mode set for this sprite into our action mode member
     mActionMode = mStartingActionMode;
+    cacheActionMode();
 }
 
 // Destructor
 Sprite::~Sprite() {
-    if constexpr (FuGlobals::DEBUG_MODE) std::cerr << "Destructor: Sprite" << std::endl;
+    Log::debug("Destructor: Sprite");
+
+    // drop any timers still pointing at us
+    if (auto timers = mTimers.lock()) timers->cancelOwner(this);
     mTexture.reset();
     mLevel.reset();
     mSDL.reset();
@@ -39,9 +46,30 @@ bool Sprite::load() {
         return false;    
     }
 
+    // size the action mode strings for the longest action name so changing modes in game never allocates
+    std::size_t longest{ 0 };
+    for (const auto& anim : mAnimMap) longest = std::max(longest, anim.first.size());
+    mActionMode.reserve(longest);
+    mLastActionMode.reserve(longest);
+
+    // find the biggest the collision rectangle can get so the level's sprite hash can search far enough around us
+    for (const auto& anim : mAnimMap) {
+        for (const SDL_Rect& clip : anim.second) {
+            mMaxCollSize.x = std::max(mMaxCollSize.x, clip.w * mScale);
+            mMaxCollSize.y = std::max(mMaxCollSize.y, clip.h * mScale);
+        }
+    }
+
     return true;
 }
 
+// Looks up the current action mode's ID and animation frames. Called whenever mActionMode is set.
+void Sprite::cacheActionMode() {
+    // an unknown mode gets an empty entry, as looking it up by name each time used to
+    mActionModeID = FensoxUtils::hash(mActionMode.c_str());
+    mFrames = &mAnimMap[mActionMode];
+}
+
 // Load the initial data file in with action mode names and clip rects for the sprite sheet. Store data in member mAnimMap and return success.
 bool Sprite::loadDataFile() {
     // attempt to open a filestream on the filename or return a failure.
@@ -101,6 +129,24 @@ void Sprite::setLevel(std::weak_ptr<Level> level) {
     mLevel = level;
 }
 
+// Folds the sprite's simulation state (position, velocity, health, animation) into a running hash and returns it. Used to check replays reproduce a run exactly.
+Uint64 Sprite::hashState(Uint64 hash) {
+    using namespace FensoxUtils;
+
+    hash = hashValue(mXPos, hash);
+    hash = hashValue(mYPos, hash);
+    hash = hashValue(mVeloc.up, hash);
+    hash = hashValue(mVeloc.down, hash);
+    hash = hashValue(mVeloc.left, hash);
+    hash = hashValue(mVeloc.right, hash);
+    hash = hashValue(mHealth, hash);
+    hash = hashValue(mCurrentFrame, hash);
+    hash = hashValue(mFacingRight, hash);
+    hash = hashBytes(mActionMode.data(), mActionMode.size(), hash);
+
+    return hash;
+}
+
 // Returns a string representation of the sprite information
 std::string Sprite::toString() {
     const SDL_Rect& cr = getCollisionRect();
@@ -142,25 +188,34 @@ void Sprite::adjustHealth(int amount) {
     if (mHealth < 0) mHealth = 0;
 }
 
-// Set the action mode to enter into and also if it is a looping animation or not.
-void Sprite::setActionMode(std::string actionMode, bool looping) {
+// Set the action mode to enter into and also if it is a looping animation or not. Copied into storage sized at load so never allocates.
+void Sprite::setActionMode(std::string_view actionMode, bool looping) {
     mLastActionMode = mActionMode;
     mLastActionModeLooping = mActionModeLooping;
-    mActionMode = actionMode;
+    mLastActionModeID = mActionModeID;
+    mLastFrames = mFrames;
+    mActionMode.assign(actionMode.data(), actionMode.size());
     mActionModeLooping = looping;
+    cacheActionMode();
     mCurrentFrame = 0;
 }
 
 // Returns the current action mode
-std::string Sprite::getActionMode() {
+const std::string& Sprite::getActionMode() {
     return mActionMode;
 }
 
 // Returns the last action mode
-std::string Sprite::getLastActionMode() {
+const std::string& Sprite::getLastActionMode() {
     return mLastActionMode;
 }
 
+// Returns the FensoxUtils::hash of the current action mode's name. Compare against the AM_ constants in Sprite.h rather than comparing
+// strings in per tick code.
+unsigned int Sprite::getActionModeID() {
+    return mActionModeID;
+}
+
 // Returns whethar the current action mode is a looping animation or not.
 bool Sprite::getActionModeLooping() {
     return mActionModeLooping;
@@ -173,14 +228,14 @@ bool Sprite::getLastActionModeLooping() {
 
 // Reverts action mode to the last action mode. Sets last action mode as mode we just changed out of. Swaps the two.
 void Sprite::revertLastActionMode() {
-    bool looping{ mActionModeLooping };
-    std::string mode{ mActionMode };
-
-    mActionMode = mLastActionMode;
-    mActionModeLooping = mLastActionModeLooping;
+    // swap rather than copy through a temporary string
+    mActionMode.swap(mLastActionMode);
+    std::swap(mActionModeLooping, mLastActionModeLooping);
+    std::swap(mActionModeID, mLastActionModeID);
+    std::swap(mFrames, mLastFrames);
 
-    mLastActionMode = mode;
-    mLastActionModeLooping = looping;
+    // nothing was set before the first change so look the mode up
+    if (!mFrames) cacheActionMode();
 
     mCurrentFrame = 0;
 }
@@ -217,6 +272,22 @@ decimal Sprite::getLastX() { return mLastXPos; }
 // Returns the sprite's last y coordinate position relative to level.
 decimal Sprite::getLastY() { return mLastYPos; }
 
+// Stores the current position as the start of a new simulation tick. Called before each tick and after any teleport so rendering can interpolate.
+void Sprite::storeTickStart() {
+    mTickXPos = mXPos;
+    mTickYPos = mYPos;
+}
+
+// Returns the x coordinate interpolated between the start of the current tick (alpha 0) and the current position (alpha 1).
+decimal Sprite::getRenderX(decimal alpha) {
+    return mTickXPos + (mXPos - mTickXPos) * alpha;
+}
+
+// Returns the y coordinate interpolated between the start of the current tick (alpha 0) and the current position (alpha 1).
+decimal Sprite::getRenderY(decimal alpha) {
+    return mTickYPos + (mYPos - mTickYPos) * alpha;
+}
+
 // Returns the name of this sprite from the global mName constant.
 std::string Sprite::getName() {
     return mName;
@@ -225,7 +296,7 @@ std::string Sprite::getName() {
 // Advances the current action mode animation frame ahead or loops to beginning if at end of animation frames and defined as a looping action mode.
 void Sprite::advanceFrame() {
     // get the number of frames this animation has
-    std::size_t totalFrames = mAnimMap[mActionMode].size();
+    std::size_t totalFrames = mFrames->size();
 
     // increment the animation ahead
     ++mCurrentFrame;
@@ -239,7 +310,7 @@ void Sprite::advanceFrame() {
 
 // Returns the current animation frame's rectangle from the sprite sheet. Sprite sheet coordinate relative.
 const SDL_Rect& Sprite::getRect() {
-    return mAnimMap[mActionMode].at(mCurrentFrame);
+    return mFrames->at(mCurrentFrame);
 }
 
 // Set's the target Sprite object. Used in AI routines as the target sprite to follow/attack, etc.
@@ -247,33 +318,41 @@ void Sprite::setTargetSprite(std::weak_ptr<Sprite> targetSprite) {
     mTargetSprite = targetSprite;
 }
 
-// Draws a mark on the screen for each collision point boundry. For debugging purposes.
-void Sprite::drawCollisionPoints() {
-    // set draw color and mark size
-    mSDL.lock()->setDrawColor(255, 255, 0);
-    int radius{ 3 };
+// Sets the simulation's timer wheel used for animation and attack timing.
+void Sprite::setTimers(std::weak_ptr<TimerWheel> timers) {
+    mTimers = timers;
+}
 
-    // draw a circle at our center coordinates
-    mSDL.lock()->drawCircleFilled(static_cast<int>(mXPos - mLevel.lock()->getPosition().x), static_cast<int>(mYPos - mLevel.lock()->getPosition().y), radius);
+// Sets flag to false and schedules it to be set true after the given milliseconds of simulation time. Sets it true straight away if there is no timer wheel.
+void Sprite::setFlagAfter(Uint32 ms, bool& flag) {
+    auto timers = mTimers.lock();
+    if (!timers) {
+        flag = true;
+        return;
+    }
 
-    // draw bottom
-    Line line{ getVPRelative(getCollRectBtm()) };
-    mSDL.lock()->drawLine(line);
+    flag = false;
+    bool* target{ &flag };
+    timers->schedule(timers->msToTicks(ms), this, [target]() { *target = true; });
+}
 
-    // draw top
-    line = getVPRelative(getCollRectTop());
-    mSDL.lock()->drawLine(line);
+// Draws a mark on the screen for each collision point boundry of a sprite snapshot. For debugging purposes.
+void Sprite::drawCollisionPoints(SDLMan& sdl, const SpriteSnapshot& snap, const SDL_Point& viewport) {
+    // set draw color and mark size
+    sdl.setDrawColor(255, 255, 0);
+    int radius{ 3 };
 
-    // draw left compensating for viewport position
-    line = getVPRelative(getCollRectLeft());
-    mSDL.lock()->drawLine(line);
+    // draw a circle at our center coordinates
+    sdl.drawCircleFilled(static_cast<int>(snap.x - viewport.x), static_cast<int>(snap.y - viewport.y), radius);
 
-    // draw right compensating for viewport position
-    line = getVPRelative(getCollRectRight());
-    mSDL.lock()->drawLine(line);
+    // draw bottom, top, left, and right compensating for viewport position
+    const Line* lines[]{ &snap.colBtm, &snap.colTop, &snap.colLeft, &snap.colRight };
+    for (const Line* l : lines) {
+        sdl.drawLine(l->x1 - viewport.x, l->y1 - viewport.y, l->x2 - viewport.x, l->y2 - viewport.y);
+    }
 
     // return draw color to black
-    mSDL.lock()->setDrawColor(0, 0, 0);
+    sdl.setDrawColor(0, 0, 0);
 }
 
 /*  Returns current Sprite's action frame collision rectangle by value. The position of the rectangle is set to player
@@ -282,7 +361,7 @@ void Sprite::drawCollisionPoints() {
     on the Sprite mScale scaling factor. */
 SDL_Rect Sprite::getCollisionRect() {
     // get current sprite sheet clip rectangle
-    SDL_Rect rect{ mAnimMap[mActionMode].at(mCurrentFrame) };
+    SDL_Rect rect{ mFrames->at(mCurrentFrame) };
 
     // adjust w, h based on our mScale scaling factor
     rect.w *= mScale;
@@ -295,6 +374,11 @@ SDL_Rect Sprite::getCollisionRect() {
     return rect;
 }
 
+// Returns the largest collision rectangle width and height over all of the sprite's animation frames. Set by load().
+SDL_Point Sprite::getMaxCollisionSize() {
+    return mMaxCollSize;
+}
+
 // Returns a line representing the bottom of the current collision rectangle. Used for downBump collision detection, drawing debugging rectangles, etc.
 Line Sprite::getCollRectBtm() {
     SDL_Rect rect{ getCollisionRect() };
@@ -384,35 +468,55 @@ Line Sprite::getVPRelative(const Line& inLine) {
     return outLine;
 }
 
-// Renders the sprite based on position, action mode, animation frame using a SDL_Renderer from SDLMan.
-void Sprite::render() {
-    // get our SDL_Rect for the current animation frame
-    const SDL_Rect& clip{ getRect() };
+// Copies everything needed to draw this sprite into a snapshot. Called by the simulation at the end of a tick.
+void Sprite::storeSnapshot(SpriteSnapshot& snap) {
+    snap.texture = mTexture.get();
+    snap.clip = getRect();
+    snap.scale = mScale;
+    snap.tickX = mTickXPos;
+    snap.tickY = mTickYPos;
+    snap.x = mXPos;
+    snap.y = mYPos;
+    if constexpr (FuGlobals::DEBUG_MODE) {
+        snap.colBtm = getCollRectBtm();
+        snap.colTop = getCollRectTop();
+        snap.colLeft = getCollRectLeft();
+        snap.colRight = getCollRectRight();
+    }
+}
+
+// Renders a sprite snapshot based on position and animation frame using a SDL_Renderer from SDLMan. Reads nothing from the live Sprite so is safe to call from a render thread.
+// viewport is the level relative top-left of the viewport and alpha is how far between the start and end of the snapshot's tick to draw, 0 to 1.
+void Sprite::render(SDLMan& sdl, const SpriteSnapshot& snap, const SDL_Point& viewport, decimal alpha, bool drawDebug) {
+    ProfileZone zone{ "Sprite::render" };
 
-    // scale our animation frame based on mScale member for this sprite
-    decimal scaledW = clip.w * mScale;
-    decimal scaledH = clip.h * mScale;
+    // scale our animation frame based on the sprite's scale
+    decimal scaledW = snap.clip.w * snap.scale;
+    decimal scaledH = snap.clip.h * snap.scale;
 
-    // create a destination rect centering texture on our position
-    decimal x{ mXPos - (scaledW / 2) };
-    decimal y{ mYPos - (scaledH / 2) };
-    mDest = { static_cast<int>(x), static_cast<int>(y), static_cast<int>(scaledW), static_cast<int>(scaledH) };
+    // create a destination rect centering texture on our position interpolated between the last two ticks
+    decimal x{ snap.tickX + (snap.x - snap.tickX) * alpha - (scaledW / 2) };
+    decimal y{ snap.tickY + (snap.y - snap.tickY) * alpha - (scaledH / 2) };
+    SDL_Rect dest{ static_cast<int>(x), static_cast<int>(y), static_cast<int>(scaledW), static_cast<int>(scaledH) };
    
     // adjust the Sprite coordinates to viewport relative
-    mDest.x -= mLevel.lock()->getPosition().x;
-    mDest.y -= mLevel.lock()->getPosition().y;
+    dest.x -= viewport.x;
+    dest.y -= viewport.y;
 
     //Render to screen
-    SDL_RenderCopyEx(   mSDL.lock()->getRenderer(),
-                        mTexture->getTexture(),
-                        &clip,
-                        &mDest,
+    Metrics::add(Metric::MT_RENDER_COPIES);
+    SDL_RenderCopyEx(   sdl.getRenderer(),
+                        snap.texture->getTexture(),
+                        &snap.clip,
+                        &dest,
                         0,
                         NULL,
                         SDL_FLIP_NONE);
 
-    //Draw collision points on screen if debug global is on.
-    if constexpr (FuGlobals::DEBUG_MODE) drawCollisionPoints();
+    //Draw collision points on screen if debug global is on and the game loop is not catching up.
+    if constexpr (FuGlobals::DEBUG_MODE) {
+        if (drawDebug) drawCollisionPoints(sdl, snap, viewport);
+    }
 }
 
 // Collision detection function. Paramaters are:
@@ -458,31 +562,36 @@ bool Sprite::isCollision(FuGlobals::ColType inType, FuGlobals::ColDirect inDirec
     return isCollision(inType, inDirect, inPixels, tmp);
 }
 
-// Applies gravity to the sprite if parameter set to true otherwise checks if sprite just finished a fall and cleans up velocity variables.
-void Sprite::applyGravity(bool standing) {
+// AI decision making. Run by the game loop's AI subsystem at its own rate rather than every tick. Does nothing unless overridden.
+void Sprite::think() {}
+
+// Steps animation frames. Run by the game loop's animation subsystem at its own rate rather than every tick. Does nothing unless overridden.
+void Sprite::animate() {}
+
+// Applies gravity to the sprite if parameter set to true otherwise checks if sprite just finished a fall and cleans up velocity variables. dt is the tick length in seconds.
+void Sprite::applyGravity(bool standing, decimal dt) {
     // If we are standing but have downward velocity still, we have just landed. Reset y velocities to stop bouncing and other jump artifacts.
     if (standing && (mVeloc.down > 0)) {
         mVeloc.up = 0;
         mVeloc.down = 0;
     } else if (!standing) {
-        // we are falling, apply proper amount of gravity depending on framerate timing to hit our real world GRAVITY constant
-        decimal gravThisFrame{ FuGlobals::GRAVITY / mSDL.lock()->getFPS() };
+        // we are falling, apply one tick's worth of our real world GRAVITY constant
+        decimal gravThisFrame{ FuGlobals::GRAVITY * dt };
         mVeloc.up -= gravThisFrame;
         if (mVeloc.up < 0) mVeloc.up = 0;
         mVeloc.down += gravThisFrame;
 
         // adjust to be sure we don't exceed terminal velocity
-        decimal tvThisFrame{ FuGlobals::TERMINAL_VELOCITY / mSDL.lock()->getFPS() };
-        if (mVeloc.down > tvThisFrame) mVeloc.down = tvThisFrame;
+        if (mVeloc.down > FuGlobals::TERMINAL_VELOCITY) mVeloc.down = FuGlobals::TERMINAL_VELOCITY;
     }
 }
 
-// Applies friction to the sprite to slow horizontal movement. Handles surface and air friction depending on bool parameter true of false respectively.
-void Sprite::applyFriction(bool standing) {
-        // set what friction value we will use and divide it by current FPS average to get our pixels per real world second
+// Applies friction to the sprite to slow horizontal movement. Handles surface and air friction depending on bool parameter true of false respectively. dt is the tick length in seconds.
+void Sprite::applyFriction(bool standing, decimal dt) {
+        // set what friction value we will use and scale it by the tick length to get this tick's share of it
         decimal friction{ FuGlobals::GROUND_FRICTION };
         if (!standing) friction = FuGlobals::AIR_FRICTION;
-        friction = friction / mSDL.lock()->getFPS();
+        friction = friction * dt;
 
         // apply the friction being sure velocity not reduced below 0
         mVeloc.left -= friction;
@@ -492,23 +601,22 @@ void Sprite::applyFriction(bool standing) {
         if (mVeloc.right < 0) mVeloc.right = 0;
 }
 
-// Moves Sprite based on velocities adjusting for gravity, friction, and collisions. Override or extend for custom movement routines.
-void Sprite::move() {
+// Moves Sprite based on velocities adjusting for gravity, friction, and collisions. Override or extend for custom movement routines. dt is the tick length in seconds.
+void Sprite::move(decimal dt) {
     using namespace FuGlobals;
 
     // check for a downward collision to see if we are on stable ground. This will affect gravity and friction application.
     bool standing{ isCollision(ColType::CT_LEVEL, ColDirect::CD_DOWN, 0) };
 
     // apply gravity
-    applyGravity(standing);
+    applyGravity(standing, dt);
 
     // apply friction
-    applyFriction(standing);
+    applyFriction(standing, dt);
 
-    // add up how much we are trying to move and make the change to our position
-    
-    setX( getX() + mVeloc.right - mVeloc.left );
-    setY( getY() + mVeloc.down - mVeloc.up );
+    // add up how much we are trying to move and make the change to our position. Velocities are pixels per second so scale by the tick length.
+    setX( getX() + (mVeloc.right - mVeloc.left) * dt );
+    setY( getY() + (mVeloc.down - mVeloc.up) * dt );
 
     // check for collisions with level objects to remove the sprite from any floors or walls
     correctFrameLevel();
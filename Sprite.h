@@ -4,7 +4,11 @@
 #include "Texture.h"
 #include "SDLMan.h"
 #include "Line.h"
+#include "RenderSnapshot.h"
+#include "TimerWheel.h"
+#include "FensoxUtils.h"
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <SDL.h>
@@ -29,14 +33,21 @@ public:
 	// Load sprite data from files - Needs to be called before any other functions can be called.
 	bool load();
 
-	// Renders the sprite based on position, action mode, animation frame using a SDL_Renderer from SDLMan.
-	void render();
+	// Copies everything needed to draw this sprite into a snapshot. Called by the simulation at the end of a tick.
+	void storeSnapshot(SpriteSnapshot& snap);
+
+	// Renders a sprite snapshot based on position and animation frame using a SDL_Renderer from SDLMan. Reads nothing from a live Sprite so is safe to call from a render thread.
+	// viewport is the level relative top-left of the viewport, alpha is how far between the start and end of the snapshot's tick to draw (0 to 1), and drawDebug turns on collision marks in debug mode.
+	static void render(SDLMan& sdl, const SpriteSnapshot& snap, const SDL_Point& viewport, decimal alpha, bool drawDebug);
 
 	/*  Returns current Sprite's action frame collision rectangle by value. The position of the rectangle is set to player
 	coordinates in the level. Width and height are set to the size of the sprite sheet animation we are currently on and
 	scaled based on the Sprite mScale scaling factor. */
 	SDL_Rect getCollisionRect();
 
+	// Returns the largest collision rectangle width and height over all of the sprite's animation frames. Set by load().
+	SDL_Point getMaxCollisionSize();
+
 	// Returns a line representing the bottom of the current collision rectangle. Used for downBump collision detection, drawing debugging rectangles, etc.
 	Line getCollRectBtm();
 
@@ -61,6 +72,9 @@ public:
 	// Set's the target Sprite object. Used in AI routines as the target sprite to follow/attack, etc.
 	void setTargetSprite(std::weak_ptr<Sprite> targetSprite);
 
+	// Sets the simulation's timer wheel used for animation and attack timing.
+	void setTimers(std::weak_ptr<TimerWheel> timers);
+
 	// Access function to get the depth of this sprite as an int.
 	int getDepth();
 
@@ -88,20 +102,40 @@ public:
 	// Returns the sprite's last y coordinate position relative to level.
 	decimal getLastY();
 
+	// Stores the current position as the start of a new simulation tick. Called before each tick and after any teleport so rendering can interpolate.
+	void storeTickStart();
+
+	// Returns the x coordinate interpolated between the start of the current tick (alpha 0) and the current position (alpha 1).
+	decimal getRenderX(decimal alpha);
+
+	// Returns the y coordinate interpolated between the start of the current tick (alpha 0) and the current position (alpha 1).
+	decimal getRenderY(decimal alpha);
+
 	// Returns by value the current animation frame's rectangle. Sprite sheet coordinate relative.
 	const SDL_Rect& getRect();
 
+	// AI decision making. Run by the game loop's AI subsystem at its own rate rather than every tick. Does nothing unless overridden.
+	virtual void think();
+
+	// Steps animation frames. Run by the game loop's animation subsystem at its own rate rather than every tick. Does nothing unless overridden.
+	virtual void animate();
+
 	// Moves Sprite based on velocities adjusting for gravity, friction, and collisions. May be overridden or extended for custom movement routines.
-	virtual void move();
+	// Parameter is the fixed simulation tick length in seconds handed out by the game loop's SimClock.
+	virtual void move(decimal dt);
 
-	// Set the action mode to enter into and also if it is a looping animation or not.
-	void setActionMode(std::string actionMode, bool looping);
+	// Set the action mode to enter into and also if it is a looping animation or not. Copied into storage sized at load so never allocates.
+	void setActionMode(std::string_view actionMode, bool looping);
 
 	// Returns the current action mode
-	std::string getActionMode();
+	const std::string& getActionMode();
 
 	// Returns the last action mode
-	std::string getLastActionMode();
+	const std::string& getLastActionMode();
+
+	// Returns the FensoxUtils::hash of the current action mode's name. Compare against the AM_ constants below rather than comparing
+	// strings in per tick code.
+	unsigned int getActionModeID();
 
 	// Returns whethar the current action mode is a looping animation or not.
 	bool getActionModeLooping();
@@ -130,7 +164,16 @@ public:
 	// Returns information about the Sprite object represented as a std::string for debugging purposes.
 	virtual std::string toString();
 
+	// Folds the sprite's simulation state (position, velocity, health, animation) into a running hash and returns it. Used to check replays reproduce a run exactly.
+	Uint64 hashState(Uint64 hash);
+
 protected:
+	// IDs of the action modes derived classes check every tick, hashed at compile time. See getActionModeID().
+	static constexpr unsigned int AM_WALK_LEFT{ FensoxUtils::hash("WALK_LEFT") };
+	static constexpr unsigned int AM_WALK_RIGHT{ FensoxUtils::hash("WALK_RIGHT") };
+	static constexpr unsigned int AM_JUMP_LEFT{ FensoxUtils::hash("JUMP_LEFT") };
+	static constexpr unsigned int AM_JUMP_RIGHT{ FensoxUtils::hash("JUMP_RIGHT") };
+
 	//**DEBUG** Get rid of this and make a constructor that takes all of it so we could potential load it all from a file and not have to hard
 	//code it all. Either constructor takes all these parameters or it takes a struct that holds them all.
 
@@ -176,8 +219,14 @@ protected:
 	// Smart pointer to the SDLMan object passed in during construction.
 	std::weak_ptr<SDLMan> mSDL;
 
+	// Smart pointer to the simulation's timer wheel. Timers are counted in simulation ticks so they follow the simulation clock.
+	std::weak_ptr<TimerWheel> mTimers;
+
+	// Sets flag to false and schedules it to be set true after the given milliseconds of simulation time. Sets it true straight away if there is no timer wheel.
+	void setFlagAfter(Uint32 ms, bool& flag);
+
 	// Holds velocity/momentum for the four 2d directions. These modify speed/position in jumps, falls, etc.
-	// Gravity, friction, hits taken, etc can also modify these in return.
+	// Gravity, friction, hits taken, etc can also modify these in return. All are in pixels per second.
 	struct Velocity {
 		decimal up{ 0 };
 		decimal down{ 0 };
@@ -197,11 +246,11 @@ protected:
 	bool isCollision(FuGlobals::ColType inType, FuGlobals::ColDirect inDirect, int inPixels, std::weak_ptr<Sprite> &colSprite);
 	bool isCollision(FuGlobals::ColType inType, FuGlobals::ColDirect inDirect, int inPixels);
 
-	// Applies gravity to the sprite depending on boolean parameter. Also checks if just finished a fall and cleans up some variables if so.
-	void applyGravity(bool standing);
+	// Applies gravity to the sprite depending on boolean parameter. Also checks if just finished a fall and cleans up some variables if so. dt is the tick length in seconds.
+	void applyGravity(bool standing, decimal dt);
 
-	// Applies friction to the sprite's velocity.
-	void applyFriction(bool standing);
+	// Applies friction to the sprite's velocity. dt is the tick length in seconds.
+	void applyFriction(bool standing, decimal dt);
 
 	// Check's for health reaching 0 and begins death animation.
 	virtual void processDeath();
@@ -214,6 +263,9 @@ private:
 	// Last position sprite was in before current position.
 	decimal mLastXPos{ 0 }; decimal mLastYPos{ 0 };
 
+	// Position at the start of the current simulation tick. Unlike mLastXPos this is only updated once per tick so render can interpolate from it.
+	decimal mTickXPos{ 0 }; decimal mTickYPos{ 0 };
+
 	// Smart pointer to the Texture holding our sprite's sprite sheet.
 	std::unique_ptr<Texture> mTexture{ nullptr };
 
@@ -226,9 +278,6 @@ private:
 	// Holds the depth of this Sprite. Used for rendering of things in front/behind each other.
 	int mDepth{};
 
-	// Holds the destination rectangle we will be rendered into
-	SDL_Rect mDest{};
-
 	// The sprite's instance of the Velocity struct
 	Velocity veloc{};
 
@@ -244,14 +293,29 @@ private:
 	// Is the last action mode a looping animation or not
 	bool mLastActionModeLooping{ false };
 
+	// FensoxUtils::hash of the current and last action mode names
+	unsigned int mActionModeID{ 0 };
+	unsigned int mLastActionModeID{ 0 };
+
+	// Animation frames of the current and last action modes in mAnimMap. Looked up when the action mode changes so animating
+	// doesn't hash the name every tick. Elements of an unordered_map stay put as it grows so these stay valid.
+	const std::vector<SDL_Rect>* mFrames{ nullptr };
+	const std::vector<SDL_Rect>* mLastFrames{ nullptr };
+
+	// Largest collision rectangle over all animation frames, scaled
+	SDL_Point mMaxCollSize{ 0, 0 };
+
 	// Load the initial data file in with action mode names and animation frame counts. Store in passed in map and return boolean success.
 	bool loadDataFile();
 
+	// Looks up the current action mode's ID and animation frames. Called whenever mActionMode is set.
+	void cacheActionMode();
+
 	// Load in the sprite sheet specified in the const string mSpriteSheet and set transparency. Return boolean success.
 	bool loadSpriteSheet();
 
-	// Draw collision points as crosshairs. Useful for debugging purposes.
-	void drawCollisionPoints();
+	// Draw collision points of a sprite snapshot as crosshairs. Useful for debugging purposes.
+	static void drawCollisionPoints(SDLMan& sdl, const SpriteSnapshot& snap, const SDL_Point& viewport);
 	
 	// After all movement for frame is made, adjust for any collisions with level geometry.
 	void correctFrameLevel();
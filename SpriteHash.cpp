@@ -0,0 +1,85 @@
+#include "SpriteHash.h"
+#include <algorithm>
+#include <sstream>
+
+// Clears the hash and sizes it for the given number of sprites whose collision rectangles are never bigger than maxSize.
+void SpriteHash::reset(std::size_t count, SDL_Point maxSize) {
+	mMaxSize = { std::max(maxSize.x, 1), std::max(maxSize.y, 1) };
+
+	// at least twice as many buckets as sprites keeps chains short
+	std::size_t buckets{ 64 };
+	while (buckets < count * 2) buckets *= 2;
+	mHead.assign(buckets, NONE);
+
+	mNext.assign(count, NONE);
+	mPrev.assign(count, NONE);
+	mCol.assign(count, 0);
+	mRow.assign(count, 0);
+	mIn.assign(count, 0);
+	mCount = 0;
+}
+
+// Adds a sprite at the given position, or moves it there if already added.
+void SpriteHash::update(int index, int x, int y) {
+	int col{ getCell(x) };
+	int row{ getCell(y) };
+	if (mIn[index]) {
+		if (mCol[index] == col && mRow[index] == row) return;	// still in the same cell, the usual case
+		remove(index);
+	}
+
+	// push onto the front of the bucket's chain
+	int bucket{ getBucket(col, row) };
+	mCol[index] = col;
+	mRow[index] = row;
+	mPrev[index] = NONE;
+	mNext[index] = mHead[bucket];
+	if (mHead[bucket] != NONE) mPrev[mHead[bucket]] = index;
+	mHead[bucket] = index;
+	mIn[index] = 1;
+	++mCount;
+}
+
+// Takes a sprite out of the hash.
+void SpriteHash::remove(int index) {
+	if (!mIn[index]) return;
+
+	if (mPrev[index] != NONE) mNext[mPrev[index]] = mNext[index];
+	else mHead[getBucket(mCol[index], mRow[index])] = mNext[index];
+	if (mNext[index] != NONE) mPrev[mNext[index]] = mPrev[index];
+
+	mIn[index] = 0;
+	--mCount;
+}
+
+// Returns the number of sprites in the hash.
+int SpriteHash::getCount() {
+	return mCount;
+}
+
+// Returns the cell column or row holding a level coordinate.
+int SpriteHash::getCell(int v) {
+	// round down for negative coordinates too so cells don't double up around 0
+	return v >= 0 ? v / FuGlobals::SPRITE_CELL : (v + 1) / FuGlobals::SPRITE_CELL - 1;
+}
+
+// Returns the bucket a cell hashes to.
+int SpriteHash::getBucket(int col, int row) {
+	Uint32 h{ static_cast<Uint32>(col) * 73856093u ^ static_cast<Uint32>(row) * 19349663u };
+	return static_cast<int>(h & (mHead.size() - 1));
+}
+
+// Outputs the object information represented as a string
+std::string SpriteHash::toString() {
+	std::size_t longest{ 0 };
+	for (int head : mHead) {
+		std::size_t length{ 0 };
+		for (int i{ head }; i != NONE; i = mNext[i]) ++length;
+		longest = std::max(longest, length);
+	}
+
+	std::ostringstream str{};
+	str << "SpriteHash::Sprites: " << mCount << " of " << mNext.size() << ", Buckets: " << mHead.size() << ", Longest chain: " << longest;
+	str << ", Max sprite size: " << mMaxSize.x << " x " << mMaxSize.y << "\n";
+	return str.str();
+}
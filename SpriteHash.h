@@ -0,0 +1,115 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/* SpriteHash - Spatial hash of a level's active sprites for sprite collision broadphase
+ *
+ * Sprites are numbered by their place in the level's sprite list. Each active sprite sits in the cell
+ * SPRITE_CELL pixels square holding its position, and cells are hashed into a fixed number of buckets
+ * that chain their sprites through arrays sized once by reset(), so moving sprites around never
+ * allocates. The level calls update() whenever a sprite has moved and query() visits only the sprites
+ * whose positions lie in cells that a rectangle around them could reach the query area from.
+ *
+ * Sprites are stored by position only, so queries widen their area by the largest collision rectangle
+ * any sprite can have (given to reset()). That keeps queries exact while animation frames change a
+ * sprite's size between updates. query() visits candidates; callers test their live collision rectangles,
+ * either themselves or through findFirst() and findAll(), which give the same answers as a loop over every
+ * sprite in index order would.
+ */
+class SpriteHash {
+
+public:
+	// Clears the hash and sizes it for the given number of sprites whose collision rectangles are never bigger than maxSize.
+	void reset(std::size_t count, SDL_Point maxSize);
+
+	// Adds a sprite at the given position, or moves it there if already added.
+	void update(int index, int x, int y);
+
+	// Takes a sprite out of the hash.
+	void remove(int index);
+
+	// Calls visit with the index of every sprite whose collision rectangle could touch the inclusive pixel bounds given, each once, until it returns true.
+	// Returns true if visit did.
+	template <typename Visit>
+	bool query(int minX, int minY, int maxX, int maxY, Visit visit) {
+		if (mHead.empty()) return false;
+
+		// a sprite's rectangle reaches right and down from its position
+		int col0{ getCell(minX - mMaxSize.x + 1) }, col1{ getCell(maxX) };
+		int row0{ getCell(minY - mMaxSize.y + 1) }, row1{ getCell(maxY) };
+		for (int row{ row0 }; row <= row1; ++row) {
+			for (int col{ col0 }; col <= col1; ++col) {
+				// buckets are shared between cells so skip sprites from other cells
+				for (int i{ mHead[getBucket(col, row)] }; i != NONE; i = mNext[i]) {
+					if (mCol[i] != col || mRow[i] != row) continue;
+					if (visit(i)) return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	// Returns the lowest index of the sprites query() visits for which hit returns true, the one a loop over all of them
+	// in index order would find, or -1 if none.
+	template <typename Hit>
+	int findFirst(int minX, int minY, int maxX, int maxY, Hit hit) {
+		// the hash visits sprites in no particular order so keep looking for lower indices after a hit
+		int first{ NONE };
+		query(minX, minY, maxX, maxY, [&](int i) {
+			if (first != NONE && i > first) return false;
+			if (hit(i)) first = i;
+			return false;
+		});
+
+		return first;
+	}
+
+	// Replaces out's contents with the indices, lowest first, of the sprites query() visits for which hit returns true.
+	template <typename Hit>
+	void findAll(int minX, int minY, int maxX, int maxY, std::vector<int>& out, Hit hit) {
+		out.clear();
+		query(minX, minY, maxX, maxY, [&](int i) {
+			if (hit(i)) out.push_back(i);
+			return false;
+		});
+
+		std::sort(out.begin(), out.end());
+	}
+
+	// Returns the number of sprites in the hash.
+	int getCount();
+
+	// Outputs the object information represented as a string
+	std::string toString();
+
+private:
+	// Marks an empty bucket or end of a chain
+	static constexpr int NONE{ -1 };
+
+	// Largest collision rectangle any sprite can have
+	SDL_Point mMaxSize{ 0, 0 };
+
+	// First sprite in each bucket. A power of two long.
+	std::vector<int> mHead{};
+
+	// Each sprite's neighbours in its bucket's chain and its cell. Only meaningful while its mIn flag is set.
+	std::vector<int> mNext{};
+	std::vector<int> mPrev{};
+	std::vector<int> mCol{};
+	std::vector<int> mRow{};
+	std::vector<Uint8> mIn{};
+
+	// Sprites in the hash
+	int mCount{ 0 };
+
+	// Returns the cell column or row holding a level coordinate.
+	int getCell(int v);
+
+	// Returns the bucket a cell hashes to.
+	int getBucket(int col, int row);
+};
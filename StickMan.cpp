@@ -4,8 +4,8 @@
 // constructor
 StickMan::StickMan(std::weak_ptr<SDLMan> mSDL) : Sprite{ mSDL } {
 	// set our Stick Man specific data
-	mMetaFilename = "data/StickMan.dat";
-	mSpriteSheet = "data/MasterSS.png";
+	mMetaFilename = "Data/StickMan.dat";
+	mSpriteSheet = "Data/MasterSS.png";
 	mStartingActionMode = "WALK_RIGHT";
 	mTrans = SDL_Color{ 255, 0, 255, 0 };
 	mName = "StickMan";
@@ -16,82 +16,89 @@ StickMan::StickMan(std::weak_ptr<SDLMan> mSDL) : Sprite{ mSDL } {
 	setActionMode( mStartingActionMode, true );
 
 	// load sound effects
-	//mSDL.lock()->addSoundEffect("MRX_PUNCH", "data/mrx_punch.wav");
-	//mSDL.lock()->addSoundEffect("MRX_KICK", "data/mrx_kick.wav");
+	//mSDL.lock()->addSoundEffect("MRX_PUNCH", "Data/mrx_punch.wav");
+	//mSDL.lock()->addSoundEffect("MRX_KICK", "Data/mrx_kick.wav");
 
 }
 
 // Check if enough time has passed so we can advance walking animation frame
 bool StickMan::checkWalkTime() {
-    // we are walking - check if enough time has passed before taking a step
-    Uint32 currentTime{ SDL_GetTicks() };
-    if (currentTime - mLastAnimStep >= WALK_WAIT_TIME) {
-        mLastAnimStep = currentTime;
-        return true;
-    } else {
-        return false;
-    }
+    // we are walking - a step is allowed once the walk timer has fired, then start it again for the next step
+    if (!mWalkStepReady) return false;
+
+    setFlagAfter(WALK_WAIT_TIME, mWalkStepReady);
+    return true;
 }
 
 // Move to the right
-void StickMan::moveRight() {
+void StickMan::moveRight(decimal dt) {
     using namespace FuGlobals;
 
     // if the previous action was different set new mActionMode, set animation frame to 0, and don't move position this frame
-    if (getActionMode() != "WALK_RIGHT") {
+    if (getActionModeID() != AM_WALK_RIGHT) {
         mFacingRight = true;
         setActionMode("WALK_RIGHT", true);
     } else {
-        // step animation frame if enough time has passed and we're not pressed up against an object
-        int frameWidth{ (getCollisionRect().w / 2) + 1 };
-        if (checkWalkTime()
-            && !isCollision(ColType::CT_LEVEL, ColDirect::CD_RIGHT, frameWidth)
-            && !isCollision(ColType::CT_SPRITE, ColDirect::CD_RIGHT, frameWidth))
-        {
-            advanceFrame();
-        }
-
-        // increase velocity based on FPS calc to reach our per second goal
-        mVeloc.right += WALK_VELOCITY_PER / mSDL.lock()->getFPS();
+        // increase velocity by one tick's share of our per second goal
+        mVeloc.right += WALK_VELOCITY_PER * dt;
         if (mVeloc.right > WALK_MAX) mVeloc.right = WALK_MAX;
     }
 }
 
 // Move to the left
-void StickMan::moveLeft() {
+void StickMan::moveLeft(decimal dt) {
     using namespace FuGlobals;
 
     // if the previous action was different set new mActionMode, mCurrentFrame 0, and don't move position this frame
-    if (getActionMode() != "WALK_LEFT") {
+    if (getActionModeID() != AM_WALK_LEFT) {
         mFacingRight = false;
         setActionMode("WALK_LEFT", true);
     } else {
-        // step animation frame if enough time has passed and we're not pressed up against an object
-        int frameWidth{ (getCollisionRect().w / 2) + 1 };
+        // increase velocity by one tick's share of our per second goal
+        mVeloc.left += WALK_VELOCITY_PER * dt;
+        if (mVeloc.left > WALK_MAX) mVeloc.left = WALK_MAX;
+    }
+}
+
+// Decide which way to walk based on the target sprite's position. Run by the game loop's AI subsystem.
+void StickMan::think() {
+    // Walk towards the player if we are not colliding with them
+    mPlanRight = mTargetSprite.lock()->getX() > getX();
+    mPlanLeft = mTargetSprite.lock()->getX() < getX();
+}
+
+// Steps the walking animation. Run by the game loop's animation subsystem.
+void StickMan::animate() {
+    using namespace FuGlobals;
+
+    // step animation frame if enough time has passed and we're not pressed up against an object
+    int frameWidth{ (getCollisionRect().w / 2) + 1 };
+    if (mPlanRight && getActionModeID() == AM_WALK_RIGHT) {
+        if (checkWalkTime()
+            && !isCollision(ColType::CT_LEVEL, ColDirect::CD_RIGHT, frameWidth)
+            && !isCollision(ColType::CT_SPRITE, ColDirect::CD_RIGHT, frameWidth))
+        {
+            advanceFrame();
+        }
+    } else if (mPlanLeft && getActionModeID() == AM_WALK_LEFT) {
         if (checkWalkTime()
             && !isCollision(ColType::CT_LEVEL, ColDirect::CD_LEFT, frameWidth)
             && !isCollision(ColType::CT_SPRITE, ColDirect::CD_LEFT, frameWidth))
         {
             advanceFrame();
         }
-
-        // increase velocity based on FPS calc to reach our per second goal
-        mVeloc.left += WALK_VELOCITY_PER / mSDL.lock()->getFPS();
-        if (mVeloc.left > WALK_MAX) mVeloc.left = WALK_MAX;
     }
 }
 
 // Extend Sprite's move() function for some AI then call Sprite's function for movement based on velocity, gravity, and collision detection, etc.
-void StickMan::move() {
-    // Walk towards the player if we are not colliding with them
-    if (mTargetSprite.lock()->getX() > getX()) {
-        moveRight();
-    } else if (mTargetSprite.lock()->getX() < getX()) {
-        moveLeft();
+void StickMan::move(decimal dt) {
+    // walk the way the AI last decided. Deciding happens in think() at the AI subsystem's rate.
+    if (mPlanRight) {
+        moveRight(dt);
+    } else if (mPlanLeft) {
+        moveLeft(dt);
     }
 
     // call parent function for gravity, friction, & collision detection
-    Sprite::move();
-
-    std::cout << getHealth() << std::endl;
+    Sprite::move(dt);
 }
\ No newline at end of file
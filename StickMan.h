@@ -7,24 +7,35 @@
 class StickMan : public Sprite {
 
 public:
-	static constexpr decimal	WALK_VELOCITY_PER	{ 75 };			// Walk velocity increase per real world second. Higher than WALK_MAX to overcome global friction constants.
-	static constexpr decimal	WALK_MAX			{ 2.0 };		// Maximum velocity can walk per real world second
-	static constexpr Uint32		WALK_WAIT_TIME		{ 250 };		// Milliseconds between change of animation 
+	static constexpr decimal	WALK_VELOCITY_PER	{ 9375 };		// Walk velocity increase in pixels/second per real world second. Higher than WALK_MAX to overcome global friction constants.
+	static constexpr decimal	WALK_MAX			{ 250.0 };		// Maximum walking velocity in pixels per second
+	static constexpr Uint32		WALK_WAIT_TIME		{ 250 };		// Simulation milliseconds between change of animation 
 
 	StickMan(std::weak_ptr<SDLMan> mSDL);
 
 	// Extend Sprite's move() function for some AI then call Sprite's function for movement based on velocity, gravity, and collision detection, etc.
-	void move();
+	// dt is the tick length in seconds.
+	void move(decimal dt) override;
+
+	// Decide which way to walk based on the target sprite's position. Run by the game loop's AI subsystem.
+	void think() override;
+
+	// Steps the walking animation. Run by the game loop's animation subsystem.
+	void animate() override;
 
 private:
-	// Holds the SDL ticks the last time an animation frame changed for the walking action
-	Uint32 mLastAnimStep{};
+	// Set by the walk timer once WALK_WAIT_TIME has passed since the last walking animation frame change
+	bool mWalkStepReady{ true };
+
+	// Direction the AI last decided to walk. Kept between think() calls as the AI runs slower than movement.
+	bool mPlanRight{ false };
+	bool mPlanLeft{ false };
 
-	// Move to the right
-	void moveRight();
+	// Move to the right. dt is the tick length in seconds.
+	void moveRight(decimal dt);
 
-	// Move to the left
-	void moveLeft();
+	// Move to the left. dt is the tick length in seconds.
+	void moveLeft(decimal dt);
 
 	// Check if enough time has passed so we can advance walking animation frame
 	bool checkWalkTime();
@@ -0,0 +1,156 @@
+#include "../CollisionGrid.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Checks of CollisionGrid against a linear scan of the same rectangles with SDL's own tests, the way
+ * Level checked every rectangle before the grid.
+ *
+ * Built and run by ctest from Tests/CMakeLists.txt, or by hand from the repository root:
+ *     g++ -std=c++17 Tests/CollisionGridTest.cpp CollisionGrid.cpp $(sdl2-config --cflags --libs) -o collisiongridtest && ./collisiongridtest
+ * Prints each failed check and returns non-zero if any failed.
+ */
+
+// Number of checks failed so far
+int gFailed{ 0 };
+
+// Level size the grids are built over
+const SDL_Point LEVEL_SIZE{ 2000, 720 };
+
+// Reports a failed check.
+void check(bool ok, const std::string& what) {
+	if (ok) return;
+	std::cerr << "Failed in CollisionGridTest. " << what << std::endl;
+	++gFailed;
+}
+
+// Returns a rectangle as text for failure messages.
+std::string rectToString(const SDL_Rect& r) {
+	return "{ " + std::to_string(r.x) + ", " + std::to_string(r.y) + ", " + std::to_string(r.w) + ", " + std::to_string(r.h) + " }";
+}
+
+// Returns true if any of the rectangles intersects the line, testing every one.
+bool scanLine(const std::vector<SDL_Rect>& rects, const Line& line) {
+	for (const SDL_Rect& r : rects) {
+		// SDL clips the line it is given so test a copy
+		Line l{ line };
+		if (SDL_IntersectRectAndLine(&r, &l.x1, &l.y1, &l.x2, &l.y2)) return true;
+	}
+	return false;
+}
+
+// Returns true if any of the rectangles contains the point, testing every one.
+bool scanPoint(const std::vector<SDL_Rect>& rects, const SDL_Point& pnt) {
+	for (const SDL_Rect& r : rects) {
+		if (SDL_PointInRect(&pnt, &r)) return true;
+	}
+	return false;
+}
+
+// Returns true if any of the rectangles intersects the given one, testing every one.
+bool scanRect(const std::vector<SDL_Rect>& rects, const SDL_Rect& rect) {
+	for (const SDL_Rect& r : rects) {
+		if (SDL_HasIntersection(&r, &rect)) return true;
+	}
+	return false;
+}
+
+// Runs one line, point and rectangle query against both the grid and the scan and reports any difference.
+void compare(CollisionGrid& grid, const std::vector<SDL_Rect>& rects, const Line& line, const SDL_Point& pnt, const SDL_Rect& rect, const std::string& name) {
+	int tested{ 0 };
+	bool hit{ grid.hasLine(line, tested) };
+	check(hit == scanLine(rects, line), name + ": hasLine differs from the scan for line " + std::to_string(line.x1) + "," + std::to_string(line.y1) + " to " + std::to_string(line.x2) + "," + std::to_string(line.y2) + ".");
+	check(tested <= static_cast<int>(rects.size()), name + ": hasLine tested a rectangle more than once.");
+	check(grid.hasPoint(pnt) == scanPoint(rects, pnt), name + ": hasPoint differs from the scan at " + std::to_string(pnt.x) + "," + std::to_string(pnt.y) + ".");
+	check(grid.hasRect(rect) == scanRect(rects, rect), name + ": hasRect differs from the scan for " + rectToString(rect) + ".");
+}
+
+// Random geometry, much of it spanning several cells or sticking out past the level, queried at random.
+void testRandom() {
+	std::mt19937 random{ 5 };
+	auto rand{ [&random](int lo, int hi) { return std::uniform_int_distribution<int>{ lo, hi }(random); } };
+
+	for (int trial{ 0 }; trial < 20; ++trial) {
+		std::vector<SDL_Rect> rects{};
+		int count{ rand(0, 300) };
+		for (int i{ 0 }; i < count; ++i) rects.push_back({ rand(-300, 2200), rand(-200, 900), rand(-5, 600), rand(-5, 300) });
+
+		CollisionGrid grid{};
+		grid.build(rects, LEVEL_SIZE);
+
+		for (int q{ 0 }; q < 2000; ++q) {
+			// mostly short lines like a sprite's, some horizontal, vertical or crossing the whole level
+			Line line{};
+			line.x1 = rand(-600, 2600);
+			line.y1 = rand(-400, 1100);
+			switch (rand(0, 3)) {
+				case 0:		line.x2 = line.x1 + rand(-60, 60); line.y2 = line.y1; break;
+				case 1:		line.x2 = line.x1; line.y2 = line.y1 + rand(-60, 60); break;
+				case 2:		line.x2 = line.x1 + rand(-60, 60); line.y2 = line.y1 + rand(-60, 60); break;
+				default:	line.x2 = rand(-600, 2600); line.y2 = rand(-400, 1100); break;
+			}
+			SDL_Point pnt{ rand(-600, 2600), rand(-400, 1100) };
+			SDL_Rect rect{ rand(-600, 2600), rand(-400, 1100), rand(0, 400), rand(0, 300) };
+			compare(grid, rects, line, pnt, rect, "testRandom trial " + std::to_string(trial));
+		}
+	}
+}
+
+// Rectangles past every edge of the level are found by queries clamped to the edge cells, and queries far outside find nothing.
+void testClampedEdges() {
+	std::vector<SDL_Rect> rects{
+		{ -500, 100, 50, 50 },			// left of the level
+		{ 2600, 300, 100, 40 },			// right of the level
+		{ 900, -400, 30, 20 },			// above the level
+		{ 400, 1000, 200, 10 },			// below the level
+		{ -100, -100, 2300, 20 },		// across the whole top edge and past both sides
+		{ 1999, 719, 1, 1 }				// the level's last pixel
+	};
+	CollisionGrid grid{};
+	grid.build(rects, LEVEL_SIZE);
+
+	// on each rectangle, just inside and just outside its edges, and far out past the grid
+	std::vector<SDL_Point> points{ { -10000, -10000 }, { 10000, 10000 }, { -10000, 120 }, { 10000, 320 } };
+	for (const SDL_Rect& r : rects) {
+		points.push_back({ r.x, r.y });
+		points.push_back({ r.x + r.w - 1, r.y + r.h - 1 });
+		points.push_back({ r.x - 1, r.y });
+		points.push_back({ r.x + r.w, r.y + r.h - 1 });
+		points.push_back({ r.x, r.y + r.h });
+	}
+	for (const SDL_Point& p : points) {
+		Line horizontal{ p.x - 20, p.y, p.x, p.y };
+		Line vertical{ p.x, p.y, p.x, p.y + 20 };
+		SDL_Rect rect{ p.x, p.y, 3, 3 };
+		compare(grid, rects, horizontal, p, rect, "testClampedEdges");
+		compare(grid, rects, vertical, p, rect, "testClampedEdges");
+	}
+
+	// a line from far outside the grid to far outside the other side crosses everything in between
+	compare(grid, rects, Line{ -10000, 120, 10000, 120 }, SDL_Point{ -501, 100 }, SDL_Rect{ -10000, -10000, 20000, 20000 }, "testClampedEdges");
+}
+
+// An empty grid and one holding only empty rectangles find nothing.
+void testEmpty() {
+	std::vector<SDL_Rect> rects{ { 100, 100, 0, 50 }, { 200, 200, 50, -1 } };
+	for (int pass{ 0 }; pass < 2; ++pass) {
+		CollisionGrid grid{};
+		grid.build(pass == 0 ? std::vector<SDL_Rect>{} : rects, LEVEL_SIZE);
+
+		int tested{ 0 };
+		check(!grid.hasLine(Line{ 0, 120, 2000, 120 }, tested), "testEmpty: hasLine found a rectangle.");
+		check(!grid.hasPoint(SDL_Point{ 100, 120 }), "testEmpty: hasPoint found a rectangle.");
+		check(!grid.hasRect(SDL_Rect{ 0, 0, 2000, 720 }), "testEmpty: hasRect found a rectangle.");
+	}
+}
+
+int main() {
+	testRandom();
+	testClampedEdges();
+	testEmpty();
+
+	if (gFailed == 0) std::cout << "CollisionGridTest::All checks passed." << std::endl;
+	return gFailed == 0 ? 0 : 1;
+}
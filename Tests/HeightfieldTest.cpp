@@ -0,0 +1,145 @@
+#include "../Heightfield.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Checks of Heightfield against the per rectangle horizontal line check Level made before the heightfield,
+ * SDL_IntersectRectAndLine on every collision rectangle.
+ *
+ * Built and run by ctest from Tests/CMakeLists.txt, or by hand from the repository root:
+ *     g++ -std=c++17 Tests/HeightfieldTest.cpp Heightfield.cpp $(sdl2-config --cflags --libs) -o heightfieldtest && ./heightfieldtest
+ * Prints each failed check and returns non-zero if any failed.
+ */
+
+// Number of checks failed so far
+int gFailed{ 0 };
+
+// Reports a failed check.
+void check(bool ok, const std::string& what) {
+	if (ok) return;
+	std::cerr << "Failed in HeightfieldTest. " << what << std::endl;
+	++gFailed;
+}
+
+// Returns true if any of the rectangles intersects the horizontal line from x1 to x2 on row y, testing every one.
+bool scanSpan(const std::vector<SDL_Rect>& rects, int x1, int x2, int y) {
+	for (const SDL_Rect& r : rects) {
+		// SDL clips the line it is given so test a copy
+		int lx1{ x1 }, ly1{ y }, lx2{ x2 }, ly2{ y };
+		if (SDL_IntersectRectAndLine(&r, &lx1, &ly1, &lx2, &ly2)) return true;
+	}
+	return false;
+}
+
+// Runs one query against both the heightfield and the scan and reports any difference.
+void compare(Heightfield& ground, const std::vector<SDL_Rect>& rects, int x1, int x2, int y, const std::string& name) {
+	int tested{ 0 };
+	bool expected{ scanSpan(rects, x1, x2, y) };
+	check(ground.hasSpan(x1, x2, y, tested) == expected, name + ": hasSpan from " + std::to_string(x1) + " to " + std::to_string(x2) + " on row " + std::to_string(y) + " should be " + (expected ? "true." : "false."));
+}
+
+// Queries every row from top to bottom with lines ending on, just inside and just outside each rectangle's left and right edges.
+void compareEdges(Heightfield& ground, const std::vector<SDL_Rect>& rects, int top, int bottom, const std::string& name) {
+	for (const SDL_Rect& r : rects) {
+		int left{ r.x }, right{ r.x + r.w - 1 };
+		for (int y{ top }; y <= bottom; ++y) {
+			compare(ground, rects, left - 10, left - 1, y, name);
+			compare(ground, rects, left - 10, left, y, name);
+			compare(ground, rects, left, left, y, name);
+			compare(ground, rects, right, right + 10, y, name);
+			compare(ground, rects, right + 1, right + 10, y, name);
+			compare(ground, rects, right + 10, right, y, name);
+			compare(ground, rects, left - 1, right + 1, y, name);
+		}
+	}
+}
+
+// Random geometry queried with short lines like a sprite's feet, lines given right to left, single points and lines across the level.
+void testRandom() {
+	std::mt19937 random{ 7 };
+	auto rand{ [&random](int lo, int hi) { return std::uniform_int_distribution<int>{ lo, hi }(random); } };
+
+	for (int trial{ 0 }; trial < 50; ++trial) {
+		std::vector<SDL_Rect> rects{};
+		int count{ rand(0, 200) };
+		for (int i{ 0 }; i < count; ++i) rects.push_back({ rand(-300, 3000), rand(-200, 900), rand(-5, 400), rand(-5, 200) });
+
+		Heightfield ground{};
+		ground.build(rects);
+
+		for (int q{ 0 }; q < 5000; ++q) {
+			int x1{ rand(-600, 3600) };
+			int x2{ q % 10 == 0 ? rand(-600, 3600) : x1 + rand(-50, 50) };
+			compare(ground, rects, x1, x2, rand(-300, 1200), "testRandom trial " + std::to_string(trial));
+		}
+	}
+}
+
+// Rectangles stacked in the same columns, overlapping, touching and with gaps, so a span's intervals have to be merged correctly.
+void testMergedIntervals() {
+	std::vector<SDL_Rect> rects{
+		{ 100, 100, 50, 20 },		// rows 100 to 119
+		{ 100, 110, 50, 30 },		// overlaps the one above, rows 110 to 139
+		{ 100, 140, 50, 10 },		// touches the one above, rows 140 to 149
+		{ 100, 160, 50, 5 },		// after a gap, rows 160 to 164
+		{ 120, 90, 100, 15 },		// covers part of the stack's columns and sticks out right
+		{ 130, 120, 5, 5 },			// inside the stack entirely
+		{ 160, 100, 10, 70 }		// beside the stack with one column of gap
+	};
+	Heightfield ground{};
+	ground.build(rects);
+	compareEdges(ground, rects, 80, 180, "testMergedIntervals");
+}
+
+// Standing and ceiling checks around a floor and an overhang, on the rows either side of each surface.
+void testFloorAndCeiling() {
+	std::vector<SDL_Rect> rects{
+		{ 0, 600, 1000, 40 },		// floor, top row 600
+		{ 200, 300, 200, 20 },		// overhang, bottom row 319
+		{ 380, 310, 40, 290 }		// pillar from under the overhang to the floor
+	};
+	Heightfield ground{};
+	ground.build(rects);
+
+	// feet on the floor's top row and the row above it
+	compare(ground, rects, 250, 270, 600, "testFloorAndCeiling");
+	compare(ground, rects, 250, 270, 599, "testFloorAndCeiling");
+
+	// a head under the overhang on its bottom row and the row below it
+	compare(ground, rects, 250, 270, 319, "testFloorAndCeiling");
+	compare(ground, rects, 250, 270, 320, "testFloorAndCeiling");
+
+	// a head just reaching past the overhang's ends
+	compare(ground, rects, 170, 200, 319, "testFloorAndCeiling");
+	compare(ground, rects, 170, 199, 319, "testFloorAndCeiling");
+	compare(ground, rects, 420, 399, 319, "testFloorAndCeiling");
+
+	compareEdges(ground, rects, 295, 325, "testFloorAndCeiling");
+	compareEdges(ground, rects, 595, 645, "testFloorAndCeiling");
+}
+
+// A heightfield with no rectangles, or only empty ones, finds nothing.
+void testEmpty() {
+	std::vector<SDL_Rect> rects{ { 100, 100, 0, 50 }, { 200, 200, 50, -1 } };
+	for (int pass{ 0 }; pass < 2; ++pass) {
+		Heightfield ground{};
+		ground.build(pass == 0 ? std::vector<SDL_Rect>{} : rects);
+
+		int tested{ 0 };
+		check(!ground.hasSpan(0, 5000, 120, tested), "testEmpty: hasSpan found a rectangle.");
+		check(!ground.hasSpan(220, 220, 200, tested), "testEmpty: hasSpan found a rectangle.");
+	}
+}
+
+int main() {
+	testRandom();
+	testMergedIntervals();
+	testFloorAndCeiling();
+	testEmpty();
+
+	if (gFailed == 0) std::cout << "HeightfieldTest::All checks passed." << std::endl;
+	return gFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "../SpriteHash.h"
+#include "../Line.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Checks of SpriteHash against a linear scan of every sprite in index order, the way Level checked sprites
+ * before the hash. Queries are made the way Level::isACollisionSprite (findFirst with a line) and
+ * Level::getSpritesInRect (findAll with a rectangle) make them, with sprites as bare collision rectangles.
+ *
+ * Built and run by ctest from Tests/CMakeLists.txt, or by hand from the repository root:
+ *     g++ -std=c++17 Tests/SpriteHashTest.cpp SpriteHash.cpp $(sdl2-config --cflags --libs) -o spritehashtest && ./spritehashtest
+ * Prints each failed check and returns non-zero if any failed.
+ */
+
+// Number of checks failed so far
+int gFailed{ 0 };
+
+// Largest collision rectangle of any test sprite. Bigger than a cell so queries have to reach several cells back.
+const SDL_Point MAX_SIZE{ 3 * FuGlobals::SPRITE_CELL / 2, 2 * FuGlobals::SPRITE_CELL + 10 };
+
+// A test sprite: its collision rectangle, whose top-left is its position, and whethar it is in the hash
+struct TestSprite {
+	SDL_Rect rect{};
+	bool in{ false };
+};
+
+// Reports a failed check.
+void check(bool ok, const std::string& what) {
+	if (ok) return;
+	std::cerr << "Failed in SpriteHashTest. " << what << std::endl;
+	++gFailed;
+}
+
+// Returns true if the sprite's collision rectangle intersects the line, as Level::isACollisionSprite tests it.
+bool lineHits(const TestSprite& s, const Line& line) {
+	// SDL clips the line it is given so test a copy
+	Line l{ line };
+	return SDL_IntersectRectAndLine(&s.rect, &l.x1, &l.y1, &l.x2, &l.y2) == SDL_TRUE;
+}
+
+// Returns the lowest index of a sprite in the hash, other than self, hit by the line, testing every sprite. -1 if none.
+int scanFirst(const std::vector<TestSprite>& sprites, const Line& line, int self) {
+	for (int i{ 0 }; i < static_cast<int>(sprites.size()); ++i) {
+		if (sprites[i].in && i != self && lineHits(sprites[i], line)) return i;
+	}
+	return -1;
+}
+
+// Returns the indices of the sprites in the hash intersecting area in index order, testing every sprite.
+std::vector<int> scanAll(const std::vector<TestSprite>& sprites, const SDL_Rect& area) {
+	std::vector<int> found{};
+	for (int i{ 0 }; i < static_cast<int>(sprites.size()); ++i) {
+		if (sprites[i].in && SDL_HasIntersection(&area, &sprites[i].rect)) found.push_back(i);
+	}
+	return found;
+}
+
+// Runs one line query and one rectangle query against both the hash and the scan and reports any difference.
+void compare(SpriteHash& hash, const std::vector<TestSprite>& sprites, const Line& line, int self, const SDL_Rect& area, const std::string& name) {
+	int first{ hash.findFirst(std::min(line.x1, line.x2), std::min(line.y1, line.y2), std::max(line.x1, line.x2), std::max(line.y1, line.y2), [&](int i) {
+		return i != self && lineHits(sprites[i], line);
+	}) };
+	int expected{ scanFirst(sprites, line, self) };
+	check(first == expected, name + ": findFirst found " + std::to_string(first) + " where the scan found " + std::to_string(expected) + " for line " +
+		std::to_string(line.x1) + "," + std::to_string(line.y1) + " to " + std::to_string(line.x2) + "," + std::to_string(line.y2) + ".");
+
+	std::vector<int> found{};
+	hash.findAll(area.x, area.y, area.x + area.w - 1, area.y + area.h - 1, found, [&](int i) { return SDL_HasIntersection(&area, &sprites[i].rect) == SDL_TRUE; });
+	check(found == scanAll(sprites, area), name + ": findAll differs from the scan.");
+}
+
+// Sprites moved about, resized, taken out and put back at random between rounds of random queries.
+void testRandom() {
+	std::mt19937 random{ 3 };
+	auto rand{ [&random](int lo, int hi) { return std::uniform_int_distribution<int>{ lo, hi }(random); } };
+
+	const int count{ 400 };
+	SpriteHash hash{};
+	hash.reset(count, MAX_SIZE);
+	std::vector<TestSprite> sprites(count);
+
+	for (int round{ 0 }; round < 100; ++round) {
+		int in{ 0 };
+		for (int i{ 0 }; i < count; ++i) {
+			TestSprite& s{ sprites[i] };
+
+			// mostly small moves that stay in a cell, some across the level
+			if (!s.in || rand(0, 9) == 0) s.rect = { rand(-500, 4000), rand(-300, 1000), 0, 0 };
+			else { s.rect.x += rand(-8, 8); s.rect.y += rand(-8, 8); }
+
+			// animation frames change a sprite's size without it moving
+			s.rect.w = rand(1, MAX_SIZE.x);
+			s.rect.h = rand(1, MAX_SIZE.y);
+
+			if (rand(0, 19) == 0) {
+				hash.remove(i);
+				s.in = false;
+			} else {
+				hash.update(i, s.rect.x, s.rect.y);
+				s.in = true;
+				++in;
+			}
+		}
+		check(hash.getCount() == in, "testRandom: getCount is " + std::to_string(hash.getCount()) + " with " + std::to_string(in) + " sprites in the hash.");
+
+		for (int q{ 0 }; q < 200; ++q) {
+			Line line{};
+			line.x1 = rand(-700, 4200);
+			line.y1 = rand(-500, 1200);
+			line.x2 = line.x1 + rand(-60, 60);
+			line.y2 = q % 2 == 0 ? line.y1 : line.y1 + rand(-60, 60);
+			SDL_Rect area{ rand(-700, 4200), rand(-500, 1200), rand(1, 400), rand(1, 300) };
+			compare(hash, sprites, line, rand(-1, count - 1), area, "testRandom round " + std::to_string(round));
+		}
+	}
+}
+
+// Sprites overlapping the same spot from different cells are visited in hash order but the lowest index is still the one found.
+void testLowestIndex() {
+	const int count{ 40 };
+	SpriteHash hash{};
+	hash.reset(count, MAX_SIZE);
+	std::vector<TestSprite> sprites(count);
+
+	// added highest index first and spread over several cells, all covering the point 300,300
+	for (int i{ count - 1 }; i >= 0; --i) {
+		sprites[i].rect = { 300 - (i * 7) % MAX_SIZE.x, 300 - (i * 11) % MAX_SIZE.y, MAX_SIZE.x, MAX_SIZE.y };
+		sprites[i].in = true;
+		hash.update(i, sprites[i].rect.x, sprites[i].rect.y);
+	}
+
+	Line line{ 300, 300, 305, 300 };
+	SDL_Rect area{ 300, 300, 1, 1 };
+	compare(hash, sprites, line, -1, area, "testLowestIndex");
+
+	// the caller itself is skipped, then each lowest taken out in turn
+	compare(hash, sprites, line, 0, area, "testLowestIndex skipping itself");
+	for (int i{ 0 }; i < count; ++i) {
+		hash.remove(i);
+		sprites[i].in = false;
+		compare(hash, sprites, line, -1, area, "testLowestIndex after removing " + std::to_string(i));
+	}
+}
+
+// Sprites as big as MAX_SIZE reach queries in cells right and below theirs, found only through the query padding.
+void testLargeSprites() {
+	const int cell{ FuGlobals::SPRITE_CELL };
+	std::vector<TestSprite> sprites{
+		{ { cell - 1, cell - 1, MAX_SIZE.x, MAX_SIZE.y }, true },				// on the last pixel of a cell so reaching two cells on each way
+		{ { -cell - 1, -cell - 1, MAX_SIZE.x, MAX_SIZE.y }, true },				// the same in negative coordinates, reaching over 0
+		{ { 1000, 1000, MAX_SIZE.x, MAX_SIZE.y }, true }						// far off, never hit
+	};
+	SpriteHash hash{};
+	hash.reset(sprites.size(), MAX_SIZE);
+	for (int i{ 0 }; i < static_cast<int>(sprites.size()); ++i) hash.update(i, sprites[i].rect.x, sprites[i].rect.y);
+
+	// each sprite's bottom right pixel, just past it, and a line through its far corner
+	for (const TestSprite& s : sprites) {
+		int right{ s.rect.x + s.rect.w - 1 }, bottom{ s.rect.y + s.rect.h - 1 };
+		compare(hash, sprites, Line{ right, bottom, right + 20, bottom }, -1, SDL_Rect{ right, bottom, 1, 1 }, "testLargeSprites");
+		compare(hash, sprites, Line{ right + 1, bottom, right + 20, bottom }, -1, SDL_Rect{ right + 1, bottom + 1, 5, 5 }, "testLargeSprites");
+		compare(hash, sprites, Line{ right + 10, bottom - 10, right - 10, bottom + 10 }, -1, SDL_Rect{ right - 2, bottom - 2, 3, 3 }, "testLargeSprites");
+	}
+}
+
+int main() {
+	testRandom();
+	testLowestIndex();
+	testLargeSprites();
+
+	if (gFailed == 0) std::cout << "SpriteHashTest::All checks passed." << std::endl;
+	return gFailed == 0 ? 0 : 1;
+}
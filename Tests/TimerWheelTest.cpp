@@ -0,0 +1,107 @@
+#include "../TimerWheel.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Checks of TimerWheel, mostly of callbacks that change the wheel while it is firing them.
+ *
+ * Built and run by ctest from Tests/CMakeLists.txt, or by hand from the repository root:
+ *     g++ -std=c++17 Tests/TimerWheelTest.cpp TimerWheel.cpp $(sdl2-config --cflags) -o timerwheeltest && ./timerwheeltest
+ * Prints each failed check and returns non-zero if any failed.
+ */
+
+// Number of checks failed so far
+int gFailed{ 0 };
+
+// Reports a failed check.
+void check(bool ok, const std::string& what) {
+	if (ok) return;
+	std::cerr << "Failed in TimerWheelTest. " << what << std::endl;
+	++gFailed;
+}
+
+// Timers due on the same tick all fire, once each, and nothing is left active.
+void testFiresOnce() {
+	TimerWheel wheel{ 16 };
+	std::vector<int> fired{};
+	for (int i{ 0 }; i < 5; ++i) wheel.schedule(3, nullptr, [&fired, i]() { fired.push_back(i); });
+
+	for (int t{ 0 }; t < 10; ++t) wheel.advance();
+	check(fired.size() == 5, "testFiresOnce: expected 5 timers to fire, got " + std::to_string(fired.size()));
+	check(wheel.getActiveCount() == 0, "testFiresOnce: timers left active after firing.");
+}
+
+// A callback cancelling a timer later in the same tick's list stops it firing without breaking the rest of the list.
+void testCancelInsideCallback() {
+	TimerWheel wheel{ 16 };
+	std::vector<int> fired{};
+	std::vector<TimerWheel::TimerID> ids(4);
+
+	// scheduled last so it fires first, slots push onto the front of their list
+	for (int i{ 3 }; i >= 0; --i) {
+		ids[i] = wheel.schedule(2, nullptr, [&, i]() {
+			fired.push_back(i);
+			if (i == 0) wheel.cancel(ids[2]);
+		});
+	}
+
+	wheel.advance();
+	wheel.advance();
+	check(fired.size() == 3, "testCancelInsideCallback: expected 3 timers to fire, got " + std::to_string(fired.size()));
+	for (int i : fired) check(i != 2, "testCancelInsideCallback: cancelled timer fired.");
+	check(wheel.getActiveCount() == 0, "testCancelInsideCallback: timers left active.");
+}
+
+// A callback cancelling every timer of an owner, some of them still waiting in the same tick's list.
+void testCancelOwnerInsideCallback() {
+	TimerWheel wheel{ 16 };
+	int owner{ 0 };
+	int fired{ 0 };
+	for (int i{ 0 }; i < 4; ++i) wheel.schedule(1, &owner, [&]() { ++fired; });
+	wheel.schedule(1, nullptr, [&]() { wheel.cancelOwner(&owner); });
+	wheel.schedule(40, &owner, [&]() { ++fired; });
+
+	for (int t{ 0 }; t < 50; ++t) wheel.advance();
+	check(fired == 0, "testCancelOwnerInsideCallback: expected no owned timers to fire, got " + std::to_string(fired));
+	check(wheel.getActiveCount() == 0, "testCancelOwnerInsideCallback: timers left active.");
+}
+
+// A callback cancelling a timer later in the list then scheduling a new one reuses the cancelled node. Only the new callback may run, on its own tick.
+void testCancelAndRescheduleInsideCallback() {
+	TimerWheel wheel{ 16 };
+	std::vector<std::string> fired{};
+	TimerWheel::TimerID later{ wheel.schedule(1, nullptr, [&]() { fired.push_back("cancelled"); }) };
+	wheel.schedule(1, nullptr, [&]() {
+		fired.push_back("first");
+		wheel.cancel(later);
+		wheel.schedule(1, nullptr, [&]() { fired.push_back("rescheduled"); });
+	});
+
+	wheel.advance();
+	check(fired == std::vector<std::string>{ "first" }, "testCancelAndRescheduleInsideCallback: wrong timers fired on the first tick.");
+	wheel.advance();
+	check(fired == std::vector<std::string>{ "first", "rescheduled" }, "testCancelAndRescheduleInsideCallback: rescheduled timer didn't fire on the next tick.");
+	check(wheel.getActiveCount() == 0, "testCancelAndRescheduleInsideCallback: timers left active.");
+}
+
+// Timers far enough out to start in a higher wheel cascade down and fire on their tick.
+void testCascade() {
+	TimerWheel wheel{ 16 };
+	std::vector<Uint64> firedAt{};
+	for (Uint32 ticks : { 1u, 63u, 64u, 65u, 1000u, 5000u }) wheel.schedule(ticks, nullptr, [&]() { firedAt.push_back(wheel.getTick()); });
+
+	for (int t{ 0 }; t < 6000; ++t) wheel.advance();
+	check(firedAt == std::vector<Uint64>{ 1, 63, 64, 65, 1000, 5000 }, "testCascade: timers fired on the wrong ticks.");
+}
+
+int main() {
+	testFiresOnce();
+	testCancelInsideCallback();
+	testCancelOwnerInsideCallback();
+	testCancelAndRescheduleInsideCallback();
+	testCascade();
+
+	if (gFailed == 0) std::cout << "TimerWheelTest::All checks passed." << std::endl;
+	return gFailed == 0 ? 0 : 1;
+}
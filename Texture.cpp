@@ -1,5 +1,7 @@
 #include "Texture.h"
 #include "FuGlobals.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <iostream>
 
 // Constructor takes a pointer to an SDL_Texture and stores some information about it for quick access later.
@@ -10,12 +12,14 @@ Texture::Texture(SDL_Texture* ptrText) {
 	// local member variable holding the size than having to call SDL functions every time.
 	if (ptrText != nullptr) {
 		SDL_QueryTexture(mText, NULL, NULL, &mSize.x, &mSize.y);
+		Metrics::adjust(Metric::MT_TEXTURE_BYTES, getBytes());
 	}
 };
 
 // Destructor destroys the texture properly.
 Texture::~Texture() {
-	if constexpr (FuGlobals::DEBUG_MODE) std::cerr << "Destructor: Texture" << std::endl;
+	Log::debug("Destructor: Texture");
+	if (mText != nullptr) Metrics::adjust(Metric::MT_TEXTURE_BYTES, -getBytes());
 	SDL_DestroyTexture(mText);
 	mText = nullptr;
 };
@@ -28,4 +32,9 @@ SDL_Texture* Texture::getTexture() {
 // Returns, by const reference for performance, the size of the texture in pixels stored in an SDL_Point
 const SDL_Point& Texture::getSize() {
 	return mSize;
-}
\ No newline at end of file
+}
+
+// Returns an estimate of the texture's memory at 4 bytes per pixel.
+Sint64 Texture::getBytes() {
+	return static_cast<Sint64>(mSize.x) * mSize.y * 4;
+}
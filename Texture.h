@@ -18,6 +18,9 @@ public:
 	// Returns the size of the texture in pixels stored in an SDL_Point.
 	const SDL_Point& getSize();
 
+	// Returns an estimate of the texture's memory at 4 bytes per pixel.
+	Sint64 getBytes();
+
 private:
 	// A pointer to our texture we are wrapping.
 	SDL_Texture* mText;
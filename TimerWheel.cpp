@@ -0,0 +1,174 @@
+#include "TimerWheel.h"
+
+// Constructor takes the length of one simulation tick in milliseconds, used to convert milliseconds to ticks.
+TimerWheel::TimerWheel(Uint32 tickMS) {
+	mTickMS = tickMS;
+	for (int l{ 0 }; l < LEVELS; ++l) {
+		for (int s{ 0 }; s < SLOTS; ++s) mSlots[l][s] = -1;
+	}
+}
+
+// Schedules a callback to run after the given number of ticks (at least 1). owner tags the timer so cancelOwner() can remove it. Returns an ID for cancel().
+TimerWheel::TimerID TimerWheel::schedule(Uint32 ticks, const void* owner, Callback callback) {
+	// clamp delay to what the wheels can hold
+	constexpr Uint64 maxTicks{ (static_cast<Uint64>(1) << (SLOT_BITS * LEVELS)) - 1 };
+	Uint64 delay{ ticks };
+	if (delay < 1) delay = 1;
+	if (delay > maxTicks) delay = maxTicks;
+
+	int index{ allocNode() };
+	Node& n = mNodes[index];
+	n.expire = mNow + delay;
+	n.owner = owner;
+	n.callback = std::move(callback);
+	n.active = true;
+	place(index);
+	++mActive;
+
+	return TimerID{ index, n.generation };
+}
+
+// Cancels a scheduled timer. Does nothing if it has already fired or been cancelled.
+void TimerWheel::cancel(TimerID id) {
+	if (id.index < 0 || id.index >= static_cast<int>(mNodes.size())) return;
+
+	Node& n = mNodes[id.index];
+	if (!n.active || n.generation != id.generation) return;
+
+	unlink(id.index);
+	freeNode(id.index);
+}
+
+// Cancels every timer scheduled with the given owner. Linear in the number of pooled timers so meant for object destruction, not per tick use.
+void TimerWheel::cancelOwner(const void* owner) {
+	for (int i{ 0 }; i < static_cast<int>(mNodes.size()); ++i) {
+		if (mNodes[i].active && mNodes[i].owner == owner) {
+			unlink(i);
+			freeNode(i);
+		}
+	}
+}
+
+// Advances one tick and fires every timer due on it. Call once at the start of each simulation tick.
+void TimerWheel::advance() {
+	++mNow;
+
+	// each time a wheel wraps back to slot 0 pull the next slot of the wheel above down into it
+	for (int l{ 1 }; l < LEVELS; ++l) {
+		if ((mNow & ((static_cast<Uint64>(1) << (SLOT_BITS * l)) - 1)) != 0) break;
+		cascade(l);
+	}
+
+	// take the whole list for this tick's slot off the wheel before firing so callbacks can safely schedule new timers.
+	// Its nodes are marked so a callback cancelling one of the others unlinks it from the firing list instead.
+	int slot{ static_cast<int>(mNow & (SLOTS - 1)) };
+	mFiring = mSlots[0][slot];
+	mSlots[0][slot] = -1;
+	for (int i{ mFiring }; i != -1; i = mNodes[i].next) mNodes[i].level = FIRING;
+
+	// pop from the head each time round so nothing is read from a node a callback may have freed
+	while (mFiring != -1) {
+		int index{ mFiring };
+		unlink(index);
+
+		if (mNodes[index].expire <= mNow) {
+			// free before calling so the callback can reuse the node. Move the callback out first as freeing may grow the pool.
+			Callback callback{ std::move(mNodes[index].callback) };
+			freeNode(index);
+			callback();
+		} else {
+			place(index);
+		}
+	}
+}
+
+// Converts milliseconds of simulation time to whole ticks, rounding up.
+Uint32 TimerWheel::msToTicks(Uint32 ms) {
+	if (mTickMS == 0) return ms;
+	return (ms + mTickMS - 1) / mTickMS;
+}
+
+// Returns the current tick.
+Uint64 TimerWheel::getTick() {
+	return mNow;
+}
+
+// Returns the number of timers waiting to fire.
+int TimerWheel::getActiveCount() {
+	return mActive;
+}
+
+// Takes a node from the pool, growing it if empty.
+int TimerWheel::allocNode() {
+	if (mFree == -1) {
+		mNodes.emplace_back();
+		return static_cast<int>(mNodes.size()) - 1;
+	}
+
+	int index{ mFree };
+	mFree = mNodes[index].next;
+	return index;
+}
+
+// Returns a node to the pool.
+void TimerWheel::freeNode(int index) {
+	Node& n = mNodes[index];
+	if (n.active) --mActive;
+	n.active = false;
+	n.callback = nullptr;
+	n.owner = nullptr;
+	n.level = -1;
+	n.prev = -1;
+	++n.generation;
+	n.next = mFree;
+	mFree = index;
+}
+
+// Links a node into the wheel slot matching its expire tick.
+void TimerWheel::place(int index) {
+	Node& n = mNodes[index];
+	Uint64 delta{ n.expire > mNow ? n.expire - mNow : 0 };
+
+	// find the lowest wheel whose range covers the delay
+	int level{ 0 };
+	while (level < LEVELS - 1 && delta >= (static_cast<Uint64>(1) << (SLOT_BITS * (level + 1)))) ++level;
+
+	// a timer already due goes into this tick's slot so advance() picks it up
+	Uint64 at{ delta == 0 ? mNow : n.expire };
+	int slot{ static_cast<int>((at >> (SLOT_BITS * level)) & (SLOTS - 1)) };
+
+	n.level = level;
+	n.slot = slot;
+	n.prev = -1;
+	n.next = mSlots[level][slot];
+	if (n.next != -1) mNodes[n.next].prev = index;
+	mSlots[level][slot] = index;
+}
+
+// Unlinks a node from its wheel slot or the firing list.
+void TimerWheel::unlink(int index) {
+	Node& n = mNodes[index];
+	if (n.level == -1) return;
+
+	if (n.prev != -1) mNodes[n.prev].next = n.next;
+	else if (n.level == FIRING) mFiring = n.next;
+	else mSlots[n.level][n.slot] = n.next;
+	if (n.next != -1) mNodes[n.next].prev = n.prev;
+
+	n.level = -1;
+	n.prev = -1;
+	n.next = -1;
+}
+
+// Moves every node in the given wheel's slot for the current tick down into lower wheels.
+void TimerWheel::cascade(int level) {
+	int slot{ static_cast<int>((mNow >> (SLOT_BITS * level)) & (SLOTS - 1)) };
+	int index{ mSlots[level][slot] };
+	mSlots[level][slot] = -1;
+
+	while (index != -1) {
+		int next{ mNodes[index].next };
+		place(index);
+		index = next;
+	}
+}
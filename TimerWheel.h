@@ -0,0 +1,116 @@
+#pragma once
+
+#include "FuGlobals.h"
+#include <SDL.h>
+#include <vector>
+#include <functional>
+
+/* TimerWheel - Hierarchical timer wheel counted in simulation ticks
+ *
+ * Owned by GameLoop and advanced once at the start of every simulation tick. Sprites schedule a
+ * callback to run a number of ticks from now instead of polling SDL_GetTicks every tick. Because
+ * it counts ticks, timing follows the simulation clock rather than the wall clock.
+ *
+ * Timers live in LEVELS wheels of SLOTS slots each. Wheel 0 holds timers due within SLOTS ticks
+ * one slot per tick, wheel 1 timers due within SLOTS^2 ticks one slot per SLOTS ticks, and so on.
+ * Scheduling drops the timer into one slot and advancing only looks at the single slot for the
+ * current tick, so both are O(1). When wheel 0 wraps, the next slot of wheel 1 is cascaded down.
+ * Only timers that actually fire or cascade cost anything.
+ *
+ * Timer nodes are pooled and linked by index so steady state scheduling doesn't allocate.
+ */
+class TimerWheel {
+
+public:
+	// Function run when a timer fires
+	typedef std::function<void()> Callback;
+
+	// Identifies a scheduled timer for cancelling. A stale ID (timer already fired or cancelled) is safely ignored.
+	struct TimerID {
+		int index{ -1 };
+		Uint32 generation{ 0 };
+	};
+
+	static constexpr int	SLOT_BITS	{ 6 };					// Bits of the tick count each wheel covers
+	static constexpr int	SLOTS		{ 1 << SLOT_BITS };		// Slots per wheel
+	static constexpr int	LEVELS		{ 4 };					// Number of wheels. Covers SLOTS^LEVELS ticks, longer delays are clamped.
+
+	// Constructor takes the length of one simulation tick in milliseconds, used to convert milliseconds to ticks.
+	TimerWheel(Uint32 tickMS);
+	TimerWheel() = delete;
+
+	// Schedules a callback to run after the given number of ticks (at least 1). owner tags the timer so cancelOwner() can remove it. Returns an ID for cancel().
+	TimerID schedule(Uint32 ticks, const void* owner, Callback callback);
+
+	// Cancels a scheduled timer. Does nothing if it has already fired or been cancelled.
+	void cancel(TimerID id);
+
+	// Cancels every timer scheduled with the given owner. Linear in the number of pooled timers so meant for object destruction, not per tick use.
+	void cancelOwner(const void* owner);
+
+	// Advances one tick and fires every timer due on it. Call once at the start of each simulation tick.
+	void advance();
+
+	// Converts milliseconds of simulation time to whole ticks, rounding up.
+	Uint32 msToTicks(Uint32 ms);
+
+	// Returns the current tick.
+	Uint64 getTick();
+
+	// Returns the number of timers waiting to fire.
+	int getActiveCount();
+
+private:
+	// One pooled timer
+	struct Node {
+		Uint64 expire{ 0 };
+		const void* owner{ nullptr };
+		Callback callback{};
+		int next{ -1 };
+		int prev{ -1 };
+		int level{ -1 };
+		int slot{ -1 };
+		Uint32 generation{ 0 };
+		bool active{ false };
+	};
+
+	// Length of one tick in milliseconds
+	Uint32 mTickMS{};
+
+	// Current tick
+	Uint64 mNow{ 0 };
+
+	// Pool of timer nodes
+	std::vector<Node> mNodes{};
+
+	// Head of the list of free nodes in mNodes
+	int mFree{ -1 };
+
+	// Number of active timers
+	int mActive{ 0 };
+
+	// Head node index of each slot's list, -1 for empty
+	int mSlots[LEVELS][SLOTS];
+
+	// Level of nodes in mFiring, the list advance() is firing
+	static constexpr int FIRING{ LEVELS };
+
+	// Head node index of this tick's slot list once advance() has taken it off the wheel, -1 when empty or not firing.
+	// Callbacks may cancel timers still waiting in it, so it is unlinked from like any slot.
+	int mFiring{ -1 };
+
+	// Takes a node from the pool, growing it if empty.
+	int allocNode();
+
+	// Returns a node to the pool.
+	void freeNode(int index);
+
+	// Links a node into the wheel slot matching its expire tick.
+	void place(int index);
+
+	// Unlinks a node from its wheel slot or the firing list.
+	void unlink(int index);
+
+	// Moves every node in the given wheel's slot for the current tick down into lower wheels.
+	void cascade(int level);
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+
+/* TripleBuffer - Lock free single producer / single consumer hand off
+ *
+ * Holds three copies of T. The writer fills getWriteBuffer() and calls publish() to hand it over.
+ * The reader calls read() to get the most recently published copy. Neither side ever blocks or
+ * sees a half written copy: publish() and read() each swap an index with the shared middle slot
+ * in one atomic exchange. If the writer publishes several times between reads the reader simply
+ * gets the newest one. Copies are reused so once they have grown to size no allocation happens.
+ */
+template <typename T>
+class TripleBuffer {
+
+public:
+	// Returns the copy the writer should fill before calling publish(). Writer thread only.
+	T& getWriteBuffer() {
+		return mBuffers[mWrite];
+	}
+
+	// Hands the write buffer over to the reader and takes the old middle slot as the new write buffer. Writer thread only.
+	void publish() {
+		int old{ mMiddle.exchange(mWrite | NEW_BIT, std::memory_order_acq_rel) };
+		mWrite = old & INDEX_MASK;
+	}
+
+	// Returns true if something has been published since the last read().
+	bool hasNew() {
+		return (mMiddle.load(std::memory_order_acquire) & NEW_BIT) != 0;
+	}
+
+	// Returns the newest published copy. Returns the same copy as last time if nothing new has been published. Reader thread only.
+	const T& read() {
+		if (hasNew()) {
+			int old{ mMiddle.exchange(mRead, std::memory_order_acq_rel) };
+			mRead = old & INDEX_MASK;
+		}
+		return mBuffers[mRead];
+	}
+
+private:
+	// Flag stored alongside the middle index meaning it holds a copy the reader hasn't taken yet
+	static constexpr int NEW_BIT{ 4 };
+
+	// Mask to pull the buffer index back out of the middle slot
+	static constexpr int INDEX_MASK{ 3 };
+
+	// The three copies
+	T mBuffers[3]{};
+
+	// Index owned by the writer
+	int mWrite{ 0 };
+
+	// Index shared between writer and reader, plus NEW_BIT
+	std::atomic<int> mMiddle{ 1 };
+
+	// Index owned by the reader
+	int mRead{ 2 };
+};